@@ -0,0 +1,196 @@
+/**
+ * @file Analog_Distance_Sensor_DMA_Test.c
+ * @brief Host test for the DMA mode of the Analog_Distance_Sensor driver on the MSP432_Host emulator.
+ *
+ * Usage:
+ *
+ *  analog_distance_sensor_dma_test [seconds]
+ *
+ * Timer A1 runs at 1 kHz as it does under the scheduler, and Analog_Distance_Sensor_Init_DMA
+ * converts the A17/A14/A16 sequence in the background: the Set/Reset output of Timer A1 CCR2
+ * triggers one conversion per period, and the end of each sequence triggers DMA channel 7.
+ * The ADC14 callback returns a value that grows by 10 with every sequence, so the filtered
+ * results can be predicted. The test checks that:
+ *  - One sequence completes every three timer periods, and each channel is sampled exactly
+ *    3 ms apart (144000 MCLK cycles at 48 MHz).
+ *  - Every sequence raises one DMA interrupt.
+ *  - Analog_Distance_Sensor_Get_Filtered, polled every millisecond, returns the moving average
+ *    of the last ANALOG_DISTANCE_SENSOR_FILTER_SIZE sequences.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "MSP432_Host.h"
+#include "../inc/Analog_Distance_Sensor.h"
+#include "../inc/Clock.h"
+#include "../inc/CortexM.h"
+#include "../inc/DMA.h"
+#include "../inc/Timer_A1_Interrupt.h"
+
+// Default length of the run in seconds
+#define RUN_TIME            1.0
+
+// Timer A1 period for 1 kHz with SMCLK = 12 MHz
+#define TIMER_A1_PERIOD     12000
+
+// MCLK cycles between two samples of the same channel (three Timer A1 periods)
+#define SAMPLE_SPACING      144000
+
+// ADC result of each channel at the first sequence
+#define BASE_A17            1000
+#define BASE_A14            5000
+#define BASE_A16            9000
+
+// Input channels in the order of the sequence, and the state of each
+static const uint8_t Channels[3] = {17, 14, 16};
+static const uint32_t Bases[3] = {BASE_A17, BASE_A14, BASE_A16};
+static uint32_t Conversions[3];
+static uint64_t Last_Sample[3];
+static uint32_t Spacing_Errors;
+
+static uint32_t DMA_Interrupts;
+static uint32_t Polls;
+static uint32_t Filter_Errors;
+
+static void Timer_Task(void)
+{
+}
+
+static uint16_t ADC14_Sample(uint8_t channel)
+{
+    for (int c = 0; c < 3; c++)
+    {
+        if (channel != Channels[c]) continue;
+
+        uint64_t now = MSP432_Host_Get_Cycles();
+        if (Conversions[c] > 0 && now - Last_Sample[c] != SAMPLE_SPACING)
+        {
+            if (Spacing_Errors < 10) printf("A%u: sample %u taken %llu cycles after the previous one\n",
+                                            channel, Conversions[c], (unsigned long long)(now - Last_Sample[c]));
+            Spacing_Errors++;
+        }
+        Last_Sample[c] = now;
+
+        uint16_t value = Bases[c] + 10 * Conversions[c];
+        Conversions[c]++;
+        return value;
+    }
+    return 0;
+}
+
+// The test is linked with --wrap=DMA_INT0_IRQHandler, so the emulator calls this function,
+// which counts the DMA interrupts before running the handler of the DMA module
+void __real_DMA_INT0_IRQHandler(void);
+void __wrap_DMA_INT0_IRQHandler(void)
+{
+    DMA_Interrupts++;
+    __real_DMA_INT0_IRQHandler();
+}
+
+// Output of the filter once it has been fed sequences 0 to count - 1. The window starts filled
+// with sequence 0.
+static uint32_t Expected(int c, uint32_t count)
+{
+    uint32_t sum = 0;
+    for (int32_t k = (int32_t)count - ANALOG_DISTANCE_SENSOR_FILTER_SIZE; k < (int32_t)count; k++)
+    {
+        sum += Bases[c] + 10 * ((k > 0) ? k : 0);
+    }
+    return sum / ANALOG_DISTANCE_SENSOR_FILTER_SIZE;
+}
+
+static int Test_Main(void)
+{
+    Clock_Init48MHz();
+    Timer_A1_Interrupt_Init(&Timer_Task, TIMER_A1_PERIOD);
+    DMA_Init();
+    Analog_Distance_Sensor_Init_DMA();
+    EnableInterrupts();
+
+    // Poll once per millisecond, like a scheduler task, until the cycle budget runs out
+    while (1)
+    {
+        uint32_t result[3];
+        uint32_t before = Analog_Distance_Sensor_Get_Count();
+        uint32_t n = Analog_Distance_Sensor_Get_Filtered(&result[0], &result[1], &result[2]);
+        uint32_t after = Analog_Distance_Sensor_Get_Count();
+
+        if (after > 0)
+        {
+            // The filter was fed up to a count between the two reads
+            int match = 0;
+            for (uint32_t count = before; count <= after && !match; count++)
+            {
+                match = (count > 0) && result[0] == Expected(0, count)
+                        && result[1] == Expected(1, count) && result[2] == Expected(2, count);
+            }
+            if (!match || n > ANALOG_DISTANCE_SENSOR_RING_SIZE - 2)
+            {
+                if (Filter_Errors < 10) printf("poll %u (count %u): %u new, results %u %u %u, expected %u %u %u\n",
+                                               Polls, after, n, result[0], result[1], result[2],
+                                               Expected(0, after), Expected(1, after), Expected(2, after));
+                Filter_Errors++;
+            }
+        }
+        Polls++;
+
+        Clock_Delay1ms(1);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    double run_time = (argc > 1) ? atof(argv[1]) : RUN_TIME;
+    int failures = 0;
+
+    MSP432_Host_Reset();
+    MSP432_Host_Set_ADC14_Callback(&ADC14_Sample);
+
+    MSP432_Host_Run(&Test_Main, (uint64_t)(run_time * 48000000.0));
+
+    // The first sequence ends three periods after the timer starts
+    uint32_t expected_sequences = (uint32_t)(run_time * 1000.0) / 3;
+    uint32_t sequences = Analog_Distance_Sensor_Get_Count();
+
+    printf("%u sequences, %u %u %u samples, %u DMA interrupts, %u polls\n", sequences,
+           Conversions[0], Conversions[1], Conversions[2], DMA_Interrupts, Polls);
+
+    if (sequences + 1 < expected_sequences || sequences > expected_sequences)
+    {
+        printf("expected %u sequences\n", expected_sequences);
+        failures++;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        // The sequence in progress may have converted some of its channels
+        if (Conversions[c] < sequences || Conversions[c] > sequences + 1)
+        {
+            printf("A%u: %u samples for %u sequences\n", Channels[c], Conversions[c], sequences);
+            failures++;
+        }
+    }
+    if (DMA_Interrupts != sequences)
+    {
+        printf("%u DMA interrupts for %u sequences\n", DMA_Interrupts, sequences);
+        failures++;
+    }
+    if (Spacing_Errors || Filter_Errors)
+    {
+        printf("%u spacing errors, %u filter errors\n", Spacing_Errors, Filter_Errors);
+        failures++;
+    }
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
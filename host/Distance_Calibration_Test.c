@@ -0,0 +1,106 @@
+/**
+ * @file Distance_Calibration_Test.c
+ * @brief Host test that checks the calibration tables of the Sharp distance sensors against their formula.
+ *
+ * Usage:
+ *
+ *  distance_calibration_test
+ *
+ * For every ADC result from 0 to 16383 and each sensor, Analog_Distance_Sensor_Calibrate_Sensor()
+ * is compared with the integer formula of Analog_Distance_Sensor_Calibration.h:
+ *  - 800 mm below the MAX parameter of the sensor
+ *  - A / (ADC + B) + C otherwise, to within MAX_ERROR mm
+ *
+ * The tables are built by the preprocessor from ANALOG_DISTANCE_SENSOR_TABLE_SHIFT and the
+ * calibration header, so the test catches a change to either that breaks the interpolation.
+ * Analog_Distance_Sensor_Calibrate() must match the center sensor.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/Analog_Distance_Sensor.h"
+
+// Largest difference allowed between the table and the formula in mm
+#define MAX_ERROR       2
+
+typedef struct
+{
+    const char *name;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t max;
+} Sensor_Parameters;
+
+static const Sensor_Parameters Parameters[ANALOG_DISTANCE_SENSOR_COUNT] =
+{
+    {"right", ANALOG_DISTANCE_SENSOR_CAL_RIGHT_A, ANALOG_DISTANCE_SENSOR_CAL_RIGHT_B,
+              ANALOG_DISTANCE_SENSOR_CAL_RIGHT_C, ANALOG_DISTANCE_SENSOR_CAL_RIGHT_MAX},
+    {"center", ANALOG_DISTANCE_SENSOR_CAL_CENTER_A, ANALOG_DISTANCE_SENSOR_CAL_CENTER_B,
+               ANALOG_DISTANCE_SENSOR_CAL_CENTER_C, ANALOG_DISTANCE_SENSOR_CAL_CENTER_MAX},
+    {"left", ANALOG_DISTANCE_SENSOR_CAL_LEFT_A, ANALOG_DISTANCE_SENSOR_CAL_LEFT_B,
+             ANALOG_DISTANCE_SENSOR_CAL_LEFT_C, ANALOG_DISTANCE_SENSOR_CAL_LEFT_MAX}
+};
+
+// Distance computed with the calibration formula, as the driver did before the tables
+static int32_t Reference_Distance(const Sensor_Parameters *parameters, int32_t adc)
+{
+    if (adc < parameters->max) return 800;
+    return parameters->a / (adc + parameters->b) + parameters->c;
+}
+
+static int Check_Sensor(Analog_Distance_Sensor_Select sensor)
+{
+    const Sensor_Parameters *parameters = &Parameters[sensor];
+    int32_t largest = 0;
+    int failures = 0;
+
+    for (int32_t adc = 0; adc <= 16383; adc++)
+    {
+        int32_t distance = Analog_Distance_Sensor_Calibrate_Sensor(sensor, adc);
+        int32_t expected = Reference_Distance(parameters, adc);
+        int32_t error = abs(distance - expected);
+
+        if (error > largest) largest = error;
+        if ((adc < parameters->max && distance != 800) || error > MAX_ERROR)
+        {
+            if (failures < 10) printf("%s: ADC %d: %d mm, formula %d mm\n", parameters->name, adc, distance, expected);
+            failures++;
+        }
+    }
+
+    printf("%-8s largest error %d mm  %s\n", parameters->name, largest, failures ? "FAIL" : "ok");
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    for (int sensor = 0; sensor < ANALOG_DISTANCE_SENSOR_COUNT; sensor++)
+    {
+        failures += Check_Sensor((Analog_Distance_Sensor_Select)sensor);
+    }
+
+    for (int32_t adc = 0; adc <= 16383; adc++)
+    {
+        if (Analog_Distance_Sensor_Calibrate(adc) != Analog_Distance_Sensor_Calibrate_Sensor(ANALOG_DISTANCE_SENSOR_CENTER, adc))
+        {
+            printf("Analog_Distance_Sensor_Calibrate(%d) does not use the center sensor\n", adc);
+            failures++;
+            break;
+        }
+    }
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
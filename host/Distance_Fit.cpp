@@ -0,0 +1,321 @@
+/**
+ * @file Distance_Fit.cpp
+ * @brief Command-line tool that fits the calibration parameters of the Sharp distance sensors.
+ *
+ * Usage:
+ *
+ *  distance_fit samples.csv [Analog_Distance_Sensor_Calibration.h]
+ *
+ * Each line of the input holds one logged sample: the sensor (right, center, left or 0 to 2),
+ * the filtered ADC result and the true distance in mm, separated by commas. Empty lines and
+ * lines starting with '#' or a letter other than a sensor name (e.g. a CSV header) are ignored.
+ *
+ *  center,3012,612
+ *  center,5120,301
+ *
+ * The parameters of D = A / (ADC + B) + C are fitted for each sensor by least squares, and
+ * MAX is set to the ADC result at 800 mm. The calibration header is written to the output
+ * file (or to stdout); sensors without samples keep the original shared parameters. The
+ * residuals of each fit are printed on stderr.
+ *
+ *  g++ -O2 -std=c++11 host/Distance_Fit.cpp -o distance_fit
+ *
+ */
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Breakpoint spacing of the firmware tables (ANALOG_DISTANCE_SENSOR_TABLE_SHIFT)
+static const int TABLE_SHIFT = 7;
+
+// Distance reported for the ADC results below MAX
+static const double OUT_OF_RANGE = 800.0;
+
+static const char *const SENSOR_NAMES[3] = {"RIGHT", "CENTER", "LEFT"};
+static const char *const SENSOR_PINS[3] = {"A17, P9.0", "A14, P6.1", "A16, P9.1"};
+
+struct Sample
+{
+    double adc;
+    double distance;
+};
+
+struct Parameters
+{
+    long a;
+    long b;
+    long c;
+    long max;
+};
+
+// Original parameters shared by the three sensors
+static const Parameters DEFAULT_PARAMETERS = {1195159, -1058, 40, 2552};
+
+// Least-squares A and C for a fixed B. Returns the sum of the squared residuals.
+static double Fit_Linear(const std::vector<Sample> &samples, double b, double &a, double &c)
+{
+    double su = 0, sd = 0, suu = 0, sud = 0;
+    double n = (double)samples.size();
+
+    for (const Sample &sample : samples)
+    {
+        double u = 1.0 / (sample.adc + b);
+        su += u;
+        sd += sample.distance;
+        suu += u * u;
+        sud += u * sample.distance;
+    }
+
+    double determinant = n * suu - su * su;
+    if (std::fabs(determinant) < 1e-30)
+    {
+        a = 0;
+        c = sd / n;
+    }
+    else
+    {
+        a = (n * sud - su * sd) / determinant;
+        c = (sd - a * su) / n;
+    }
+
+    double error = 0;
+    for (const Sample &sample : samples)
+    {
+        double residual = a / (sample.adc + b) + c - sample.distance;
+        error += residual * residual;
+    }
+    return error;
+}
+
+// Fits A, B and C. B is searched on a coarse grid, then refined by golden-section search.
+static bool Fit(const std::vector<Sample> &samples, Parameters &parameters)
+{
+    double lowest = samples[0].adc;
+    for (const Sample &sample : samples) lowest = std::fmin(lowest, sample.adc);
+
+    // The denominator must stay positive over the samples
+    double low = 1.0 - lowest;
+    double high = 20000.0;
+    double a, c;
+
+    double best = low, best_error = HUGE_VAL;
+    for (double b = low; b <= high; b += 16.0)
+    {
+        double error = Fit_Linear(samples, b, a, c);
+        if (a > 0 && error < best_error)
+        {
+            best_error = error;
+            best = b;
+        }
+    }
+    if (best_error == HUGE_VAL) return false;
+
+    const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+    double x0 = std::fmax(low, best - 16.0), x3 = std::fmin(high, best + 16.0);
+    double x1 = x3 - ratio * (x3 - x0), x2 = x0 + ratio * (x3 - x0);
+    double e1 = Fit_Linear(samples, x1, a, c), e2 = Fit_Linear(samples, x2, a, c);
+    while (x3 - x0 > 0.01)
+    {
+        if (e1 < e2)
+        {
+            x3 = x2; x2 = x1; e2 = e1;
+            x1 = x3 - ratio * (x3 - x0);
+            e1 = Fit_Linear(samples, x1, a, c);
+        }
+        else
+        {
+            x0 = x1; x1 = x2; e1 = e2;
+            x2 = x0 + ratio * (x3 - x0);
+            e2 = Fit_Linear(samples, x2, a, c);
+        }
+    }
+
+    // The firmware uses integers: A and C are fitted again for the rounded B
+    parameters.b = std::lround(0.5 * (x0 + x3));
+    if (parameters.b < low) parameters.b = (long)std::ceil(low);
+    Fit_Linear(samples, (double)parameters.b, a, c);
+    if (a <= 0) return false;
+    parameters.a = std::lround(a);
+    parameters.c = std::lround(c);
+
+    // MAX is the ADC result at 800 mm. The breakpoint below it must keep a positive
+    // denominator and a distance that fits in 16 bits.
+    double max = (c < OUT_OF_RANGE) ? a / (OUT_OF_RANGE - c) - parameters.b : 0.0;
+    parameters.max = (long)std::ceil(std::fmax(max, 0.0));
+    for (;;)
+    {
+        long first = (parameters.max >> TABLE_SHIFT) << TABLE_SHIFT;
+        if (first + parameters.b > 0 && parameters.a / (first + parameters.b) + parameters.c < 65536) break;
+        parameters.max = first + (1 << TABLE_SHIFT);
+    }
+    return parameters.max <= 16383;
+}
+
+static int Parse_Sensor(const std::string &field)
+{
+    std::string name;
+    for (char ch : field)
+    {
+        if (ch != ' ' && ch != '\t') name += (char)std::toupper((unsigned char)ch);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (name == SENSOR_NAMES[i] || name == std::to_string(i)) return i;
+    }
+    return -1;
+}
+
+static bool Read_Samples(const char *path, std::vector<Sample> samples[3])
+{
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) return false;
+
+    char line[256];
+    unsigned number = 0;
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        number++;
+        char *first = std::strchr(line, ',');
+        if (first == nullptr) continue;
+
+        int sensor = Parse_Sensor(std::string(line, first));
+        if (sensor < 0)
+        {
+            if (line[0] != '#' && !std::isalpha((unsigned char)line[0]))
+            {
+                fprintf(stderr, "%s:%u: unknown sensor\n", path, number);
+            }
+            continue;
+        }
+
+        char *end;
+        Sample sample;
+        sample.adc = std::strtod(first + 1, &end);
+        if (*end != ',')
+        {
+            fprintf(stderr, "%s:%u: missing distance\n", path, number);
+            continue;
+        }
+        sample.distance = std::strtod(end + 1, nullptr);
+
+        // Samples beyond the range of the sensor do not follow the formula
+        if (sample.adc <= 0 || sample.adc > 16383 || sample.distance <= 0 || sample.distance >= OUT_OF_RANGE) continue;
+        samples[sensor].push_back(sample);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static void Write_Header(FILE *output, const Parameters parameters[3], const bool fitted[3])
+{
+    fprintf(output,
+            "/**\n"
+            " * @file Analog_Distance_Sensor_Calibration.h\n"
+            " * @brief Calibration parameters of the three Sharp GP2Y0A21YK0F Analog Distance Sensors.\n"
+            " *\n"
+            " * Each sensor has its own parameters for the calibration formula:\n"
+            " *  D = A / (ADC + B) + C (mm)\n"
+            " *\n"
+            " * MAX is the ADC result below which the distance is reported as 800 mm (out of range).\n"
+            " * The lookup tables of Analog_Distance_Sensor.c are built from these values at compile time.\n"
+            " *\n"
+            " * This file is written by host/Distance_Fit.cpp from logged (ADC, true distance) pairs.\n"
+            " *\n"
+            " */\n"
+            "\n"
+            "#ifndef ANALOG_DISTANCE_SENSOR_CALIBRATION_H_\n"
+            "#define ANALOG_DISTANCE_SENSOR_CALIBRATION_H_\n");
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string name = SENSOR_NAMES[i];
+        std::string first = name;
+        for (size_t k = 1; k < first.size(); k++) first[k] = (char)std::tolower((unsigned char)first[k]);
+
+        fprintf(output, "\n// %s sensor (%s)%s\n", first.c_str(), SENSOR_PINS[i], fitted[i] ? "" : ", not fitted");
+        const char *suffixes[4] = {"A", "B", "C", "MAX"};
+        const long values[4] = {parameters[i].a, parameters[i].b, parameters[i].c, parameters[i].max};
+        for (int k = 0; k < 4; k++)
+        {
+            std::string macro = "ANALOG_DISTANCE_SENSOR_CAL_" + name + "_" + suffixes[k];
+            fprintf(output, "#define %-40s%ld\n", macro.c_str(), values[k]);
+        }
+    }
+
+    fprintf(output, "\n#endif /* ANALOG_DISTANCE_SENSOR_CALIBRATION_H_ */\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2 && argc != 3)
+    {
+        fprintf(stderr, "usage: %s samples.csv [Analog_Distance_Sensor_Calibration.h]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Sample> samples[3];
+    if (!Read_Samples(argv[1], samples))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    Parameters parameters[3];
+    bool fitted[3];
+    int status = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        parameters[i] = DEFAULT_PARAMETERS;
+        fitted[i] = false;
+
+        if (samples[i].size() < 3)
+        {
+            fprintf(stderr, "%-6s: %zu samples, original parameters kept\n", SENSOR_NAMES[i], samples[i].size());
+            continue;
+        }
+
+        Parameters fit;
+        if (!Fit(samples[i], fit))
+        {
+            fprintf(stderr, "%-6s: %zu samples, the formula does not fit, original parameters kept\n",
+                    SENSOR_NAMES[i], samples[i].size());
+            status = 1;
+            continue;
+        }
+        parameters[i] = fit;
+        fitted[i] = true;
+
+        // Residuals of the integer formula used by the firmware
+        double squares = 0, largest = 0;
+        for (const Sample &sample : samples[i])
+        {
+            long adc = std::lround(sample.adc);
+            double distance = (adc < fit.max) ? OUT_OF_RANGE : (double)(fit.a / (adc + fit.b) + fit.c);
+            double residual = std::fabs(distance - sample.distance);
+            squares += residual * residual;
+            largest = std::fmax(largest, residual);
+        }
+        fprintf(stderr, "%-6s: %zu samples, A=%ld B=%ld C=%ld MAX=%ld, rms %.1f mm, max %.1f mm\n",
+                SENSOR_NAMES[i], samples[i].size(), fit.a, fit.b, fit.c, fit.max,
+                std::sqrt(squares / samples[i].size()), largest);
+    }
+
+    FILE *output = stdout;
+    if (argc == 3 && (output = fopen(argv[2], "w")) == nullptr)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+    Write_Header(output, parameters, fitted);
+    if (output != stdout) fclose(output);
+
+    return status;
+}
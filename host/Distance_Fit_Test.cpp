@@ -0,0 +1,204 @@
+/**
+ * @file Distance_Fit_Test.cpp
+ * @brief Host test that runs distance_fit on synthetic samples and checks the header it writes.
+ *
+ * Usage:
+ *
+ *  distance_fit_test
+ *
+ * Samples are generated from two known curves D = A / (ADC + B) + C, one for the right sensor and
+ * one for the left sensor, with and without ADC noise. The center sensor gets no samples. The
+ * input also holds a CSV header, a comment and a sample beyond 800 mm, which must be ignored.
+ * Distance_Fit.cpp (built with -Dmain=Distance_Fit_Main) writes the calibration header, which is
+ * read back to check that:
+ *  - The integer formula with the fitted parameters follows each true curve from 100 to 780 mm
+ *    to within MAX_RMS_EXACT mm RMS without noise, and MAX_RMS_NOISY mm RMS with noise.
+ *  - MAX is the ADC result at 800 mm to within one table step.
+ *  - The center sensor keeps the original shared parameters and is marked as not fitted.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Firmware tool entry point (main() of Distance_Fit.cpp renamed with -Dmain=Distance_Fit_Main)
+int Distance_Fit_Main(int argc, char *argv[]);
+
+// Files written in the build directory
+static const char *const SAMPLES_PATH = "build/distance_fit_samples.csv";
+static const char *const HEADER_PATH = "build/distance_fit_calibration.h";
+
+// Largest RMS error of the fitted formula in mm, without and with ADC noise
+static const double MAX_RMS_EXACT = 1.0;
+static const double MAX_RMS_NOISY = 6.0;
+
+// Peak ADC noise in counts
+static const int NOISE = 20;
+
+// Breakpoint spacing of the firmware tables (ANALOG_DISTANCE_SENSOR_TABLE_SHIFT)
+static const long TABLE_STEP = 128;
+
+static const char *const SENSOR_NAMES[3] = {"RIGHT", "CENTER", "LEFT"};
+
+struct Curve
+{
+    double a;
+    double b;
+    double c;
+};
+
+// True curves of the right and left sensors. The center sensor has no samples.
+static const Curve CURVES[3] = {{900000.0, -600.0, 20.0}, {0.0, 0.0, 0.0}, {1500000.0, -1400.0, 55.0}};
+
+// Original parameters shared by the three sensors
+static const long DEFAULT_PARAMETERS[4] = {1195159, -1058, 40, 2552};
+
+static double Curve_ADC(const Curve &curve, double distance)
+{
+    return curve.a / (distance - curve.c) - curve.b;
+}
+
+// Returns a pseudo-random noise in [-NOISE, NOISE] (fixed seed, so every run uses the same samples)
+static int Next_Noise(unsigned *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return (int)((*seed >> 16) % (2 * NOISE + 1)) - NOISE;
+}
+
+static bool Write_Samples(bool noisy)
+{
+    FILE *file = fopen(SAMPLES_PATH, "w");
+    if (file == nullptr) return false;
+
+    unsigned seed = 1;
+    fprintf(file, "sensor,adc,mm\n# synthetic samples\n");
+    for (int sensor = 0; sensor < 3; sensor += 2)
+    {
+        for (int distance = 100; distance <= 780; distance += 5)
+        {
+            double adc = Curve_ADC(CURVES[sensor], distance) + (noisy ? Next_Noise(&seed) : 0);
+            fprintf(file, "%s,%.0f,%d\n", (sensor == 0) ? "right" : "left", adc, distance);
+        }
+
+        // Beyond the range of the sensor: ignored by the fit
+        fprintf(file, "%d,%.0f,900\n", sensor, Curve_ADC(CURVES[sensor], 795.0));
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Reads ANALOG_DISTANCE_SENSOR_CAL_<sensor>_<A|B|C|MAX> back from the header
+static bool Read_Header(long parameters[3][4], bool fitted[3])
+{
+    FILE *file = fopen(HEADER_PATH, "r");
+    if (file == nullptr) return false;
+
+    static const char *const suffixes[4] = {"A", "B", "C", "MAX"};
+    int found = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            // Comment line of the sensor, e.g. "// Right sensor (A17, P9.0), not fitted"
+            if (std::strncmp(line, "// ", 3) == 0 && std::strstr(line, " sensor (") != nullptr)
+            {
+                std::string name(SENSOR_NAMES[i]);
+                std::string lower = name.substr(0, 1);
+                for (size_t k = 1; k < name.size(); k++) lower += (char)std::tolower((unsigned char)name[k]);
+                if (std::strncmp(line + 3, lower.c_str(), lower.size()) == 0)
+                {
+                    fitted[i] = (std::strstr(line, "not fitted") == nullptr);
+                }
+            }
+
+            for (int k = 0; k < 4; k++)
+            {
+                std::string macro = std::string("#define ANALOG_DISTANCE_SENSOR_CAL_") + SENSOR_NAMES[i] + "_" + suffixes[k] + " ";
+                if (std::strncmp(line, macro.c_str(), macro.size()) == 0)
+                {
+                    parameters[i][k] = std::strtol(line + macro.size(), nullptr, 10);
+                    found++;
+                }
+            }
+        }
+    }
+
+    fclose(file);
+    return found == 12;
+}
+
+static int Check(const char *name, bool noisy)
+{
+    long parameters[3][4];
+    bool fitted[3] = {false, false, false};
+    int failures = 0;
+
+    char program[] = "distance_fit";
+    char samples[64], header[64];
+    std::strcpy(samples, SAMPLES_PATH);
+    std::strcpy(header, HEADER_PATH);
+    char *argv[] = {program, samples, header, nullptr};
+
+    if (!Write_Samples(noisy) || Distance_Fit_Main(3, argv) != 0 || !Read_Header(parameters, fitted))
+    {
+        printf("%s: distance_fit failed or wrote an incomplete header\n", name);
+        return 1;
+    }
+
+    for (int sensor = 0; sensor < 3; sensor += 2)
+    {
+        const long *p = parameters[sensor];
+        double squares = 0;
+        int count = 0;
+
+        for (int distance = 100; distance <= 780; distance++)
+        {
+            long adc = std::lround(Curve_ADC(CURVES[sensor], distance));
+            double fitted_distance = (adc < p[3]) ? 800.0 : (double)(p[0] / (adc + p[1]) + p[2]);
+            squares += (fitted_distance - distance) * (fitted_distance - distance);
+            count++;
+        }
+
+        double rms = std::sqrt(squares / count);
+        double max_rms = noisy ? MAX_RMS_NOISY : MAX_RMS_EXACT;
+        double max_adc = Curve_ADC(CURVES[sensor], 800.0);
+        bool ok = fitted[sensor] && rms <= max_rms && std::fabs(p[3] - max_adc) <= TABLE_STEP;
+
+        printf("%s: %-6s A=%ld B=%ld C=%ld MAX=%ld (true MAX %.0f), rms %.2f mm  %s\n", name, SENSOR_NAMES[sensor],
+               p[0], p[1], p[2], p[3], max_adc, rms, ok ? "ok" : "FAIL");
+        if (!ok) failures++;
+    }
+
+    if (fitted[1] || std::memcmp(parameters[1], DEFAULT_PARAMETERS, sizeof(DEFAULT_PARAMETERS)) != 0)
+    {
+        printf("%s: the center sensor has no samples but its parameters changed\n", name);
+        failures++;
+    }
+
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    failures += Check("exact", false);
+    failures += Check("noisy", true);
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
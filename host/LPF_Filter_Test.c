@@ -0,0 +1,136 @@
+/**
+ * @file LPF_Filter_Test.c
+ * @brief Host test that checks independent LPF_FILTER objects against a reference moving average.
+ *
+ * Usage:
+ *
+ *  lpf_filter_test [samples]
+ *
+ * Three filters defined with LPF_FILTER run side by side on interleaved pseudo-random 14-bit samples:
+ *  - depth 4, 1 channel, updated with LPF_Calc
+ *  - depth 64, 1 channel, updated with LPF_Calc
+ *  - depth 16, 3 channels, updated alternately with LPF_Calc_Distance and LPF_Calc_Channels
+ *
+ * Each output must equal the moving average of a reference window of the same depth, primed
+ * with the same initial value. Since the filters are interleaved, a filter whose window or
+ * index leaks into another one is detected.
+ *
+ * The program exits with status 1 if an output differs.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/LPF.h"
+
+// Default number of samples fed to each filter
+#define SAMPLES             100000
+
+#define SMALL_SIZE          4
+#define LARGE_SIZE          64
+#define DISTANCE_SIZE       16
+
+LPF_FILTER(Small_Filter, SMALL_SIZE, 1);
+LPF_FILTER(Large_Filter, LARGE_SIZE, 1);
+LPF_FILTER(Distance_Filter, DISTANCE_SIZE, 3);
+
+// Moving average over a window of up to LARGE_SIZE samples
+typedef struct
+{
+    uint32_t window[LARGE_SIZE];
+    uint32_t size;
+    uint32_t index;
+} Reference_Filter;
+
+static void Reference_Init(Reference_Filter *filter, uint32_t size, uint32_t initial)
+{
+    filter->size = size;
+    filter->index = 0;
+    for (uint32_t i = 0; i < size; i++) filter->window[i] = initial;
+}
+
+static uint32_t Reference_Calc(Reference_Filter *filter, uint32_t data)
+{
+    uint32_t sum = 0;
+
+    filter->window[filter->index] = data;
+    filter->index = (filter->index + 1) % filter->size;
+    for (uint32_t i = 0; i < filter->size; i++) sum += filter->window[i];
+    return sum / filter->size;
+}
+
+// Returns a pseudo-random 14-bit ADC result (fixed seed, so every run uses the same sequence)
+static uint32_t Next_Sample(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return (*seed >> 16) & 0x3FFF;
+}
+
+int main(int argc, char **argv)
+{
+    long samples = (argc > 1) ? atol(argv[1]) : SAMPLES;
+    Reference_Filter small, large, distance[3];
+    uint32_t seed = 1;
+    int failures = 0;
+
+    LPF_Init(&Small_Filter, 100);
+    LPF_Init(&Large_Filter, 200);
+    LPF_Init(&Distance_Filter, 300);
+    Reference_Init(&small, SMALL_SIZE, 100);
+    Reference_Init(&large, LARGE_SIZE, 200);
+    for (int c = 0; c < 3; c++) Reference_Init(&distance[c], DISTANCE_SIZE, 300);
+
+    for (long i = 0; i < samples; i++)
+    {
+        uint32_t data = Next_Sample(&seed);
+        uint32_t outputs[2], expected[2], expected_channels[3];
+
+        outputs[0] = LPF_Calc(&Small_Filter, data);
+        expected[0] = Reference_Calc(&small, data);
+
+        data = Next_Sample(&seed);
+        outputs[1] = LPF_Calc(&Large_Filter, data);
+        expected[1] = Reference_Calc(&large, data);
+
+        // The three distance channels, through the batched call or the generic one
+        uint32_t channels[3];
+        for (int c = 0; c < 3; c++)
+        {
+            channels[c] = Next_Sample(&seed);
+            expected_channels[c] = Reference_Calc(&distance[c], channels[c]);
+        }
+        if (i & 1)
+        {
+            LPF_Calc_Channels(&Distance_Filter, channels, channels);
+        }
+        else
+        {
+            LPF_Calc_Distance(&Distance_Filter, &channels[0], &channels[1], &channels[2]);
+        }
+
+        if (outputs[0] != expected[0] || outputs[1] != expected[1])
+        {
+            if (failures < 10) printf("sample %ld: depth 4 %u (expected %u), depth 64 %u (expected %u)\n",
+                                      i, outputs[0], expected[0], outputs[1], expected[1]);
+            failures++;
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            if (channels[c] != expected_channels[c])
+            {
+                if (failures < 10) printf("sample %ld: depth 16 channel %d %u (expected %u)\n", i, c, channels[c], expected_channels[c]);
+                failures++;
+            }
+        }
+    }
+
+    printf("%ld samples, %d mismatches\n", samples, failures);
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
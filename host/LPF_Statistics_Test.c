@@ -0,0 +1,234 @@
+/**
+ * @file LPF_Statistics_Test.c
+ * @brief Host test for isqrt and the running-sum statistics of the LPF module.
+ *
+ * Usage:
+ *
+ *  lpf_statistics_test [samples]
+ *
+ * The test checks that:
+ *  - isqrt(s) is exactly floor(sqrt(s)), i.e. r*r <= s < (r+1)*(r+1), for 0, every perfect
+ *    square k*k and k*k-1 up to 65535*65535, 0xFFFFFFFF and RANDOM_ROOTS pseudo-random values.
+ *  - After every sample on a 16-deep, 3-channel filter, LPF_Variance equals a two-pass reference
+ *    computed exactly in integers over the same window, and LPF_Noise equals its isqrt. The
+ *    same holds on a 1024-deep filter, with 14-bit and then full 16-bit samples.
+ *  - On a 16-deep filter fed with blocks of BLOCK_SIZE samples around 8000 counts, alternately
+ *    clean (+-CLEAN_NOISE) and in "sunlight" (+-SUNLIGHT_NOISE), LPF_Is_Noisy with a minimum
+ *    SNR of 20 is true at the end of every sunlight block and false at the end of every clean one.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/LPF.h"
+
+// Default number of samples fed to the 16-deep filter
+#define SAMPLES             50000
+
+// Number of pseudo-random isqrt inputs, besides the squares and their neighbours
+#define RANDOM_ROOTS        409600
+
+#define SMALL_SIZE          16
+#define LARGE_SIZE          1024
+
+// Samples fed to the 1024-deep filter, for each sample width
+#define LARGE_SAMPLES       (4 * LARGE_SIZE)
+
+// Blocks of the SNR check
+#define BLOCKS              200
+#define BLOCK_SIZE          64
+#define BLOCK_MEAN          8000
+#define CLEAN_NOISE         20
+#define SUNLIGHT_NOISE      3000
+#define MIN_SNR             20
+
+LPF_FILTER(Small_Filter, SMALL_SIZE, 3);
+LPF_FILTER(Large_Filter, LARGE_SIZE, 1);
+LPF_FILTER(SNR_Filter, SMALL_SIZE, 1);
+
+static int Failures;
+
+static uint32_t Next_Random(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed;
+}
+
+// Returns a pseudo-random sample of the given width (fixed seed, so every run uses the same sequence)
+static uint32_t Next_Sample(uint32_t *seed, uint32_t bits)
+{
+    return (Next_Random(seed) >> 16) & ((1u << bits) - 1);
+}
+
+// Returns a pseudo-random value in [mean - noise, mean + noise]
+static uint32_t Next_Noisy(uint32_t *seed, uint32_t mean, uint32_t noise)
+{
+    return mean - noise + (Next_Random(seed) >> 8) % (2 * noise + 1);
+}
+
+static void Check_Root(uint32_t s)
+{
+    uint64_t r = isqrt(s);
+
+    if (r * r > s || (r + 1) * (r + 1) <= s)
+    {
+        if (Failures < 10) printf("isqrt(%u) = %u\n", s, (uint32_t)r);
+        Failures++;
+    }
+}
+
+static uint32_t Check_Roots(void)
+{
+    uint32_t seed = 1;
+    uint32_t count = 0;
+
+    Check_Root(0);
+    Check_Root(0xFFFFFFFF);
+    count += 2;
+    for (uint32_t k = 1; k <= 65535; k++)
+    {
+        Check_Root(k * k);
+        Check_Root(k * k - 1);
+        count += 2;
+    }
+    for (uint32_t i = 0; i < RANDOM_ROOTS; i++)
+    {
+        Check_Root(Next_Random(&seed));
+        count++;
+    }
+    return count;
+}
+
+// Variance of a window in two passes: sum((n*x - S)^2) / (n^2*(n-1)), which equals the
+// definition sum((x - S/n)^2) / (n-1) rounded down, without fractions
+static uint32_t Reference_Variance(const uint16_t *window, uint32_t size, uint32_t stride)
+{
+    uint64_t sum = 0, squares = 0;
+
+    for (uint32_t i = 0; i < size; i++) sum += window[i * stride];
+    for (uint32_t i = 0; i < size; i++)
+    {
+        int64_t deviation = (int64_t)size * window[i * stride] - (int64_t)sum;
+        squares += (uint64_t)(deviation * deviation);
+    }
+    return squares / ((uint64_t)size * size * (size - 1));
+}
+
+static void Check_Variance(const char *name, const LPF_Filter *filter, const uint16_t *window, long sample)
+{
+    for (uint32_t c = 0; c < filter->channels; c++)
+    {
+        uint32_t expected = Reference_Variance(&window[c], filter->size, filter->channels);
+        uint32_t variance = LPF_Variance(filter, c);
+        int32_t noise = LPF_Noise(filter, c);
+
+        if (variance != expected || noise != (int32_t)isqrt(expected))
+        {
+            if (Failures < 10) printf("%s, sample %ld, channel %u: variance %u noise %d (expected %u, %u)\n",
+                                      name, sample, c, variance, noise, expected, isqrt(expected));
+            Failures++;
+        }
+    }
+}
+
+static void Check_Small(long samples)
+{
+    static uint16_t window[SMALL_SIZE * 3];
+    uint32_t seed = 2;
+    uint32_t index = 0;
+
+    LPF_Init(&Small_Filter, 1000);
+    for (uint32_t i = 0; i < SMALL_SIZE * 3; i++) window[i] = 1000;
+    Check_Variance("depth 16", &Small_Filter, window, -1);
+
+    for (long i = 0; i < samples; i++)
+    {
+        uint32_t data[3], result[3];
+
+        for (int c = 0; c < 3; c++)
+        {
+            data[c] = Next_Sample(&seed, 14);
+            window[index * 3 + c] = data[c];
+        }
+        index = (index + 1) % SMALL_SIZE;
+        LPF_Calc_Channels(&Small_Filter, data, result);
+        Check_Variance("depth 16", &Small_Filter, window, i);
+    }
+}
+
+static void Check_Large(uint32_t bits)
+{
+    static uint16_t window[LARGE_SIZE];
+    const char *name = (bits == 16) ? "depth 1024, 16 bits" : "depth 1024, 14 bits";
+    uint32_t seed = 3;
+    uint32_t index = 0;
+
+    LPF_Init(&Large_Filter, 0);
+    for (uint32_t i = 0; i < LARGE_SIZE; i++) window[i] = 0;
+
+    for (long i = 0; i < LARGE_SAMPLES; i++)
+    {
+        uint32_t data = Next_Sample(&seed, bits);
+
+        window[index] = data;
+        index = (index + 1) % LARGE_SIZE;
+        LPF_Calc(&Large_Filter, data);
+        Check_Variance(name, &Large_Filter, window, i);
+    }
+}
+
+static void Check_SNR(void)
+{
+    uint32_t seed = 4;
+    int flagged[2] = {0, 0};
+
+    LPF_Init(&SNR_Filter, BLOCK_MEAN);
+    for (int block = 0; block < BLOCKS; block++)
+    {
+        int sunlight = block & 1;
+        uint32_t noise = sunlight ? SUNLIGHT_NOISE : CLEAN_NOISE;
+
+        for (int i = 0; i < BLOCK_SIZE; i++)
+        {
+            LPF_Calc(&SNR_Filter, Next_Noisy(&seed, BLOCK_MEAN, noise));
+        }
+
+        bool noisy = LPF_Is_Noisy(&SNR_Filter, 0, MIN_SNR);
+        if (noisy) flagged[sunlight]++;
+        if (noisy != sunlight)
+        {
+            if (Failures < 10) printf("%s block %d: noisy %d, noise %d\n", sunlight ? "sunlight" : "clean",
+                                      block, noisy, LPF_Noise(&SNR_Filter, 0));
+            Failures++;
+        }
+    }
+    printf("%d of %d sunlight blocks and %d of %d clean blocks flagged\n",
+           flagged[1], BLOCKS / 2, flagged[0], BLOCKS / 2);
+}
+
+int main(int argc, char **argv)
+{
+    long samples = (argc > 1) ? atol(argv[1]) : SAMPLES;
+
+    uint32_t roots = Check_Roots();
+    printf("%u isqrt inputs\n", roots);
+
+    Check_Small(samples);
+    Check_Large(14);
+    Check_Large(16);
+    printf("%ld samples at depth 16, %d at depth 1024\n", samples, 2 * LARGE_SAMPLES);
+
+    Check_SNR();
+
+    if (Failures)
+    {
+        printf("%d failures\n", Failures);
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
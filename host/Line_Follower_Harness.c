@@ -0,0 +1,158 @@
+/**
+ * @file Line_Follower_Harness.c
+ * @brief Host test harness that runs the line follower firmware on a simulated track.
+ *
+ * Usage:
+ *
+ *  line_follower_harness [seconds]
+ *
+ * The firmware in software/Final_Project_main.c (built with -Dmain=Firmware_Main) runs on the
+ * MSP432_Host emulator against a simple model of the RSLK chassis:
+ *  - The motors are read from the Timer_A0 CCR3/CCR4 duty cycles, the direction pins P5.4/P5.5
+ *    and the enable pins P3.6/P3.7, and move the robot with differential drive kinematics.
+ *  - The QTRX outputs on P7 are driven high after each charge pulse and decay after a short
+ *    time over the white floor or a long time over the black line.
+ *
+ * The track is straight for one second, then curves to the left and to the right. Once per
+ * 100 ms the harness prints the time, the offset of the line from the center of the sensor array
+ * and the motor duty cycles. It exits with status 0 if the line stayed under the sensor array
+ * for the whole run, or 1 if the robot lost the line.
+ *
+ * @note Build with "make -C host line_follower_harness" and run with "make -C host test".
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "MSP432_Host.h"
+
+// Default length of the run in seconds
+#define RUN_TIME            5.0
+
+// Wheel speed at 100% duty cycle in mm/s and distance between the wheels in mm
+#define WHEEL_SPEED_MAX     500.0
+#define WHEEL_BASE          140.0
+
+// Timer_A0 period used by Motor_Init()
+#define PWM_PERIOD          15000.0
+
+// Half the width of the black line in mm
+#define LINE_HALF_WIDTH     9.5
+
+// Time for a QTRX output to decay over the white floor and over the black line in us
+#define DECAY_WHITE_US      200
+#define DECAY_BLACK_US      2500
+
+// Lateral position of each sensor in mm (P7.0 on the right, positive values to the right)
+static const double Sensor_Offset[8] = {33.4, 23.8, 14.2, 4.8, -4.8, -14.2, -23.8, -33.4};
+
+// Firmware entry point (main() of Final_Project_main.c renamed with -Dmain=Firmware_Main)
+extern int Firmware_Main(void);
+
+// Offset of the line from the center of the sensor array in mm, positive to the right
+static double Line_Offset = 0.0;
+
+// Heading of the robot relative to the track in radians, positive to the right
+static double Heading_Error = 0.0;
+
+// Largest line offset seen during the run
+static double Max_Line_Offset = 0.0;
+
+// Time of the next status line in seconds
+static double Next_Report = 0.1;
+
+// Cycle count at the previous tick and at the end of the last charge pulse
+static uint64_t Last_Cycles = 0;
+static uint64_t Release_Cycles = 0;
+static int Charged = 0;
+
+// Returns the curvature of the track in 1/mm at a given time, positive to the left
+static double Track_Curvature(double time)
+{
+    if (time < 1.0) return 0.0;
+    if (time < 2.5) return 1.0 / 600.0;
+    if (time < 4.0) return -1.0 / 600.0;
+    return 0.0;
+}
+
+// Returns the signed speed of a wheel in mm/s
+static double Wheel_Speed(uint16_t duty_cycle, uint8_t backward, uint8_t enabled)
+{
+    if (!enabled) return 0.0;
+    double speed = WHEEL_SPEED_MAX * duty_cycle / PWM_PERIOD;
+    return backward ? -speed : speed;
+}
+
+// Moves the robot and updates the QTRX outputs every time the virtual clock moves
+static void Tick(uint64_t cycles)
+{
+    double mclk = MSP432_Host_Get_MCLK();
+    double dt = (cycles - Last_Cycles) / mclk;
+    double time = cycles / mclk;
+
+    // Right motor on CCR3 and P5.5, left motor on CCR4 and P5.4
+    double right = Wheel_Speed(TIMER_A0->CCR[3], P5->OUT & 0x20, P3->OUT & 0x80);
+    double left  = Wheel_Speed(TIMER_A0->CCR[4], P5->OUT & 0x10, P3->OUT & 0x40);
+    double speed = (left + right) / 2.0;
+
+    // Turning right or a track that curves to the left turns the robot to the right of the track,
+    // which moves the line to the left of the sensor array
+    Heading_Error += ((left - right) / WHEEL_BASE + speed * Track_Curvature(time)) * dt;
+    Line_Offset -= speed * sin(Heading_Error) * dt;
+    if (fabs(Line_Offset) > Max_Line_Offset) Max_Line_Offset = fabs(Line_Offset);
+
+    // The decay starts when the firmware turns P7 back into inputs. The change is seen on the
+    // tick after the write, so the decay is timed from the previous tick.
+    if (P7->DIR != 0)
+    {
+        Charged = 1;
+    }
+    else if (Charged)
+    {
+        Charged = 0;
+        Release_Cycles = Last_Cycles;
+    }
+
+    uint8_t high = 0;
+    uint64_t elapsed_us = (cycles - Release_Cycles) * 1000000 / (uint64_t)mclk;
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t decay_us = (fabs(Sensor_Offset[i] - Line_Offset) < LINE_HALF_WIDTH) ? DECAY_BLACK_US : DECAY_WHITE_US;
+        if (elapsed_us < decay_us) high |= 1 << i;
+    }
+    MSP432_Host_Set_Port_Input(7, 0xFF, high);
+
+    if (time >= Next_Report)
+    {
+        printf("%6.1f s  line %7.2f mm  left %5u  right %5u\n", Next_Report, Line_Offset,
+               (unsigned)TIMER_A0->CCR[4], (unsigned)TIMER_A0->CCR[3]);
+        Next_Report += 0.1;
+    }
+
+    Last_Cycles = cycles;
+}
+
+int main(int argc, char **argv)
+{
+    double run_time = (argc > 1) ? atof(argv[1]) : RUN_TIME;
+
+    MSP432_Host_Reset();
+    MSP432_Host_Set_Tick_Callback(&Tick);
+
+    // Bumper switches released (pulled up)
+    MSP432_Host_Set_Port_Input(4, 0xED, 0xED);
+
+    // The main loop never returns, so the run ends when the cycle budget is used up
+    MSP432_Host_Run(&Firmware_Main, (uint64_t)(run_time * 48000000.0));
+
+    printf("Largest line offset: %.2f mm\n", Max_Line_Offset);
+    if (Max_Line_Offset >= fabs(Sensor_Offset[0]))
+    {
+        printf("FAIL: the robot lost the line\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file Log_Render.cpp
+ * @brief Command-line tool that prints the text of a deferred log capture.
+ *
+ * Usage:
+ *
+ *  log_render [--clock frequency] firmware.out capture.bin
+ *
+ * The format strings are read from the .log_strings section of the firmware image (32-bit or
+ * 64-bit ELF, so host builds of the firmware can be rendered as well), and each COBS frame of
+ * the capture (see inc/Log.h) is printed as one line prefixed with its time in seconds. The
+ * clock frequency used to convert the DWT cycle counts defaults to 48 MHz.
+ *
+ *  g++ -O2 -std=c++11 host/Log_Render.cpp -o log_render
+ *
+ * @note Host builds must be linked with -no-pie, so that the string addresses fit in 32 bits.
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Format strings of the firmware: section address and contents
+struct Log_Strings
+{
+    uint64_t address;
+    std::vector<char> data;
+};
+
+static bool Read_File(const char *path, std::vector<uint8_t> &contents)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) return false;
+
+    uint8_t block[65536];
+    size_t length;
+    while ((length = fread(block, 1, sizeof(block), file)) > 0)
+    {
+        contents.insert(contents.end(), block, block + length);
+    }
+    fclose(file);
+    return true;
+}
+
+static uint64_t Read_Little(const std::vector<uint8_t> &data, size_t offset, size_t size)
+{
+    uint64_t value = 0;
+    if (offset + size > data.size()) return 0;
+    for (size_t i = 0; i < size; i++) value |= (uint64_t)data[offset + i] << (8 * i);
+    return value;
+}
+
+// Finds the .log_strings section in a little-endian ELF image
+static bool Load_Strings(const std::vector<uint8_t> &elf, Log_Strings &strings)
+{
+    if (elf.size() < 64 || std::memcmp(elf.data(), "\x7F" "ELF", 4) != 0 || elf[5] != 1) return false;
+
+    bool is_64 = (elf[4] == 2);
+    uint64_t section_offset = is_64 ? Read_Little(elf, 0x28, 8) : Read_Little(elf, 0x20, 4);
+    size_t entry_size = Read_Little(elf, is_64 ? 0x3A : 0x2E, 2);
+    size_t count = Read_Little(elf, is_64 ? 0x3C : 0x30, 2);
+    size_t names_index = Read_Little(elf, is_64 ? 0x3E : 0x32, 2);
+
+    // Fields of a section header: name, address, file offset and size
+    auto header = [&](size_t index, uint64_t &name, uint64_t &address, uint64_t &offset, uint64_t &size)
+    {
+        size_t base = section_offset + index * entry_size;
+        name = Read_Little(elf, base, 4);
+        address = is_64 ? Read_Little(elf, base + 0x10, 8) : Read_Little(elf, base + 0x0C, 4);
+        offset = is_64 ? Read_Little(elf, base + 0x18, 8) : Read_Little(elf, base + 0x10, 4);
+        size = is_64 ? Read_Little(elf, base + 0x20, 8) : Read_Little(elf, base + 0x14, 4);
+    };
+
+    uint64_t name, address, names_offset, size;
+    header(names_index, name, address, names_offset, size);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t offset;
+        header(i, name, address, offset, size);
+        if (names_offset + name >= elf.size() || offset + size > elf.size()) continue;
+        if (std::strcmp(reinterpret_cast<const char *>(&elf[names_offset + name]), ".log_strings") != 0) continue;
+
+        strings.address = address;
+        strings.data.assign(elf.begin() + offset, elf.begin() + offset + size);
+        strings.data.push_back('\0');
+        return true;
+    }
+    return false;
+}
+
+// Formats a record with its format string. Returns false if the arguments do not match the string.
+static bool Render(const char *format, const uint32_t *arguments, size_t count, std::string &text)
+{
+    size_t used = 0;
+    char buffer[64];
+
+    for (const char *p = format; *p; p++)
+    {
+        if (*p != '%')
+        {
+            text += *p;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            text += '%';
+            p++;
+            continue;
+        }
+
+        // Copy the flags, width and precision of the conversion
+        std::string specification = "%";
+        p++;
+        while (*p && std::strchr("-+ #0123456789.", *p)) specification += *p++;
+
+        char conversion = *p;
+        if (conversion == '\0' || !std::strchr("diuxXoc", conversion) || used >= count || specification.size() > 16) return false;
+
+        uint32_t value = arguments[used++];
+        if (conversion == 'd' || conversion == 'i')
+        {
+            snprintf(buffer, sizeof(buffer), (specification + conversion).c_str(), (int)(int32_t)value);
+        }
+        else if (conversion == 'c')
+        {
+            snprintf(buffer, sizeof(buffer), (specification + conversion).c_str(), (int)(value & 0xFF));
+        }
+        else
+        {
+            snprintf(buffer, sizeof(buffer), (specification + conversion).c_str(), (unsigned int)value);
+        }
+        text += buffer;
+    }
+
+    return used == count;
+}
+
+// Decodes one COBS frame. Returns false if the frame is malformed.
+static bool COBS_Decode(const uint8_t *frame, size_t length, std::vector<uint8_t> &data)
+{
+    data.clear();
+    size_t i = 0;
+    while (i < length)
+    {
+        uint8_t code = frame[i++];
+        if (code == 0 || i + code - 1 > length) return false;
+        data.insert(data.end(), frame + i, frame + i + code - 1);
+        i += code - 1;
+        if (code != 0xFF && i < length) data.push_back(0);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    double frequency = 48000000.0;
+    int arg = 1;
+
+    if (arg + 1 < argc && std::strcmp(argv[arg], "--clock") == 0)
+    {
+        frequency = std::atof(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg + 2 != argc || frequency <= 0)
+    {
+        fprintf(stderr, "usage: %s [--clock frequency] firmware.out capture.bin\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> elf, capture;
+    Log_Strings strings;
+    if (!Read_File(argv[arg], elf) || !Load_Strings(elf, strings))
+    {
+        fprintf(stderr, "%s: no .log_strings section\n", argv[arg]);
+        return 1;
+    }
+    if (!Read_File(argv[arg + 1], capture))
+    {
+        perror(argv[arg + 1]);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    std::string text;
+    uint64_t time = 0;
+    uint32_t previous = 0;
+    bool first = true;
+    size_t errors = 0;
+    size_t start = 0;
+
+    for (size_t i = 0; i < capture.size(); i++)
+    {
+        if (capture[i] != 0) continue;
+
+        size_t length = i - start;
+        const uint8_t *frame = &capture[start];
+        start = i + 1;
+        if (length == 0) continue;
+
+        if (!COBS_Decode(frame, length, data) || data.size() < 8 || data.size() % 4 != 0
+            || data.size() > 4 * (2 + 4))
+        {
+            errors++;
+            continue;
+        }
+
+        uint32_t words[6];
+        size_t count = data.size() / 4;
+        for (size_t w = 0; w < count; w++)
+        {
+            words[w] = data[4 * w] | (data[4 * w + 1] << 8) | (data[4 * w + 2] << 16) | ((uint32_t)data[4 * w + 3] << 24);
+        }
+
+        // Extend the 32-bit cycle count, assuming records are less than one wrap-around apart
+        time = first ? words[1] : time + (uint32_t)(words[1] - previous);
+        previous = words[1];
+        first = false;
+
+        text.clear();
+        uint64_t offset = (uint64_t)words[0] - (strings.address & 0xFFFFFFFF);
+        if (words[0] == 0 && count == 3)
+        {
+            text = "<" + std::to_string(words[2]) + " log records dropped>";
+        }
+        else if (offset >= strings.data.size() || !Render(&strings.data[offset], &words[2], count - 2, text))
+        {
+            errors++;
+            continue;
+        }
+
+        printf("[%12.6f] %s\n", time / frequency, text.c_str());
+    }
+
+    if (errors) fprintf(stderr, "%zu malformed frames\n", errors);
+    return 0;
+}
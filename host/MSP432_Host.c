@@ -0,0 +1,1655 @@
+/**
+ * @file MSP432_Host.c
+ * @brief Source code for the MSP432_Host peripheral emulator.
+ *
+ * This file contains the emulated register blocks declared in host/msp.h, the virtual clock
+ * that drives them, the interrupt dispatcher and the host implementation of the CortexM.c
+ * functions (DisableInterrupts, EnableInterrupts, StartCritical, EndCritical, WaitForInterrupt).
+ *
+ * The emulator is event driven. MSP432_Host_Advance() repeatedly computes the number of cycles
+ * until the next peripheral event (SysTick reload, Timer_A compare, end of an eUSCI character,
+ * end of an ADC14 conversion), moves every peripheral forward by that amount and then takes the
+ * highest priority pending interrupt, so long runs cost one loop iteration per event instead of
+ * one per cycle.
+ *
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MSP432_Host.h"
+
+// Value kept in TXBUF while the transmit buffer is empty. Drivers write 8-bit data
+// (sign-extended for char), so bit 8 alone never appears in a real write.
+#define TXBUF_EMPTY             0x0100
+
+// Priority of the thread (non-handler) context, lower than any configurable priority
+#define THREAD_PRIORITY         8
+
+// Number of device-specific interrupts that are emulated (IRQ 0 to IRQ 40)
+#define NUM_IRQ                 41
+
+// Maximum number of I2C slave models per eUSCI_B module
+#define MAX_I2C_DEVICES         4
+
+// Size of the per-module receive queue used by MSP432_Host_EUSCI_Receive()
+#define RX_QUEUE_SIZE           256
+
+// Number of register accesses after which a busy-wait receiver is assumed to have read RXBUF
+#define RX_READ_ACCESSES        3
+
+// Number of DMA channels of the MSP432P401R
+#define NUM_DMA_CHANNELS        8
+
+// Frequencies of the clock sources selectable through the CS module
+#define DCO_FREQUENCY           3000000
+#define HFXT_FREQUENCY          48000000
+#define MODOSC_FREQUENCY        25000000
+#define LFXT_FREQUENCY          32768
+#define REFO_FREQUENCY          32768
+#define VLO_FREQUENCY           9400
+
+// Emulated register blocks
+DIO_PORT_Interruptable_Type MSP432_Host_Port[10];
+DIO_PORT_Not_Interruptable_Type MSP432_Host_PortJ;
+Timer_A_Type MSP432_Host_Timer_A[4];
+PCM_Type MSP432_Host_PCM;
+CS_Type MSP432_Host_CS;
+uint32_t MSP432_Host_Info_Memory[4096];
+SysTick_Type MSP432_Host_SysTick;
+NVIC_Type MSP432_Host_NVIC;
+SCB_Type MSP432_Host_SCB;
+DWT_Type MSP432_Host_DWT;
+CoreDebug_Type MSP432_Host_CoreDebug;
+
+static EUSCI_A_Type EUSCI_A_Registers[4];
+static EUSCI_B_Type EUSCI_B_Registers[4];
+static ADC14_Type ADC14_Registers;
+static FLCTL_Type FLCTL_Registers;
+static DMA_Channel_Type DMA_Channel_Registers;
+static DMA_Control_Type DMA_Control_Registers;
+
+// Handlers are weak references so that programs only need to link the drivers they use
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void TA0_0_IRQHandler(void) __attribute__((weak));
+extern void TA0_N_IRQHandler(void) __attribute__((weak));
+extern void TA1_0_IRQHandler(void) __attribute__((weak));
+extern void TA1_N_IRQHandler(void) __attribute__((weak));
+extern void TA2_0_IRQHandler(void) __attribute__((weak));
+extern void TA2_N_IRQHandler(void) __attribute__((weak));
+extern void TA3_0_IRQHandler(void) __attribute__((weak));
+extern void TA3_N_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA0_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA1_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA2_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA3_IRQHandler(void) __attribute__((weak));
+extern void EUSCIB0_IRQHandler(void) __attribute__((weak));
+extern void EUSCIB1_IRQHandler(void) __attribute__((weak));
+extern void EUSCIB2_IRQHandler(void) __attribute__((weak));
+extern void EUSCIB3_IRQHandler(void) __attribute__((weak));
+extern void ADC14_IRQHandler(void) __attribute__((weak));
+extern void DMA_INT3_IRQHandler(void) __attribute__((weak));
+extern void DMA_INT2_IRQHandler(void) __attribute__((weak));
+extern void DMA_INT1_IRQHandler(void) __attribute__((weak));
+extern void DMA_INT0_IRQHandler(void) __attribute__((weak));
+extern void PORT1_IRQHandler(void) __attribute__((weak));
+extern void PORT2_IRQHandler(void) __attribute__((weak));
+extern void PORT3_IRQHandler(void) __attribute__((weak));
+extern void PORT4_IRQHandler(void) __attribute__((weak));
+extern void PORT5_IRQHandler(void) __attribute__((weak));
+extern void PORT6_IRQHandler(void) __attribute__((weak));
+
+// Device-specific interrupt handlers indexed by IRQ number (Table 6-39 of the MSP432P401R datasheet)
+static void (* const IRQ_Handler[NUM_IRQ])(void) =
+{
+    [8]  = TA0_0_IRQHandler,    [9]  = TA0_N_IRQHandler,
+    [10] = TA1_0_IRQHandler,    [11] = TA1_N_IRQHandler,
+    [12] = TA2_0_IRQHandler,    [13] = TA2_N_IRQHandler,
+    [14] = TA3_0_IRQHandler,    [15] = TA3_N_IRQHandler,
+    [16] = EUSCIA0_IRQHandler,  [17] = EUSCIA1_IRQHandler,
+    [18] = EUSCIA2_IRQHandler,  [19] = EUSCIA3_IRQHandler,
+    [20] = EUSCIB0_IRQHandler,  [21] = EUSCIB1_IRQHandler,
+    [22] = EUSCIB2_IRQHandler,  [23] = EUSCIB3_IRQHandler,
+    [24] = ADC14_IRQHandler,
+    [31] = DMA_INT3_IRQHandler, [32] = DMA_INT2_IRQHandler,
+    [33] = DMA_INT1_IRQHandler, [34] = DMA_INT0_IRQHandler,
+    [35] = PORT1_IRQHandler,    [36] = PORT2_IRQHandler,
+    [37] = PORT3_IRQHandler,    [38] = PORT4_IRQHandler,
+    [39] = PORT5_IRQHandler,    [40] = PORT6_IRQHandler
+};
+
+// Pointers to the registers shared by the eUSCI_A and eUSCI_B register layouts
+typedef struct
+{
+    volatile uint16_t *CTLW0;
+    volatile uint16_t *BRW;
+    volatile uint16_t *MCTLW;
+    volatile uint16_t *STATW;
+    volatile uint16_t *RXBUF;
+    volatile uint16_t *TXBUF;
+    volatile uint16_t *IE;
+    volatile uint16_t *IFG;
+    volatile uint16_t *I2CSA;
+} EUSCI_Registers;
+
+typedef enum
+{
+    I2C_IDLE,
+    I2C_ADDRESS,
+    I2C_TRANSMIT,
+    I2C_RECEIVE
+} I2C_State;
+
+typedef struct
+{
+    EUSCI_Registers reg;
+    bool tx_busy;
+    uint8_t tx_data;
+    uint64_t tx_done;
+    uint8_t rx_queue[RX_QUEUE_SIZE];
+    uint16_t rx_head;
+    uint16_t rx_tail;
+    uint64_t rx_next;
+    uint8_t rx_accesses;
+    void (*tx_callback)(uint8_t data);
+    const MSP432_Host_I2C_Device *devices[MAX_I2C_DEVICES];
+    uint8_t num_devices;
+    const MSP432_Host_I2C_Device *current;
+    bool acknowledged;
+    I2C_State i2c_state;
+    uint64_t i2c_done;
+} EUSCI_State;
+
+typedef struct
+{
+    uint32_t accumulated;
+    bool counting_down;
+} Timer_State;
+
+// Entry of the DMA control table, laid out like the structure used by the firmware
+typedef struct
+{
+    volatile void *source_end;
+    volatile void *destination_end;
+    volatile uint32_t control;
+    volatile uint32_t spare;
+} DMA_Control_Entry;
+
+typedef struct
+{
+    uint32_t enabled;
+    uint32_t alternate;
+    uint32_t flags;
+    bool level[NUM_DMA_CHANNELS];
+} DMA_State;
+
+typedef struct
+{
+    bool busy;
+    uint8_t next;
+    uint8_t last;
+    uint8_t position;
+    uint64_t next_done;
+    uint64_t conversion_cycles;
+} ADC14_State;
+
+static uint64_t Cycles;
+static uint64_t Budget_End;
+static bool Budget_Active;
+static jmp_buf Budget_Jump;
+
+static uint32_t Primask;
+static int Active_Priority = THREAD_PRIORITY;
+static uint32_t NVIC_Enabled[2];
+static uint32_t NVIC_Pending[2];
+static bool SysTick_Pending;
+
+static uint8_t Port_Driven_Mask[10];
+static uint8_t Port_Driven_Value[10];
+
+static Timer_State Timer[4];
+static EUSCI_State EUSCI[8];
+static ADC14_State ADC;
+static DMA_State DMA;
+
+static void (*Tick_Callback)(uint64_t cycles);
+static uint16_t (*ADC14_Callback)(uint8_t channel);
+
+static uint32_t Source_Frequency(uint32_t select)
+{
+    switch(select)
+    {
+        case 0:  return LFXT_FREQUENCY;
+        case 1:  return VLO_FREQUENCY;
+        case 2:  return REFO_FREQUENCY;
+        case 4:  return MODOSC_FREQUENCY;
+        case 5:  return HFXT_FREQUENCY;
+        default: return DCO_FREQUENCY;
+    }
+}
+
+uint32_t MSP432_Host_Get_MCLK(void)
+{
+    uint32_t ctl1 = MSP432_Host_CS.CTL1;
+    return Source_Frequency(ctl1 & 0x7) >> ((ctl1 >> 16) & 0x7);
+}
+
+static uint32_t Get_SMCLK(void)
+{
+    uint32_t ctl1 = MSP432_Host_CS.CTL1;
+    return Source_Frequency((ctl1 >> 4) & 0x7) >> ((ctl1 >> 28) & 0x7);
+}
+
+static uint32_t Get_ACLK(void)
+{
+    uint32_t ctl1 = MSP432_Host_CS.CTL1;
+    return Source_Frequency((ctl1 >> 8) & 0x7) >> ((ctl1 >> 24) & 0x7);
+}
+
+// Number of MCLK cycles per period of a peripheral clock, at least 1
+static uint32_t MCLK_Per(uint32_t frequency)
+{
+    uint32_t ratio = MSP432_Host_Get_MCLK() / frequency;
+    return (ratio == 0) ? 1 : ratio;
+}
+
+//**************SysTick**************
+
+static uint64_t SysTick_Cycles_To_Event(void)
+{
+    if ((MSP432_Host_SysTick.CTRL & 0x1) == 0) return UINT64_MAX;
+    uint32_t value = MSP432_Host_SysTick.VAL & 0x00FFFFFF;
+    return (value == 0) ? (uint64_t)(MSP432_Host_SysTick.LOAD & 0x00FFFFFF) + 1 : value;
+}
+
+static void SysTick_Step(uint64_t cycles)
+{
+    uint64_t remaining = SysTick_Cycles_To_Event();
+    if (remaining == UINT64_MAX) return;
+
+    remaining = remaining - cycles;
+    MSP432_Host_SysTick.VAL = (uint32_t)remaining;
+    if (remaining == 0)
+    {
+        // Set COUNTFLAG and request the exception if TICKINT is set
+        MSP432_Host_SysTick.CTRL |= 0x00010000;
+        if (MSP432_Host_SysTick.CTRL & 0x2) SysTick_Pending = true;
+    }
+}
+
+//**************Timer_A**************
+
+static void ADC14_Trigger(void);
+
+// Returns the count at which the output of a compare channel rises, if that output is the
+// ADC14 sample-and-hold source (ADC14SHSx 1 - 7: TA0_C1, TA0_C2, TA1_C1, TA1_C2, TA2_C1,
+// TA2_C2, TA3_C1). Only the Set/Reset and Reset/Set output modes are emulated.
+static bool Timer_ADC14_Edge(int index, uint32_t *target)
+{
+    static const int8_t timers[8] = {-1, 0, 0, 1, 1, 2, 2, 3};
+    static const int8_t channels[8] = {-1, 1, 2, 1, 2, 1, 2, 1};
+
+    uint32_t shs = (ADC14_Registers.CTL0 >> 27) & 0x7;
+    if (timers[shs] != index) return false;
+
+    Timer_A_Type *timer = &MSP432_Host_Timer_A[index];
+    uint16_t cctl = timer->CCTL[channels[shs]];
+    if (cctl & 0x0100) return false;
+
+    switch ((cctl >> 5) & 0x7)
+    {
+        case 3:  *target = timer->CCR[channels[shs]]; return true;  // Set/Reset: set at CCRn
+        case 7:  *target = timer->CCR[0]; return true;              // Reset/Set: set at CCR0
+        default: return false;
+    }
+}
+
+// Number of MCLK cycles per timer count, or 0 if the timer is stopped
+static uint32_t Timer_Divider(Timer_A_Type *timer)
+{
+    uint32_t source;
+    switch((timer->CTL >> 8) & 0x3)
+    {
+        case 1:  source = Get_ACLK(); break;
+        case 2:  source = Get_SMCLK(); break;
+        default: return 0;  // TAxCLK and INCLK are not connected
+    }
+    uint32_t id = 1 << ((timer->CTL >> 6) & 0x3);
+    uint32_t idex = (timer->EX0 & 0x7) + 1;
+    return MCLK_Per(source) * id * idex;
+}
+
+// Counting period in timer counts and the current phase within it.
+// Up/Down mode is unfolded so that phase CCR0 + k corresponds to counting down from CCR0 - k.
+static bool Timer_Phase(Timer_A_Type *timer, Timer_State *state, uint32_t *period, uint32_t *phase)
+{
+    uint32_t mode = (timer->CTL >> 4) & 0x3;
+    uint32_t ccr0 = timer->CCR[0];
+    uint32_t count = timer->R;
+
+    switch(mode)
+    {
+        case 1:
+            if (ccr0 == 0) return false;
+            if (count > ccr0)
+            {
+                // CCR0 was lowered below the count: the timer rolls over at 0xFFFF
+                *period = 0x10000;
+                *phase = count;
+                return true;
+            }
+            *period = ccr0 + 1;
+            *phase = count;
+            return true;
+        case 2:
+            *period = 0x10000;
+            *phase = count;
+            return true;
+        case 3:
+            if (ccr0 == 0) return false;
+            *period = 2 * ccr0;
+            *phase = state->counting_down ? (2 * ccr0 - count) % (2 * ccr0) : count;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint32_t Distance(uint32_t from, uint32_t to, uint32_t period)
+{
+    uint32_t distance = (to + period - from) % period;
+    return (distance == 0) ? period : distance;
+}
+
+// Number of timer counts until the next flag that can raise an interrupt
+static uint32_t Timer_Counts_To_Event(Timer_A_Type *timer, Timer_State *state)
+{
+    uint32_t period, phase;
+    if (!Timer_Phase(timer, state, &period, &phase)) return UINT32_MAX;
+
+    uint32_t mode = (timer->CTL >> 4) & 0x3;
+    uint32_t counts = UINT32_MAX;
+
+    // TAIFG is set when the count returns to zero
+    if (timer->CTL & 0x0002)
+    {
+        uint32_t d = Distance(phase, 0, period);
+        if (d < counts) counts = d;
+    }
+
+    for (int i = 0; i < 7; i++)
+    {
+        uint16_t cctl = timer->CCTL[i];
+
+        // Only compare channels with CCIE set generate events
+        if ((cctl & 0x0100) || !(cctl & 0x0010)) continue;
+
+        uint32_t target = timer->CCR[i];
+        if (target >= period && mode != 3) continue;
+        if (mode == 3 && target > timer->CCR[0]) continue;
+
+        uint32_t d = Distance(phase, target, period);
+        if (d < counts) counts = d;
+        if (mode == 3 && target != 0 && target != timer->CCR[0])
+        {
+            d = Distance(phase, period - target, period);
+            if (d < counts) counts = d;
+        }
+    }
+
+    // Rising edge of the ADC14 trigger
+    uint32_t edge;
+    if (Timer_ADC14_Edge(timer - MSP432_Host_Timer_A, &edge) && edge < period)
+    {
+        uint32_t d = Distance(phase, edge, period);
+        if (d < counts) counts = d;
+    }
+
+    // Keep the count register up to date at least once per period
+    if (period < counts) counts = period;
+    return counts;
+}
+
+static uint64_t Timer_Cycles_To_Event(int index)
+{
+    Timer_A_Type *timer = &MSP432_Host_Timer_A[index];
+    uint32_t divider = Timer_Divider(timer);
+    if (divider == 0) return UINT64_MAX;
+
+    uint32_t counts = Timer_Counts_To_Event(timer, &Timer[index]);
+    if (counts == UINT32_MAX) return UINT64_MAX;
+
+    return (uint64_t)counts * divider - Timer[index].accumulated;
+}
+
+static void Timer_Step(int index, uint64_t cycles)
+{
+    Timer_A_Type *timer = &MSP432_Host_Timer_A[index];
+    Timer_State *state = &Timer[index];
+
+    // TACLR resets the count, the clock divider and the count direction
+    if (timer->CTL & 0x0004)
+    {
+        timer->CTL &= ~0x0004;
+        timer->R = 0;
+        state->accumulated = 0;
+        state->counting_down = false;
+    }
+
+    uint32_t divider = Timer_Divider(timer);
+    uint32_t period, phase;
+    if (divider == 0 || !Timer_Phase(timer, state, &period, &phase)) return;
+
+    uint64_t total = state->accumulated + cycles;
+    uint64_t counts = total / divider;
+    state->accumulated = (uint32_t)(total % divider);
+    if (counts == 0) return;
+
+    uint32_t mode = (timer->CTL >> 4) & 0x3;
+    phase = (uint32_t)((phase + counts) % period);
+
+    if (mode == 3)
+    {
+        uint32_t ccr0 = timer->CCR[0];
+        state->counting_down = (phase >= ccr0);
+        timer->R = (phase <= ccr0) ? phase : (2 * ccr0 - phase);
+    }
+    else
+    {
+        timer->R = phase;
+    }
+
+    uint16_t count = timer->R;
+
+    // The count returned to zero
+    if (count == 0) timer->CTL |= 0x0001;
+
+    for (int i = 0; i < 7; i++)
+    {
+        if (timer->CCTL[i] & 0x0100) continue;
+        if (timer->CCR[i] == count) timer->CCTL[i] |= 0x0001;
+    }
+
+    uint32_t edge;
+    if (Timer_ADC14_Edge(index, &edge) && edge == count) ADC14_Trigger();
+}
+
+void MSP432_Host_Timer_Capture(uint8_t timer_number, uint8_t ccr)
+{
+    if (timer_number > 3 || ccr > 6) return;
+
+    Timer_A_Type *timer = &MSP432_Host_Timer_A[timer_number];
+    if ((timer->CCTL[ccr] & 0x0100) == 0) return;
+
+    // Set COV if the previous capture has not been serviced
+    if (timer->CCTL[ccr] & 0x0001) timer->CCTL[ccr] |= 0x0002;
+
+    timer->CCR[ccr] = timer->R;
+    timer->CCTL[ccr] |= 0x0001;
+}
+
+//**************GPIO**************
+
+static void Port_Update(int index)
+{
+    DIO_PORT_Interruptable_Type *port = &MSP432_Host_Port[index];
+    uint8_t dir = port->DIR;
+    uint8_t input = (uint8_t)((dir & port->OUT) |
+                              (~dir & Port_Driven_Mask[index] & Port_Driven_Value[index]) |
+                              (~dir & ~Port_Driven_Mask[index] & port->REN & port->OUT));
+    uint8_t previous = port->IN;
+    *(volatile uint8_t *)&port->IN = input;
+
+    // Only P1 - P6 have interrupt capability
+    if (index < 6)
+    {
+        uint8_t rising = ~previous & input;
+        uint8_t falling = previous & ~input;
+        port->IFG |= (rising & ~port->IES) | (falling & port->IES);
+    }
+}
+
+static void Port_Update_All(void)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        Port_Update(i);
+    }
+}
+
+void MSP432_Host_Set_Port_Input(uint8_t port, uint8_t mask, uint8_t value)
+{
+    if (port < 1 || port > 10) return;
+    Port_Driven_Mask[port - 1] |= mask;
+    Port_Driven_Value[port - 1] = (Port_Driven_Value[port - 1] & ~mask) | (value & mask);
+    Port_Update(port - 1);
+}
+
+void MSP432_Host_Release_Port_Input(uint8_t port, uint8_t mask)
+{
+    if (port < 1 || port > 10) return;
+    Port_Driven_Mask[port - 1] &= ~mask;
+    Port_Update(port - 1);
+}
+
+//**************eUSCI**************
+
+static bool EUSCI_Is_I2C(int index)
+{
+    return (index >= MSP432_HOST_EUSCI_B0) && (((*EUSCI[index].reg.CTLW0 >> 9) & 0x3) == 0x3);
+}
+
+// Number of MCLK cycles needed to shift one character
+static uint64_t EUSCI_Character_Cycles(int index)
+{
+    EUSCI_Registers *reg = &EUSCI[index].reg;
+    uint16_t ctlw0 = *reg->CTLW0;
+    uint32_t source = (((ctlw0 >> 6) & 0x3) == 1) ? Get_ACLK() : Get_SMCLK();
+    uint32_t prescaler = (*reg->BRW == 0) ? 1 : *reg->BRW;
+    uint32_t bits;
+
+    if (EUSCI_Is_I2C(index))
+    {
+        // 8 data bits and the acknowledge bit
+        bits = 9;
+    }
+    else if (ctlw0 & 0x0100)
+    {
+        // SPI
+        bits = 8;
+    }
+    else
+    {
+        // UART: start bit, 7 or 8 data bits, optional parity, 1 or 2 stop bits
+        bits = 1 + ((ctlw0 & 0x1000) ? 7 : 8) + ((ctlw0 & 0x8000) ? 1 : 0) + ((ctlw0 & 0x0800) ? 2 : 1);
+        if (reg->MCTLW && (*reg->MCTLW & 0x0001)) prescaler = prescaler * 16;
+    }
+
+    return (uint64_t)bits * prescaler * MCLK_Per(source);
+}
+
+static const MSP432_Host_I2C_Device *EUSCI_Find_Device(EUSCI_State *state, uint8_t address)
+{
+    for (int i = 0; i < state->num_devices; i++)
+    {
+        if (state->devices[i]->address == address) return state->devices[i];
+    }
+    return 0;
+}
+
+static void I2C_Stop(EUSCI_State *state)
+{
+    if (state->current && state->acknowledged && state->current->Stop) state->current->Stop();
+    state->current = 0;
+    state->i2c_state = I2C_IDLE;
+    *state->reg.CTLW0 &= ~0x0004;
+    *state->reg.STATW &= ~0x0010;
+    *state->reg.IFG |= 0x0008;
+}
+
+static void I2C_Service(EUSCI_State *state, int index)
+{
+    EUSCI_Registers *reg = &state->reg;
+    uint64_t character = EUSCI_Character_Cycles(index);
+
+    // Transmit shift register finished sending a byte
+    if (state->tx_busy && Cycles >= state->tx_done)
+    {
+        state->tx_busy = false;
+        if (state->current && state->acknowledged && state->current->Write) state->current->Write(state->tx_data);
+    }
+
+    // Address phase of a START or repeated START finished
+    if (state->i2c_state == I2C_ADDRESS && Cycles >= state->i2c_done)
+    {
+        *reg->CTLW0 &= ~0x0002;
+        if (!state->acknowledged) *reg->IFG |= 0x0020;
+        if (*reg->CTLW0 & 0x0010)
+        {
+            state->i2c_state = I2C_TRANSMIT;
+        }
+        else
+        {
+            state->i2c_state = I2C_RECEIVE;
+            state->rx_next = Cycles + character;
+        }
+    }
+
+    if (state->i2c_state == I2C_TRANSMIT)
+    {
+        if (*reg->TXBUF != TXBUF_EMPTY && !state->tx_busy)
+        {
+            state->tx_data = (uint8_t)*reg->TXBUF;
+            *reg->TXBUF = TXBUF_EMPTY;
+            state->tx_busy = true;
+            state->tx_done = Cycles + character;
+            *reg->IFG |= 0x0002;
+        }
+        else if (*reg->TXBUF != TXBUF_EMPTY)
+        {
+            *reg->IFG &= ~0x0002;
+        }
+
+        if ((*reg->CTLW0 & 0x0004) && !state->tx_busy && *reg->TXBUF == TXBUF_EMPTY)
+        {
+            I2C_Stop(state);
+        }
+    }
+
+    // New START or repeated START requested once the bus is quiet
+    if ((*reg->CTLW0 & 0x0002) && state->i2c_state != I2C_ADDRESS && !state->tx_busy && *reg->TXBUF == TXBUF_EMPTY)
+    {
+        bool read = (*reg->CTLW0 & 0x0010) == 0;
+        state->current = EUSCI_Find_Device(state, *reg->I2CSA & 0x7F);
+        state->acknowledged = (state->current != 0) && (!state->current->Start || state->current->Start(read));
+        state->i2c_state = I2C_ADDRESS;
+        state->i2c_done = Cycles + character;
+        *reg->STATW |= 0x0010;
+        *reg->IFG |= 0x0004;
+
+        // In transmitter mode TXIFG0 is set with the START so the first byte can be loaded
+        if (!read) *reg->IFG |= 0x0002;
+    }
+
+    // The first byte stays in TXBUF until the address has been acknowledged
+    if (state->i2c_state == I2C_ADDRESS && *reg->TXBUF != TXBUF_EMPTY)
+    {
+        *reg->IFG &= ~0x0002;
+    }
+
+    if (state->i2c_state == I2C_RECEIVE)
+    {
+        if ((*reg->IFG & 0x0001) == 0 && Cycles >= state->rx_next)
+        {
+            bool last = (*reg->CTLW0 & 0x0004) != 0;
+            uint8_t data = 0xFF;
+            if (state->current && state->acknowledged && state->current->Read) data = state->current->Read();
+            *(volatile uint16_t *)reg->RXBUF = data;
+            *reg->IFG |= 0x0001;
+            state->rx_accesses = 0;
+            state->rx_next = Cycles + character;
+            if (last) I2C_Stop(state);
+        }
+    }
+}
+
+static void EUSCI_Service(int index)
+{
+    EUSCI_State *state = &EUSCI[index];
+    EUSCI_Registers *reg = &state->reg;
+
+    // Software reset clears the state machine, the interrupt enables and the flags (except TXIFG)
+    if (*reg->CTLW0 & 0x0001)
+    {
+        state->tx_busy = false;
+        state->i2c_state = I2C_IDLE;
+        state->current = 0;
+        *reg->TXBUF = TXBUF_EMPTY;
+        *reg->STATW &= ~0x0011;
+        *reg->IE &= ~0x000F;
+        *reg->IFG = EUSCI_Is_I2C(index) ? 0x0000 : 0x0002;
+        return;
+    }
+
+    if (EUSCI_Is_I2C(index))
+    {
+        I2C_Service(state, index);
+        return;
+    }
+
+    uint64_t character = EUSCI_Character_Cycles(index);
+    bool spi = (*reg->CTLW0 & 0x0100) != 0;
+
+    // Transmit shift register finished sending a character
+    if (state->tx_busy && Cycles >= state->tx_done)
+    {
+        state->tx_busy = false;
+        if (state->tx_callback) state->tx_callback(state->tx_data);
+
+        // SPI receives one character for every character sent
+        if (spi)
+        {
+            uint8_t data = 0xFF;
+            if (state->rx_head != state->rx_tail)
+            {
+                data = state->rx_queue[state->rx_tail];
+                state->rx_tail = (state->rx_tail + 1) % RX_QUEUE_SIZE;
+            }
+            if (*reg->IFG & 0x0001) *reg->STATW |= 0x0020;  // UCOE
+            *(volatile uint16_t *)reg->RXBUF = data;
+            *reg->IFG |= 0x0001;
+            state->rx_accesses = 0;
+        }
+    }
+
+    // Move the transmit buffer into the shift register
+    if (*reg->TXBUF != TXBUF_EMPTY)
+    {
+        if (!state->tx_busy)
+        {
+            state->tx_data = (uint8_t)*reg->TXBUF;
+            *reg->TXBUF = TXBUF_EMPTY;
+            state->tx_busy = true;
+            state->tx_done = Cycles + character;
+            *reg->IFG |= 0x0002;
+            *reg->IFG &= ~0x0008;
+            *reg->STATW |= 0x0001;
+        }
+        else
+        {
+            *reg->IFG &= ~0x0002;
+        }
+    }
+    else if (!state->tx_busy && (*reg->STATW & 0x0001))
+    {
+        // UCTXCPTIFG: the last character left the shift register
+        *reg->STATW &= ~0x0001;
+        *reg->IFG |= 0x0008;
+    }
+
+    // UART receiver
+    if (!spi && (*reg->IFG & 0x0001) == 0 && state->rx_head != state->rx_tail && Cycles >= state->rx_next)
+    {
+        *(volatile uint16_t *)reg->RXBUF = state->rx_queue[state->rx_tail];
+        state->rx_tail = (state->rx_tail + 1) % RX_QUEUE_SIZE;
+        *reg->IFG |= 0x0001;
+        state->rx_accesses = 0;
+        state->rx_next = Cycles + character;
+    }
+}
+
+static uint64_t EUSCI_Cycles_To_Event(int index)
+{
+    EUSCI_State *state = &EUSCI[index];
+    uint64_t next = UINT64_MAX;
+
+    if (*state->reg.CTLW0 & 0x0001) return next;
+
+    if (state->tx_busy && state->tx_done < next) next = state->tx_done;
+
+    if (EUSCI_Is_I2C(index))
+    {
+        if (state->i2c_state == I2C_ADDRESS && state->i2c_done < next) next = state->i2c_done;
+        if (state->i2c_state == I2C_RECEIVE && (*state->reg.IFG & 0x0001) == 0 && state->rx_next < next) next = state->rx_next;
+    }
+    else if (state->rx_head != state->rx_tail && (*state->reg.IFG & 0x0001) == 0 && state->rx_next < next)
+    {
+        next = state->rx_next;
+    }
+
+    if (next == UINT64_MAX) return next;
+    return (next > Cycles) ? next - Cycles : 1;
+}
+
+void MSP432_Host_Set_EUSCI_TX_Callback(MSP432_Host_EUSCI module, void (*callback)(uint8_t data))
+{
+    EUSCI[module].tx_callback = callback;
+}
+
+void MSP432_Host_EUSCI_Receive(MSP432_Host_EUSCI module, uint8_t data)
+{
+    EUSCI_State *state = &EUSCI[module];
+    uint16_t head = (state->rx_head + 1) % RX_QUEUE_SIZE;
+
+    // Drop the byte if the queue is full, as a real receiver would overrun
+    if (head == state->rx_tail) return;
+
+    state->rx_queue[state->rx_head] = data;
+    state->rx_head = head;
+    EUSCI_Service(module);
+}
+
+bool MSP432_Host_Attach_I2C_Device(MSP432_Host_EUSCI module, const MSP432_Host_I2C_Device *device)
+{
+    EUSCI_State *state = &EUSCI[module];
+    if (module < MSP432_HOST_EUSCI_B0 || state->num_devices >= MAX_I2C_DEVICES) return false;
+    state->devices[state->num_devices++] = device;
+    return true;
+}
+
+//**************ADC14**************
+
+static uint32_t ADC14_Clock(void)
+{
+    uint32_t ctl0 = ADC14_Registers.CTL0;
+    uint32_t source;
+
+    switch((ctl0 >> 19) & 0x7)
+    {
+        case 1:  source = Get_ACLK(); break;
+        case 2:  source = VLO_FREQUENCY; break;
+        case 3:  source = MSP432_Host_Get_MCLK(); break;
+        case 4:  source = Get_SMCLK(); break;
+        case 5:  source = Get_SMCLK(); break;
+        default: source = MODOSC_FREQUENCY; break;
+    }
+
+    static const uint32_t predivider[4] = {1, 4, 32, 64};
+    return source / predivider[(ctl0 >> 30) & 0x3] / (((ctl0 >> 22) & 0x7) + 1);
+}
+
+// Last conversion of the sequence: the channel with ADC14EOS set in sequence modes
+static uint8_t ADC14_Last(void)
+{
+    uint8_t last = (ADC14_Registers.CTL1 >> 16) & 0x1F;
+
+    if (((ADC14_Registers.CTL0 >> 17) & 0x1) == 1)
+    {
+        while (last < 31 && (ADC14_Registers.MCTL[last] & 0x80) == 0)
+        {
+            last++;
+        }
+    }
+    return last;
+}
+
+// Converts the channels from start to last, one after the other
+static void ADC14_Start(uint8_t start, uint8_t last)
+{
+    static const uint32_t sample_clocks[8] = {4, 8, 16, 32, 64, 96, 128, 192};
+    static const uint32_t conversion_clocks[4] = {9, 11, 14, MSP432_HOST_ADC14_CONVERSION_CLOCKS};
+
+    uint32_t ctl0 = ADC14_Registers.CTL0;
+
+    uint32_t clocks = sample_clocks[(ctl0 >> 8) & 0x7] + conversion_clocks[(ADC14_Registers.CTL1 >> 4) & 0x3];
+
+    ADC.busy = true;
+    ADC.next = start;
+    ADC.last = last;
+    ADC.conversion_cycles = (uint64_t)clocks * MCLK_Per(ADC14_Clock());
+    ADC.next_done = Cycles + ADC.conversion_cycles;
+    ADC14_Registers.CTL0 = (ctl0 & ~0x00000001) | 0x00010000;
+}
+
+// Rising edge of the timer output selected by ADC14SHSx. With ADC14MSC cleared, each edge
+// converts the next channel of a sequence; otherwise it converts the whole sequence.
+static void ADC14_Trigger(void)
+{
+    uint32_t ctl0 = ADC14_Registers.CTL0;
+    if ((ctl0 & 0x00000012) != 0x00000012 || ADC.busy) return;
+
+    uint8_t start = (ADC14_Registers.CTL1 >> 16) & 0x1F;
+    uint8_t last = ADC14_Last();
+
+    if (((ctl0 >> 17) & 0x1) == 1 && (ctl0 & 0x00000080) == 0)
+    {
+        uint8_t channel = start + ADC.position;
+        if (channel > last) channel = start;
+
+        // The flags of the sequence are assumed read when a new sequence starts
+        if (channel == start)
+        {
+            for (uint8_t i = start; i <= last; i++)
+            {
+                *(volatile uint32_t *)&ADC14_Registers.IFGR0 &= ~(1u << i);
+            }
+        }
+
+        ADC.position = (channel == last) ? 0 : (channel - start + 1);
+        ADC14_Start(channel, channel);
+    }
+    else
+    {
+        for (uint8_t i = start; i <= last; i++)
+        {
+            *(volatile uint32_t *)&ADC14_Registers.IFGR0 &= ~(1u << i);
+        }
+        ADC14_Start(start, last);
+    }
+}
+
+static void ADC14_Service(void)
+{
+    uint32_t ctl0 = ADC14_Registers.CTL0;
+
+    if ((ctl0 & 0x00000010) == 0)
+    {
+        // ADC14ON is cleared: nothing can be converted
+        ADC.busy = false;
+        ADC14_Registers.CTL0 = ctl0 & ~0x00010001;
+        return;
+    }
+
+    // A sequence converted one trigger at a time restarts at its first channel once ADC14ENC is cleared
+    if ((ctl0 & 0x00000002) == 0) ADC.position = 0;
+
+    // ADC14SC only starts a conversion when it is the sample-and-hold source (ADC14SHSx = 0)
+    if (!ADC.busy && (ctl0 & 0x00000003) == 0x00000003 && (ctl0 & 0x38000000) == 0)
+    {
+        uint8_t start = (ADC14_Registers.CTL1 >> 16) & 0x1F;
+        uint8_t last = ADC14_Last();
+
+        // Reading ADC14MEMx clears its flag; the previous results are assumed read when a new conversion starts
+        for (uint8_t i = start; i <= last; i++)
+        {
+            *(volatile uint32_t *)&ADC14_Registers.IFGR0 &= ~(1u << i);
+        }
+        ADC14_Start(start, last);
+    }
+
+    while (ADC.busy && Cycles >= ADC.next_done)
+    {
+        uint8_t channel = ADC14_Registers.MCTL[ADC.next] & 0x1F;
+        uint16_t sample = ADC14_Callback ? ADC14_Callback(channel) : 0;
+        uint32_t resolution = (ADC14_Registers.CTL1 >> 4) & 0x3;
+
+        // Results are right-aligned at the selected resolution
+        ADC14_Registers.MEM[ADC.next] = (sample & 0x3FFF) >> (6 - 2 * resolution);
+        *(volatile uint32_t *)&ADC14_Registers.IFGR0 |= (1u << ADC.next);
+
+        if (ADC.next == ADC.last)
+        {
+            ADC.busy = false;
+            ADC14_Registers.CTL0 &= ~0x00010000;
+        }
+        else
+        {
+            ADC.next++;
+            ADC.next_done += ADC.conversion_cycles;
+        }
+    }
+}
+
+static uint64_t ADC14_Cycles_To_Event(void)
+{
+    if (!ADC.busy) return UINT64_MAX;
+    return (ADC.next_done > Cycles) ? ADC.next_done - Cycles : 1;
+}
+
+void MSP432_Host_Set_ADC14_Callback(uint16_t (*callback)(uint8_t channel))
+{
+    ADC14_Callback = callback;
+}
+
+//**************DMA**************
+
+// Returns the level of the hardware trigger selected for a channel
+static bool DMA_Trigger_Level(int channel)
+{
+    uint32_t source = DMA_Channel_Registers.CH_SRCCFG[channel] & 0xFF;
+
+    // Sources 1 and 2 are the eUSCI_A and eUSCI_B module of the channel pair:
+    // even channels are triggered by UCTXIFG, odd channels by UCRXIFG
+    if (source == 1 || source == 2)
+    {
+        int index = (channel / 2) + ((source == 2) ? MSP432_HOST_EUSCI_B0 : 0);
+        uint16_t flag = (channel % 2 == 0) ? 0x0002 : 0x0001;
+        return (*EUSCI[index].reg.IFG & flag) != 0;
+    }
+
+    // Source 7 of channel 7 is ADC14: the flag of the last conversion of the sequence
+    if (source == 7 && channel == 7)
+    {
+        return (ADC14_Registers.IFGR0 >> ADC14_Last()) & 0x1;
+    }
+    return false;
+}
+
+// Applies the set/clear semantics of the DMA channel registers
+static void DMA_Sync(void)
+{
+    DMA_Control_Type *control = &DMA_Control_Registers;
+    uint32_t enable = control->ENASET & ~DMA.enabled;
+    uint32_t alternate = control->ALTSET & ~DMA.alternate;
+
+    // Registers are mirrored after every update, so only the bits that changed are new requests.
+    // A new set wins over a clear, as it does when the firmware clears and then sets a bit.
+    DMA.enabled = ((DMA.enabled | control->ENASET) & ~control->ENACLR) | enable;
+    DMA.alternate = ((DMA.alternate | control->ALTSET) & ~control->ALTCLR) | alternate;
+    DMA.flags &= ~DMA_Channel_Registers.INT0_CLRFLG;
+    control->ENASET = DMA.enabled;
+    control->ALTSET = DMA.alternate;
+    control->ENACLR = 0;
+    control->ALTCLR = 0;
+    *(volatile uint32_t *)&DMA_Channel_Registers.INT0_CLRFLG = 0;
+    *(volatile uint32_t *)&DMA_Channel_Registers.INT0_SRCFLG = DMA.flags;
+
+    // A newly enabled channel only transfers on the next edge of its trigger
+    for (int i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (enable & (1u << i)) DMA.level[i] = DMA_Trigger_Level(i);
+    }
+}
+
+// Performs one arbitration cycle of a channel. Returns true if data was moved.
+static bool DMA_Transfer(int channel)
+{
+    DMA_Control_Entry *table = (DMA_Control_Entry *)DMA_Control_Registers.CTLBASE;
+    bool alternate = (DMA.alternate >> channel) & 1;
+    DMA_Control_Entry *entry = &table[channel + (alternate ? NUM_DMA_CHANNELS : 0)];
+    uint32_t control = entry->control;
+    uint32_t mode = control & 0x7;
+
+    if (mode == 0)
+    {
+        // Stop: the channel is disabled and the request is ignored
+        DMA.enabled &= ~(1u << channel);
+        return false;
+    }
+
+    uint32_t size = 1u << ((control >> 28) & 0x3);
+    uint32_t source_increment = (control >> 26) & 0x3;
+    uint32_t destination_increment = (control >> 30) & 0x3;
+    uint32_t remaining = ((control >> 4) & 0x3FF) + 1;
+    uint32_t items = (mode == 2) ? remaining : (1u << ((control >> 14) & 0xF));
+    if (items > remaining) items = remaining;
+
+    for (uint32_t i = 0; i < items; i++, remaining--)
+    {
+        // The end pointers address the last item, so the current item is (remaining - 1) steps before them
+        uint8_t *source = (uint8_t *)entry->source_end - ((source_increment == 3) ? 0 : (remaining - 1) * (1u << source_increment));
+        uint8_t *destination = (uint8_t *)entry->destination_end - ((destination_increment == 3) ? 0 : (remaining - 1) * (1u << destination_increment));
+        uint32_t data = 0;
+
+        memcpy(&data, source, size);
+
+        // Reading ADC14MEMx clears ADC14IFGx
+        if (source >= (uint8_t *)ADC14_Registers.MEM && source < (uint8_t *)(ADC14_Registers.MEM + 32))
+        {
+            *(volatile uint32_t *)&ADC14_Registers.IFGR0 &= ~(1u << ((source - (uint8_t *)ADC14_Registers.MEM) / 4));
+        }
+
+        // A write to TXBUF is an access of the full register, so the empty marker is replaced
+        bool tx_buffer = false;
+        for (int j = 0; j < 8; j++)
+        {
+            if ((volatile uint16_t *)destination == EUSCI[j].reg.TXBUF)
+            {
+                *EUSCI[j].reg.TXBUF = (uint16_t)(data & 0xFF);
+                *EUSCI[j].reg.IFG &= ~0x0002;
+                EUSCI_Service(j);
+                tx_buffer = true;
+            }
+        }
+        if (!tx_buffer) memcpy(destination, &data, size);
+    }
+
+    entry->control = (control & ~0x00003FF0) | (((remaining - 1) & 0x3FF) << 4);
+
+    if (remaining == 0)
+    {
+        // The cycle is complete: ping-pong continues with the other structure, other modes stop
+        entry->control &= ~0x7;
+        if (mode == 3)
+        {
+            DMA.alternate ^= (1u << channel);
+        }
+        else
+        {
+            DMA.enabled &= ~(1u << channel);
+        }
+
+        uint32_t bit = 1u << channel;
+        int irq = -1;
+        if ((DMA_Channel_Registers.INT1_SRCCFG & 0x27) == (0x20 | (uint32_t)channel)) irq = 33;
+        else if ((DMA_Channel_Registers.INT2_SRCCFG & 0x27) == (0x20 | (uint32_t)channel)) irq = 32;
+        else if ((DMA_Channel_Registers.INT3_SRCCFG & 0x27) == (0x20 | (uint32_t)channel)) irq = 31;
+
+        if (irq >= 0)
+        {
+            NVIC_Pending[irq / 32] |= 1u << (irq % 32);
+            MSP432_Host_NVIC.ISPR[irq / 32] = NVIC_Pending[irq / 32];
+        }
+        else
+        {
+            DMA.flags |= bit;
+        }
+    }
+
+    DMA_Control_Registers.ENASET = DMA.enabled;
+    DMA_Control_Registers.ALTSET = DMA.alternate;
+    *(volatile uint32_t *)&DMA_Channel_Registers.INT0_SRCFLG = DMA.flags;
+    return true;
+}
+
+// Serves software requests and trigger edges until no channel has a request left
+static void DMA_Service(void)
+{
+    if ((DMA_Control_Registers.CFG & 0x1) == 0 || DMA_Control_Registers.CTLBASE == 0) return;
+
+    DMA_Sync();
+
+    bool moved = true;
+    while (moved)
+    {
+        uint32_t software = DMA_Channel_Registers.SW_CHTRIG;
+        DMA_Channel_Registers.SW_CHTRIG = 0;
+        moved = false;
+
+        // Lower channel numbers have the higher priority
+        for (int i = 0; i < NUM_DMA_CHANNELS; i++)
+        {
+            uint32_t bit = 1u << i;
+            if ((DMA.enabled & bit) == 0) continue;
+
+            bool level = DMA_Trigger_Level(i);
+            bool request = (software & bit) != 0;
+            if ((DMA_Control_Registers.REQMASKSET & bit) == 0 && level && !DMA.level[i]) request = true;
+            DMA.level[i] = level;
+
+            if (request && DMA_Transfer(i))
+            {
+                // The transfer consumed the trigger, so the next flag is a new edge
+                DMA.level[i] = false;
+                moved = true;
+            }
+        }
+    }
+}
+
+//**************Flash**************
+
+// Information memory: bank 0 sectors 0 - 1 and bank 1 sectors 0 - 1, 4 KB each
+#define INFO_MEMORY_ADDRESS     0x00200000
+#define INFO_SECTOR_SIZE        4096
+#define INFO_SECTORS            4
+
+// Sector erase in progress: sector number and completion time
+static struct
+{
+    bool busy;
+    uint32_t sector;
+    uint64_t end;
+} Flash_Erase;
+
+// Starts and completes sector erases of the information memory. Main memory erases and
+// mass erases are not emulated and complete with an address error.
+static void Flash_Service(void)
+{
+    FLCTL_Type *flctl = &FLCTL_Registers;
+    volatile uint32_t *ifg = (volatile uint32_t *)&flctl->IFG;
+
+    *ifg = (*ifg | flctl->SETIFG) & ~flctl->CLRIFG;
+    flctl->SETIFG = 0;
+    flctl->CLRIFG = 0;
+
+    if (flctl->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_CLR_STAT)
+    {
+        flctl->ERASE_CTLSTAT &= ~(FLCTL_ERASE_CTLSTAT_CLR_STAT | FLCTL_ERASE_CTLSTAT_STATUS_MASK | FLCTL_ERASE_CTLSTAT_ADDR_ERR);
+    }
+
+    if ((flctl->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_START) && !Flash_Erase.busy)
+    {
+        uint32_t offset = flctl->ERASE_SECTADDR - INFO_MEMORY_ADDRESS;
+        uint32_t type = flctl->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_TYPE_MASK;
+
+        flctl->ERASE_CTLSTAT &= ~(FLCTL_ERASE_CTLSTAT_START | FLCTL_ERASE_CTLSTAT_STATUS_MASK | FLCTL_ERASE_CTLSTAT_ADDR_ERR);
+        if ((flctl->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_MODE) || type != FLCTL_ERASE_CTLSTAT_TYPE_1
+            || offset >= INFO_SECTORS * INFO_SECTOR_SIZE)
+        {
+            flctl->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_STATUS_3 | FLCTL_ERASE_CTLSTAT_ADDR_ERR;
+            *ifg |= FLCTL_IFG_ERASE;
+        }
+        else
+        {
+            Flash_Erase.busy = true;
+            Flash_Erase.sector = offset / INFO_SECTOR_SIZE;
+            Flash_Erase.end = Cycles + (uint64_t)MSP432_Host_Get_MCLK() / 1000000 * MSP432_HOST_FLASH_ERASE_US;
+            flctl->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_STATUS_2;
+        }
+    }
+
+    if (Flash_Erase.busy && Cycles >= Flash_Erase.end)
+    {
+        // Write-protected sectors are left unchanged
+        uint32_t sector = Flash_Erase.sector;
+        uint32_t protect = (sector < 2) ? flctl->BANK0_INFO_WEPROT : flctl->BANK1_INFO_WEPROT;
+        if ((protect & (1u << (sector % 2))) == 0)
+        {
+            memset(&MSP432_Host_Info_Memory[sector * INFO_SECTOR_SIZE / 4], 0xFF, INFO_SECTOR_SIZE);
+        }
+
+        Flash_Erase.busy = false;
+        flctl->ERASE_CTLSTAT = (flctl->ERASE_CTLSTAT & ~FLCTL_ERASE_CTLSTAT_STATUS_MASK) | FLCTL_ERASE_CTLSTAT_STATUS_3;
+        *ifg |= FLCTL_IFG_ERASE;
+    }
+}
+
+//**************NVIC**************
+
+// Applies the set/clear semantics of the NVIC enable and pending registers
+static void NVIC_Sync(void)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        NVIC_Enabled[i] = (NVIC_Enabled[i] | MSP432_Host_NVIC.ISER[i]) & ~MSP432_Host_NVIC.ICER[i];
+        NVIC_Pending[i] = (NVIC_Pending[i] | MSP432_Host_NVIC.ISPR[i]) & ~MSP432_Host_NVIC.ICPR[i];
+        MSP432_Host_NVIC.ISER[i] = NVIC_Enabled[i];
+        MSP432_Host_NVIC.ISPR[i] = NVIC_Pending[i];
+        MSP432_Host_NVIC.ICER[i] = 0;
+        MSP432_Host_NVIC.ICPR[i] = 0;
+    }
+}
+
+static bool Timer_Source_Active(Timer_A_Type *timer, bool ccr0)
+{
+    if (ccr0) return (timer->CCTL[0] & 0x0011) == 0x0011;
+
+    if ((timer->CTL & 0x0003) == 0x0003) return true;
+    for (int i = 1; i < 7; i++)
+    {
+        if ((timer->CCTL[i] & 0x0011) == 0x0011) return true;
+    }
+    return false;
+}
+
+// Returns true if the peripheral connected to an IRQ is requesting service
+static bool IRQ_Source_Active(int irq)
+{
+    if (irq >= 8 && irq <= 15)
+    {
+        return Timer_Source_Active(&MSP432_Host_Timer_A[(irq - 8) / 2], (irq % 2) == 0);
+    }
+    if (irq >= 16 && irq <= 23)
+    {
+        EUSCI_Registers *reg = &EUSCI[irq - 16].reg;
+        return (*reg->IFG & *reg->IE) != 0;
+    }
+    if (irq == 24)
+    {
+        return ((ADC14_Registers.IFGR0 & ADC14_Registers.IER0) | (ADC14_Registers.IFGR1 & ADC14_Registers.IER1)) != 0;
+    }
+    if (irq == 34)
+    {
+        DMA_Sync();
+        return DMA.flags != 0;
+    }
+    if (irq >= 35 && irq <= 40)
+    {
+        DIO_PORT_Interruptable_Type *port = &MSP432_Host_Port[irq - 35];
+        return (port->IFG & port->IE) != 0;
+    }
+    return false;
+}
+
+// Finds the highest priority pending exception. Returns -1 for SysTick, -2 if none is pending.
+static int Highest_Pending(int *priority)
+{
+    int best = -2;
+    int best_priority = THREAD_PRIORITY;
+
+    NVIC_Sync();
+
+    if (SysTick_Pending)
+    {
+        best = -1;
+        best_priority = MSP432_Host_SCB.SHP[11] >> 5;
+    }
+
+    for (int irq = 0; irq < NUM_IRQ; irq++)
+    {
+        uint32_t bit = 1u << (irq % 32);
+        if ((NVIC_Enabled[irq / 32] & bit) == 0) continue;
+        if ((NVIC_Pending[irq / 32] & bit) == 0 && !IRQ_Source_Active(irq)) continue;
+
+        int irq_priority = MSP432_Host_NVIC.IP[irq] >> 5;
+        if (irq_priority < best_priority)
+        {
+            best = irq;
+            best_priority = irq_priority;
+        }
+    }
+
+    *priority = best_priority;
+    return best;
+}
+
+static void Take_Interrupts(void)
+{
+    while (Primask == 0)
+    {
+        int priority;
+        int exception = Highest_Pending(&priority);
+        if (exception == -2 || priority >= Active_Priority) return;
+
+        void (*handler)(void);
+        int rx_module = -1;
+
+        if (exception == -1)
+        {
+            SysTick_Pending = false;
+            handler = SysTick_Handler;
+        }
+        else
+        {
+            NVIC_Pending[exception / 32] &= ~(1u << (exception % 32));
+            MSP432_Host_NVIC.ISPR[exception / 32] = NVIC_Pending[exception / 32];
+            handler = IRQ_Handler[exception];
+            if (exception >= 16 && exception <= 23 && (*EUSCI[exception - 16].reg.IFG & 0x0001)) rx_module = exception - 16;
+        }
+
+        if (handler == 0)
+        {
+            // Default_Handler spins forever on the LaunchPad
+            fprintf(stderr, "MSP432_Host: unhandled exception %d at cycle %llu\n", exception, (unsigned long long)Cycles);
+            abort();
+        }
+
+        int saved_priority = Active_Priority;
+        Active_Priority = priority;
+        handler();
+        Active_Priority = saved_priority;
+
+        // The handler is assumed to have read RXBUF
+        if (rx_module >= 0)
+        {
+            *EUSCI[rx_module].reg.IFG &= ~0x0001;
+            EUSCI_Service(rx_module);
+        }
+    }
+}
+
+//**************Virtual clock**************
+
+static uint64_t Cycles_To_Event(void)
+{
+    uint64_t next = SysTick_Cycles_To_Event();
+
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t cycles = Timer_Cycles_To_Event(i);
+        if (cycles < next) next = cycles;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t cycles = EUSCI_Cycles_To_Event(i);
+        if (cycles < next) next = cycles;
+    }
+
+    uint64_t cycles = ADC14_Cycles_To_Event();
+    if (cycles < next) next = cycles;
+
+    return (next == 0) ? 1 : next;
+}
+
+static void Step(uint64_t cycles)
+{
+    Cycles = Cycles + cycles;
+
+    // DWT cycle counter
+    if ((MSP432_Host_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (MSP432_Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        MSP432_Host_DWT.CYCCNT = MSP432_Host_DWT.CYCCNT + (uint32_t)cycles;
+    }
+
+    SysTick_Step(cycles);
+    for (int i = 0; i < 4; i++)
+    {
+        Timer_Step(i, cycles);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        EUSCI_Service(i);
+    }
+
+    // Conversions that completed in this step are visible to the DMA triggers
+    ADC14_Service();
+    DMA_Service();
+
+    if (Tick_Callback) Tick_Callback(Cycles);
+    Port_Update_All();
+
+    if (Budget_Active && Cycles >= Budget_End) longjmp(Budget_Jump, 1);
+}
+
+// Serves the register writes made since the last access, e.g. a START condition or a DMA request
+static void Service_Requests(void)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        EUSCI_Service(i);
+    }
+    DMA_Service();
+}
+
+void MSP432_Host_Advance(uint64_t cycles)
+{
+    uint64_t until = Cycles + cycles;
+
+    while (Cycles < until)
+    {
+        Service_Requests();
+
+        uint64_t step = until - Cycles;
+        uint64_t next = Cycles_To_Event();
+        if (next < step) step = next;
+        if (Budget_Active && Budget_End - Cycles < step) step = Budget_End - Cycles;
+
+        Step(step);
+        Take_Interrupts();
+    }
+}
+
+void MSP432_Host_Wait_For_Interrupt(void)
+{
+    int priority;
+
+    // Requests written just before WFI are served first
+    Service_Requests();
+    int exception = Highest_Pending(&priority);
+
+    // WFI returns immediately if an interrupt is already pending
+    if (exception != -2 && priority < Active_Priority)
+    {
+        Take_Interrupts();
+        return;
+    }
+
+    uint64_t next = Cycles_To_Event();
+    if (next == UINT64_MAX)
+    {
+        if (!Budget_Active)
+        {
+            fprintf(stderr, "MSP432_Host: WFI with no event scheduled at cycle %llu\n", (unsigned long long)Cycles);
+            abort();
+        }
+        next = Budget_End - Cycles;
+    }
+    MSP432_Host_Advance(next);
+}
+
+uint64_t MSP432_Host_Get_Cycles(void)
+{
+    return Cycles;
+}
+
+void MSP432_Host_Set_Tick_Callback(void (*callback)(uint64_t cycles))
+{
+    Tick_Callback = callback;
+}
+
+int MSP432_Host_Run(int (*firmware_main)(void), uint64_t cycles)
+{
+    Budget_End = Cycles + cycles;
+    Budget_Active = true;
+
+    if (setjmp(Budget_Jump))
+    {
+        Budget_Active = false;
+        Active_Priority = THREAD_PRIORITY;
+        return 1;
+    }
+
+    firmware_main();
+    Budget_Active = false;
+    return 0;
+}
+
+//**************Register accessors**************
+
+EUSCI_A_Type *MSP432_Host_EUSCI_A(uint8_t module)
+{
+    MSP432_Host_Advance(MSP432_HOST_REGISTER_ACCESS_CYCLES);
+
+    EUSCI_State *state = &EUSCI[module];
+    if ((*state->reg.IFG & 0x0001) && ++state->rx_accesses >= RX_READ_ACCESSES)
+    {
+        *state->reg.IFG &= ~0x0001;
+    }
+    EUSCI_Service(module);
+
+    return &EUSCI_A_Registers[module];
+}
+
+EUSCI_B_Type *MSP432_Host_EUSCI_B(uint8_t module)
+{
+    MSP432_Host_Advance(MSP432_HOST_REGISTER_ACCESS_CYCLES);
+
+    EUSCI_State *state = &EUSCI[MSP432_HOST_EUSCI_B0 + module];
+    if ((*state->reg.IFG & 0x0001) && ++state->rx_accesses >= RX_READ_ACCESSES)
+    {
+        *state->reg.IFG &= ~0x0001;
+    }
+    EUSCI_Service(MSP432_HOST_EUSCI_B0 + module);
+
+    return &EUSCI_B_Registers[module];
+}
+
+DMA_Channel_Type *MSP432_Host_DMA_Channel(void)
+{
+    DMA_Service();
+    return &DMA_Channel_Registers;
+}
+
+DMA_Control_Type *MSP432_Host_DMA_Control(void)
+{
+    DMA_Service();
+    return &DMA_Control_Registers;
+}
+
+NVIC_Type *MSP432_Host_NVIC_Registers(void)
+{
+    // Enable and pending bits are write-1-to-set: earlier writes are applied before the next one
+    NVIC_Sync();
+    return &MSP432_Host_NVIC;
+}
+
+ADC14_Type *MSP432_Host_ADC14(void)
+{
+    MSP432_Host_Advance(MSP432_HOST_REGISTER_ACCESS_CYCLES);
+    ADC14_Service();
+    return &ADC14_Registers;
+}
+
+FLCTL_Type *MSP432_Host_FLCTL_Registers(void)
+{
+    MSP432_Host_Advance(MSP432_HOST_REGISTER_ACCESS_CYCLES);
+    Flash_Service();
+    return &FLCTL_Registers;
+}
+
+//**************Reset**************
+
+void MSP432_Host_Reset(void)
+{
+    memset(MSP432_Host_Port, 0, sizeof(MSP432_Host_Port));
+    memset(&MSP432_Host_PortJ, 0, sizeof(MSP432_Host_PortJ));
+    memset(MSP432_Host_Timer_A, 0, sizeof(MSP432_Host_Timer_A));
+    memset(&MSP432_Host_PCM, 0, sizeof(MSP432_Host_PCM));
+    memset(&MSP432_Host_CS, 0, sizeof(MSP432_Host_CS));
+    memset(&FLCTL_Registers, 0, sizeof(FLCTL_Registers));
+    memset(&Flash_Erase, 0, sizeof(Flash_Erase));
+    memset(&MSP432_Host_SysTick, 0, sizeof(MSP432_Host_SysTick));
+    memset(&MSP432_Host_NVIC, 0, sizeof(MSP432_Host_NVIC));
+    memset(&MSP432_Host_SCB, 0, sizeof(MSP432_Host_SCB));
+    memset(&MSP432_Host_DWT, 0, sizeof(MSP432_Host_DWT));
+    memset(&MSP432_Host_CoreDebug, 0, sizeof(MSP432_Host_CoreDebug));
+    memset(EUSCI_A_Registers, 0, sizeof(EUSCI_A_Registers));
+    memset(EUSCI_B_Registers, 0, sizeof(EUSCI_B_Registers));
+    memset(&ADC14_Registers, 0, sizeof(ADC14_Registers));
+    memset(Timer, 0, sizeof(Timer));
+    memset(&ADC, 0, sizeof(ADC));
+    memset(&DMA_Channel_Registers, 0, sizeof(DMA_Channel_Registers));
+    memset(&DMA_Control_Registers, 0, sizeof(DMA_Control_Registers));
+    memset(&DMA, 0, sizeof(DMA));
+    memset(NVIC_Enabled, 0, sizeof(NVIC_Enabled));
+    memset(NVIC_Pending, 0, sizeof(NVIC_Pending));
+
+    // The power mode transition requested by Clock_Init48MHz() completes immediately
+    MSP432_Host_PCM.CTL0 = 0x00000100;
+
+    // MCLK, HSMCLK and SMCLK are sourced from the 3 MHz DCO out of reset
+    MSP432_Host_CS.CTL1 = 0x00000033;
+
+    // Every flash sector is write-protected out of reset
+    FLCTL_Registers.BANK0_INFO_WEPROT = 0x00000003;
+    FLCTL_Registers.BANK1_INFO_WEPROT = 0x00000003;
+    FLCTL_Registers.BANK0_MAIN_WEPROT = 0xFFFFFFFF;
+    FLCTL_Registers.BANK1_MAIN_WEPROT = 0xFFFFFFFF;
+
+    for (int i = 0; i < 8; i++)
+    {
+        EUSCI_State *state = &EUSCI[i];
+        EUSCI_Registers *reg = &state->reg;
+
+        if (i < MSP432_HOST_EUSCI_B0)
+        {
+            EUSCI_A_Type *a = &EUSCI_A_Registers[i];
+            *reg = (EUSCI_Registers){&a->CTLW0, &a->BRW, &a->MCTLW, &a->STATW, (volatile uint16_t *)&a->RXBUF, &a->TXBUF, &a->IE, &a->IFG, 0};
+            a->CTLW0 = 0x0001;
+        }
+        else
+        {
+            EUSCI_B_Type *b = &EUSCI_B_Registers[i - MSP432_HOST_EUSCI_B0];
+            *reg = (EUSCI_Registers){&b->CTLW0, &b->BRW, 0, &b->STATW, (volatile uint16_t *)&b->RXBUF, &b->TXBUF, &b->IE, &b->IFG, &b->I2CSA};
+            b->CTLW0 = 0x01C1;
+        }
+
+        *reg->TXBUF = TXBUF_EMPTY;
+        *reg->IFG = 0x0002;
+        state->tx_busy = false;
+        state->rx_head = 0;
+        state->rx_tail = 0;
+        state->rx_next = 0;
+        state->rx_accesses = 0;
+        state->current = 0;
+        state->i2c_state = I2C_IDLE;
+    }
+
+    Cycles = 0;
+    Primask = 0;
+    Active_Priority = THREAD_PRIORITY;
+    SysTick_Pending = false;
+    Budget_Active = false;
+    Port_Update_All();
+}
+
+// The register blocks are reset before main() so that firmware can run without calling MSP432_Host_Reset()
+__attribute__((constructor)) static void MSP432_Host_Power_On(void)
+{
+    // The information memory starts erased
+    memset(MSP432_Host_Info_Memory, 0xFF, sizeof(MSP432_Host_Info_Memory));
+    MSP432_Host_Reset();
+}
+
+//**************CortexM.c host implementation**************
+
+void DisableInterrupts(void)
+{
+    Primask = 1;
+}
+
+void EnableInterrupts(void)
+{
+    Primask = 0;
+    Take_Interrupts();
+}
+
+long StartCritical(void)
+{
+    long previous = Primask;
+    Primask = 1;
+    return previous;
+}
+
+void EndCritical(long sr)
+{
+    Primask = (uint32_t)sr;
+    if (Primask == 0) Take_Interrupts();
+}
+
+void WaitForInterrupt(void)
+{
+    MSP432_Host_Wait_For_Interrupt();
+}
@@ -0,0 +1,235 @@
+/**
+ * @file MSP432_Host.h
+ * @brief Header file for the MSP432_Host peripheral emulator.
+ *
+ * This file contains the function definitions for the MSP432_Host emulator, which backs the
+ * registers declared in host/msp.h and lets the firmware in software/ run on a Linux workstation.
+ *
+ * Time is kept by a virtual 64-bit MCLK cycle counter. The counter only moves when the firmware
+ * waits (Clock_Delay1us, Clock_Delay1ms, WaitForInterrupt), when it polls an EUSCI or ADC14
+ * register, or when the test harness calls MSP432_Host_Advance(). While the counter moves,
+ * SysTick, Timer_A, eUSCI and ADC14 events are generated at the cycle they would occur on the
+ * LaunchPad, and the matching handlers (SysTick_Handler, TA1_0_IRQHandler, PORT4_IRQHandler, ...)
+ * are called according to their NVIC priority, enable bit and the PRIMASK state.
+ *
+ * host/Makefile builds the line follower with every driver in software/ except the startup and
+ * system files, which are not part of the host build:
+ *
+ *  make -C host line_follower_harness     builds the firmware and host/Line_Follower_Harness.c
+ *  make -C host test                      runs the test programs
+ *
+ * Final_Project_main.c is compiled with -Dmain=Firmware_Main. The harness provides main(),
+ * installs the sensor models with the functions below and calls
+ * MSP432_Host_Run(&Firmware_Main, cycles).
+ *
+ * -fcommon is needed because some headers in inc/ define the task pointers they share.
+ *
+ * @note Handlers are bound at link time through weak references, so a handler that is not
+ * linked into the host program is treated like an unused entry of the vector table.
+ *
+ * @note Reading RXBUF on the hardware clears the receive flag. Plain memory cannot observe
+ * reads, so the emulator clears the receive flag when the eUSCI handler returns or, for
+ * busy-wait receivers, two register accesses after the flag was first observed.
+ *
+ * @note DMA transfers take no time on the virtual clock. A write to a DMA register (ENASET,
+ * SW_CHTRIG, ...) takes effect at the next DMA register access, WFI or clock update.
+ * Writes to the eUSCI registers (a START condition, TXBUF, ...) take effect the same way.
+ *
+ */
+
+#ifndef MSP432_HOST_H_
+#define MSP432_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "msp.h"
+
+// Number of MCLK cycles charged for every access to an EUSCI, ADC14 or FLCTL register
+#define MSP432_HOST_REGISTER_ACCESS_CYCLES  4
+
+// Number of ADC14CLK cycles needed to convert one channel with 14-bit resolution
+#define MSP432_HOST_ADC14_CONVERSION_CLOCKS 16
+
+// Duration of a flash sector erase in microseconds. Word programming is not timed.
+#define MSP432_HOST_FLASH_ERASE_US          10000
+
+/**
+ * @brief Identifies the eUSCI modules of the MSP432P401R.
+ */
+typedef enum
+{
+    MSP432_HOST_EUSCI_A0 = 0,
+    MSP432_HOST_EUSCI_A1 = 1,
+    MSP432_HOST_EUSCI_A2 = 2,
+    MSP432_HOST_EUSCI_A3 = 3,
+    MSP432_HOST_EUSCI_B0 = 4,
+    MSP432_HOST_EUSCI_B1 = 5,
+    MSP432_HOST_EUSCI_B2 = 6,
+    MSP432_HOST_EUSCI_B3 = 7
+} MSP432_Host_EUSCI;
+
+/**
+ * @brief Model of an I2C slave attached to an eUSCI_B module.
+ *
+ * Start is called for every START or repeated START addressed to the device and returns true
+ * if the device acknowledges. Write receives each byte sent by the master, Read supplies each
+ * byte requested by the master and Stop is called on the STOP condition. Unused callbacks may be null.
+ */
+typedef struct
+{
+    uint8_t address;
+    bool (*Start)(bool read);
+    void (*Write)(uint8_t data);
+    uint8_t (*Read)(void);
+    void (*Stop)(void);
+} MSP432_Host_I2C_Device;
+
+/**
+ * @brief Restores every emulated register to its reset value and clears the virtual clock.
+ *
+ * Callbacks and attached I2C devices are kept.
+ *
+ * @return None
+ */
+void MSP432_Host_Reset(void);
+
+/**
+ * @brief Runs the firmware entry point on the virtual clock for a fixed number of MCLK cycles.
+ *
+ * The entry point is normally the firmware's main() renamed with -Dmain=Firmware_Main. Control
+ * returns to the caller once the virtual clock has advanced by the given number of cycles,
+ * even if the firmware never returns from its main loop.
+ *
+ * @param firmware_main The firmware entry point.
+ * @param cycles        The number of MCLK cycles to run.
+ *
+ * @return 1 if the cycle budget was used up, or 0 if the entry point returned first.
+ */
+int MSP432_Host_Run(int (*firmware_main)(void), uint64_t cycles);
+
+/**
+ * @brief Advances the virtual clock and services every emulated peripheral on the way.
+ *
+ * Pending interrupts whose priority is higher than the currently running handler are taken
+ * at the exact cycle they are raised.
+ *
+ * @param cycles The number of MCLK cycles to advance.
+ *
+ * @return None
+ */
+void MSP432_Host_Advance(uint64_t cycles);
+
+/**
+ * @brief Advances the virtual clock to the next peripheral event and takes any pending interrupt.
+ *
+ * This is the host implementation of the WFI instruction.
+ *
+ * @return None
+ */
+void MSP432_Host_Wait_For_Interrupt(void);
+
+/**
+ * @brief Returns the number of MCLK cycles elapsed since MSP432_Host_Reset().
+ *
+ * @return The virtual cycle counter.
+ */
+uint64_t MSP432_Host_Get_Cycles(void);
+
+/**
+ * @brief Returns the current MCLK frequency selected through the CS registers.
+ *
+ * @return 48000000 after Clock_Init48MHz(), otherwise 3000000.
+ */
+uint32_t MSP432_Host_Get_MCLK(void);
+
+/**
+ * @brief Registers a function that is called every time the virtual clock moves.
+ *
+ * The callback receives the current cycle count and is the place to update sensor models,
+ * e.g. the decay of the QTRX reflectance outputs or the bumper switches.
+ *
+ * @param callback The function to call, or null to remove it.
+ *
+ * @return None
+ */
+void MSP432_Host_Set_Tick_Callback(void (*callback)(uint64_t cycles));
+
+/**
+ * @brief Drives the pins of a port from outside the MCU.
+ *
+ * Pins in the mask are driven to the matching bit of the value. Input pins that are not driven
+ * read their pull resistor (REN and OUT) or 0. Edges on P1 - P6 set IFG according to IES.
+ *
+ * @param port  The port number, 1 to 10.
+ * @param mask  The pins driven by the caller.
+ * @param value The level of the driven pins.
+ *
+ * @return None
+ */
+void MSP432_Host_Set_Port_Input(uint8_t port, uint8_t mask, uint8_t value);
+
+/**
+ * @brief Releases pins that were driven with MSP432_Host_Set_Port_Input().
+ *
+ * @param port The port number, 1 to 10.
+ * @param mask The pins to release.
+ *
+ * @return None
+ */
+void MSP432_Host_Release_Port_Input(uint8_t port, uint8_t mask);
+
+/**
+ * @brief Triggers a capture event on a Timer_A capture/compare channel.
+ *
+ * The current timer count is latched into CCR[ccr] and CCIFG is set (COV if it was already set).
+ * Channels that are not in capture mode are ignored.
+ *
+ * @param timer The timer number, 0 to 3.
+ * @param ccr   The capture/compare channel, 0 to 6.
+ *
+ * @return None
+ */
+void MSP432_Host_Timer_Capture(uint8_t timer, uint8_t ccr);
+
+/**
+ * @brief Registers the function that supplies ADC14 samples.
+ *
+ * @param callback Function that returns the 14-bit result for an input channel (0 to 31).
+ *
+ * @return None
+ */
+void MSP432_Host_Set_ADC14_Callback(uint16_t (*callback)(uint8_t channel));
+
+/**
+ * @brief Registers a function that receives every byte transmitted by an eUSCI module in UART or SPI mode.
+ *
+ * @param module   The eUSCI module.
+ * @param callback The function to call at the end of each transmitted byte, or null to discard the data.
+ *
+ * @return None
+ */
+void MSP432_Host_Set_EUSCI_TX_Callback(MSP432_Host_EUSCI module, void (*callback)(uint8_t data));
+
+/**
+ * @brief Queues a byte to be received by an eUSCI module in UART or SPI mode.
+ *
+ * Queued bytes arrive one character time apart.
+ *
+ * @param module The eUSCI module.
+ * @param data   The byte to receive.
+ *
+ * @return None
+ */
+void MSP432_Host_EUSCI_Receive(MSP432_Host_EUSCI module, uint8_t data);
+
+/**
+ * @brief Attaches an I2C slave model to an eUSCI_B module.
+ *
+ * @param module The eUSCI_B module.
+ * @param device The slave model. It must stay valid while attached.
+ *
+ * @return true if the device was attached, false if the bus already has the maximum number of devices.
+ */
+bool MSP432_Host_Attach_I2C_Device(MSP432_Host_EUSCI module, const MSP432_Host_I2C_Device *device);
+
+#endif /* MSP432_HOST_H_ */
@@ -0,0 +1,197 @@
+/**
+ * @file PID_Benchmark.c
+ * @brief Host test that compares the fixed-point PID module with the double pidController() it replaced.
+ *
+ * Usage:
+ *
+ *  pid_benchmark [calls]
+ *
+ * The test feeds the same pseudo-random sequence of line positions, spread over the range of
+ * Reflectance_Sensor_Position(), to PID_Update() and to a copy of the original double pidController()
+ * from Final_Project_main.c, and checks that:
+ *  - With wide limits, the outputs match to within the rounding of PID_Update().
+ *  - With the limits used by the line follower and no integral gain, the output of PID_Update()
+ *    is the saturated output of pidController().
+ *  - Limits above the 16-bit range are reached without wrapping around.
+ *
+ * It then times both controllers and prints the cost of one call in nanoseconds. On the host
+ * both run in hardware; on the Cortex-M4F the double version calls the run-time support
+ * floating-point library, which is the cost PID_Update() removes.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../inc/PID.h"
+
+// Default number of calls timed for each controller
+#define BENCHMARK_CALLS     50000000
+
+// Number of updates in each equivalence check
+#define CHECK_UPDATES       100000
+
+// Gains of the line follower, plus a non-zero integral gain for the wide-limit check.
+// They are exact in Q16.16, so the two controllers differ only by the output rounding.
+#define KP                  20.0
+#define KI                  0.25
+#define KD                  1.0
+
+// Line positions in 0.1mm across the sensor array, including the value reported when no sensor is active
+static const int32_t Positions[] = {-334, -286, -238, -190, -142, -95, -48, 0, 48, 95, 142, 190, 238, 286, 334, 335};
+#define NUM_POSITIONS       (sizeof(Positions) / sizeof(Positions[0]))
+
+// State of the original double controller
+static double desired = 0;
+static double integral = 0;
+static double previous = 0;
+static double Kp = KP;
+static double Ki = KI;
+static double Kd = KD;
+
+// Copy of pidController() from Final_Project_main.c before the fixed-point module
+static double pidController(double actual)
+{
+    double error = desired - actual;
+    double proportional = Kp * error;
+    integral += Ki * error;
+    double derivative = Kd * (error - previous);
+    double PID = proportional + integral + derivative;
+    previous = error;
+    return PID;
+}
+
+static void Reference_Reset(double ki)
+{
+    integral = 0;
+    previous = 0;
+    Ki = ki;
+}
+
+// Returns a pseudo-random line position (fixed seed, so every run uses the same sequence)
+static int32_t Next_Position(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return Positions[(*seed >> 16) % NUM_POSITIONS];
+}
+
+static double Clamp(double value, double min, double max)
+{
+    if (value < min) return min;
+    if (value > max) return max;
+    return value;
+}
+
+// Runs both controllers on the same positions and returns the number of mismatches
+static int Check(const char *name, double ki, int32_t output_min, int32_t output_max)
+{
+    PID_Controller pid;
+    uint32_t seed = 1;
+    int failures = 0;
+
+    PID_Init(&pid, PID_Q16(KP), PID_Q16(ki), PID_Q16(KD), output_min, output_max);
+    Reference_Reset(ki);
+
+    // Both controllers start from a measurement of 0, so neither has a derivative kick
+    for (int i = 0; i < CHECK_UPDATES; i++)
+    {
+        int32_t position = (i == 0) ? 0 : Next_Position(&seed);
+        int32_t output = PID_Update(&pid, 0, position);
+        double expected = Clamp(pidController(position), output_min, output_max);
+
+        if (fabs(output - expected) > 0.5)
+        {
+            if (failures < 10) printf("%s: update %d, position %d: PID_Update %d, pidController %.2f\n", name, i, position, output, expected);
+            failures++;
+        }
+    }
+
+    printf("%-24s %s\n", name, failures ? "FAIL" : "ok");
+    return failures;
+}
+
+// Checks that outputs beyond +/-32767 saturate instead of wrapping around
+static int Check_Large_Limits(void)
+{
+    PID_Controller integral_pid;
+    PID_Controller derivative_pid;
+    int failures = 0;
+
+    // Only the integral (100 per unit of error) or only the derivative (1000 per unit of change) is active
+    PID_Init(&integral_pid, 0, PID_Q16(100.0), 0, -1000000, 1000000);
+    PID_Init(&derivative_pid, 0, 0, PID_Q16(1000.0), -1000000, 1000000);
+    PID_Update(&derivative_pid, 0, 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        int32_t measurement = (i & 1) ? 0 : -334;
+        int32_t output[2] = {PID_Update(&integral_pid, 0, -334), PID_Update(&derivative_pid, 0, measurement)};
+        int32_t expected[2] = {(int32_t)Clamp(33400.0 * (i + 1), -1000000, 1000000), (i & 1) ? -334000 : 334000};
+
+        for (int j = 0; j < 2; j++)
+        {
+            if (output[j] != expected[j])
+            {
+                if (failures < 10) printf("large limits: %s update %d: PID_Update %d, expected %d\n",
+                                          j ? "derivative" : "integral", i, output[j], expected[j]);
+                failures++;
+            }
+        }
+    }
+
+    printf("%-24s %s\n", "large limits", failures ? "FAIL" : "ok");
+    return failures;
+}
+
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    long calls = (argc > 1) ? atol(argv[1]) : BENCHMARK_CALLS;
+    int failures = 0;
+
+    failures += Check("wide limits", KI, -1000000000, 1000000000);
+    failures += Check("line follower limits", 0.0, -3000, 3000);
+    failures += Check_Large_Limits();
+
+    // Precompute the inputs so that both loops time only the controller
+    int32_t inputs[1024];
+    uint32_t seed = 1;
+    for (int i = 0; i < 1024; i++) inputs[i] = Next_Position(&seed);
+
+    PID_Controller pid;
+    PID_Init(&pid, PID_Q16(KP), 0, PID_Q16(KD), -3000, 3000);
+    Reference_Reset(0.0);
+
+    volatile double double_sink;
+    double start = Now();
+    for (long i = 0; i < calls; i++) double_sink = pidController(inputs[i & 1023]);
+    double double_time = Now() - start;
+
+    volatile int32_t fixed_sink;
+    start = Now();
+    for (long i = 0; i < calls; i++) fixed_sink = PID_Update(&pid, 0, inputs[i & 1023]);
+    double fixed_time = Now() - start;
+
+    (void)double_sink;
+    (void)fixed_sink;
+    printf("pidController (double):  %.2f ns/call\n", double_time * 1e9 / calls);
+    printf("PID_Update (Q16.16):     %.2f ns/call\n", fixed_time * 1e9 / calls);
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file Reflectance_Grayscale_Test.c
+ * @brief Host test for the grayscale reflectance read on the MSP432_Host emulator.
+ *
+ * Usage:
+ *
+ *  reflectance_grayscale_test
+ *
+ * The QTRX outputs on P7 are modeled from the tick callback: each output stays high for its
+ * own decay time after the firmware turns P7 back into inputs. The test checks that:
+ *  - Reflectance_Sensor_Read_Grayscale() reports each decay time rounded up to the next snapshot,
+ *    and max_time for the outputs that have not decayed.
+ *  - A max_time of 65535 us is reported as is, even when it is not a multiple of the step
+ *    and an output decays during the last step.
+ *  - A step of 0 is read as 1 us, so the read still ends after max_time.
+ *  - With the line moving from sensor 3 to sensor 4, Reflectance_Sensor_Grayscale_Position()
+ *    decreases at every step.
+ *
+ * The program exits with status 1 if a check fails.
+ *
+ */
+
+#include <stdio.h>
+#include "MSP432_Host.h"
+#include "../inc/Reflectance_Sensor.h"
+
+// Decay time of an output that never goes low during the test
+#define NO_DECAY_US     1000000
+
+// Decay time of each QTRX output in us, ordered like Weight[] (index 0 is P7.0)
+static uint32_t Decay_Us[8];
+
+static uint64_t Last_Cycles = 0;
+static uint64_t Release_Cycles = 0;
+static int Charged = 0;
+
+// Drives the QTRX outputs every time the virtual clock moves
+static void Tick(uint64_t cycles)
+{
+    // The decay starts when the firmware turns P7 back into inputs. The change is seen on the
+    // tick after the write, so the decay is timed from the previous tick.
+    if (P7->DIR != 0)
+    {
+        Charged = 1;
+    }
+    else if (Charged)
+    {
+        Charged = 0;
+        Release_Cycles = Last_Cycles;
+    }
+
+    uint8_t high = 0;
+    uint64_t elapsed_us = (cycles - Release_Cycles) / (MSP432_Host_Get_MCLK() / 1000000);
+    for (int i = 0; i < 8; i++)
+    {
+        if (elapsed_us < Decay_Us[i]) high |= 1 << i;
+    }
+    MSP432_Host_Set_Port_Input(7, 0xFF, high);
+
+    Last_Cycles = cycles;
+}
+
+// Reads the sensors with the given step and max_time and compares the result with the model
+static int Check_Decay_Times(const char *name, uint16_t step, uint16_t max_time)
+{
+    uint16_t decay_time[8];
+    uint8_t expected_active = 0;
+    int failures = 0;
+
+    uint8_t active = Reflectance_Sensor_Read_Grayscale(decay_time, step, max_time);
+
+    for (int i = 0; i < 8; i++)
+    {
+        // The first snapshot after the decay, or max_time (a step of 0 is read as 1)
+        uint32_t resolution = (step == 0) ? 1 : step;
+        uint32_t expected = ((Decay_Us[i] + resolution - 1) / resolution) * resolution;
+        if (expected >= max_time)
+        {
+            expected = max_time;
+            if (Decay_Us[i] > max_time) expected_active |= 1 << i;
+        }
+
+        if (decay_time[i] != expected)
+        {
+            printf("%s: sensor %d decays after %u us: decay_time %u, expected %u\n", name, i, Decay_Us[i], decay_time[i], expected);
+            failures++;
+        }
+    }
+
+    if (active != expected_active)
+    {
+        printf("%s: returned 0x%02X, expected 0x%02X\n", name, active, expected_active);
+        failures++;
+    }
+
+    printf("%-24s %s\n", name, failures ? "FAIL" : "ok");
+    return failures;
+}
+
+// Moves a line from sensor 3 to sensor 4 and checks that the grayscale position follows it
+static int Check_Position_Sweep(void)
+{
+    int failures = 0;
+    int32_t previous = 0;
+
+    for (int i = 0; i <= 6; i++)
+    {
+        uint16_t decay_time[8];
+
+        // White surface everywhere, darker under sensor 3 at the start and under sensor 4 at the end
+        for (int j = 0; j < 8; j++) Decay_Us[j] = 200;
+        Decay_Us[3] = 200 + 1000 * (6 - i) / 6;
+        Decay_Us[4] = 200 + 1000 * i / 6;
+
+        Reflectance_Sensor_Read_Grayscale(decay_time, 20, 1000);
+        int32_t position = Reflectance_Sensor_Grayscale_Position(decay_time, 200);
+
+        if (i > 0 && position >= previous)
+        {
+            printf("position sweep: step %d: position %d, previous %d\n", i, position, previous);
+            failures++;
+        }
+        previous = position;
+    }
+
+    printf("%-24s %s\n", "position sweep", failures ? "FAIL" : "ok");
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    MSP432_Host_Reset();
+    MSP432_Host_Set_Tick_Callback(&Tick);
+    Reflectance_Sensor_Init();
+
+    const uint32_t decays[8] = {100, 250, 400, 1000, 1500, 2000, 3000, NO_DECAY_US};
+    for (int i = 0; i < 8; i++) Decay_Us[i] = decays[i];
+    failures += Check_Decay_Times("step 50, max 2500", 50, 2500);
+    failures += Check_Decay_Times("step 70, max 2500", 70, 2500);
+
+    // 65535 is not a multiple of 1000, so the last snapshot is shortened. Sensor 1 decays
+    // between the last two snapshots.
+    for (int i = 0; i < 8; i++) Decay_Us[i] = NO_DECAY_US;
+    Decay_Us[0] = 40000;
+    Decay_Us[1] = 65200;
+    failures += Check_Decay_Times("step 1000, max 65535", 1000, 65535);
+
+    // A step of 0 must not hang with outputs that never decay (dark surface or robot lifted)
+    for (int i = 0; i < 8; i++) Decay_Us[i] = NO_DECAY_US;
+    Decay_Us[2] = 123;
+    failures += Check_Decay_Times("step 0, max 500", 0, 500);
+
+    failures += Check_Position_Sweep();
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
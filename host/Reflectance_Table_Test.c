@@ -0,0 +1,110 @@
+/**
+ * @file Reflectance_Table_Test.c
+ * @brief Host test that checks Reflectance_Sensor_Table against a reference classifier.
+ *
+ * Usage:
+ *
+ *  reflectance_table_test
+ *
+ * For all 256 sensor readings, both halves of the table (the reading as it is and shifted right
+ * by one bit) are compared with:
+ *  - The position computed by the original loop-and-divide Reflectance_Sensor_Position()
+ *  - The number of active sensors
+ *  - The intersection class tested bit by bit, as the line follower did before the table
+ *
+ * The program exits with status 1 if any entry differs.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Reflectance_Sensor.h"
+
+extern const int32_t Weight[8];
+extern const int32_t Mask[8];
+
+// Original Reflectance_Sensor_Position() before the lookup table
+static int32_t Reference_Position(uint8_t data)
+{
+    int sum = 0;
+    int count = 0;
+
+    if (data)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            if (data & Mask[i])
+            {
+                sum = sum + Weight[i];
+                count++;
+            }
+        }
+        return sum/count;
+    }
+
+    return Weight[0] + 1;
+}
+
+static uint8_t Reference_Count(uint8_t data)
+{
+    uint8_t count = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (data & Mask[i]) count++;
+    }
+    return count;
+}
+
+static uint8_t Reference_Class(uint8_t data)
+{
+    if (data == 0) return REFLECTANCE_LINE_NONE;
+    if (data == 0xFF) return REFLECTANCE_LINE_CROSS;
+    if ((data & 0x0F) == 0x0F) return REFLECTANCE_LINE_RIGHT_BRANCH;
+    if ((data & 0xF0) == 0xF0) return REFLECTANCE_LINE_LEFT_BRANCH;
+    return REFLECTANCE_LINE_TRACK;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    for (int shifted = 0; shifted < 2; shifted++)
+    {
+        for (int data = 0; data < 256; data++)
+        {
+            uint8_t reading = (uint8_t)(data >> shifted);
+            const Reflectance_Sensor_Line *line = &Reflectance_Sensor_Table[shifted][data];
+
+            if (line->position != Reference_Position(reading) ||
+                line->count != Reference_Count(reading) ||
+                line->line_class != Reference_Class(reading))
+            {
+                printf("Table[%d][0x%02X]: position %d count %u class %u, expected %d %u %u\n",
+                       shifted, data, line->position, line->count, line->line_class,
+                       Reference_Position(reading), Reference_Count(reading), Reference_Class(reading));
+                failures++;
+            }
+        }
+    }
+
+    // Reflectance_Sensor_Position() reads the unshifted half
+    for (int data = 0; data < 256; data++)
+    {
+        if (Reflectance_Sensor_Position((uint8_t)data) != Reference_Position((uint8_t)data))
+        {
+            printf("Reflectance_Sensor_Position(0x%02X): %d, expected %d\n",
+                   data, Reflectance_Sensor_Position((uint8_t)data), Reference_Position((uint8_t)data));
+            failures++;
+        }
+    }
+
+    printf("%d of 768 entries differ\n", failures);
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file Snapshot_Stress_Test.c
+ * @brief Host stress test for the Snapshot channel: checks that no reader ever sees a torn frame.
+ *
+ * Usage:
+ *
+ *  snapshot_stress_test [seconds]
+ *
+ * A POSIX interval timer interrupts the test every few microseconds. Its signal handler runs on
+ * the same thread, at an arbitrary instruction of the code it preempts, which is how an interrupt
+ * handler preempts the main loop on the Cortex-M4. Two cases are run:
+ *  - The handler writes and the main loop reads (the writer preempts the reader).
+ *  - The main loop writes and the handler reads (the reader preempts the writer).
+ *
+ * Each frame holds four copies of its frame number, so a frame mixed from two writes is detected,
+ * and the number returned by Snapshot_Read() must match the frame and never go backwards.
+ *
+ * @note The MSP432_Host emulator is not used: it only takes interrupts at register accesses,
+ * delays and WFI, and Snapshot_Read() and Snapshot_Write() touch none of them, so an emulated
+ * interrupt could never land inside a copy.
+ *
+ * The program exits with status 1 if a torn or out-of-order frame is read, or if the timer
+ * did not interrupt the copies often enough to make the test meaningful.
+ *
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include "../inc/Snapshot.h"
+
+// Default duration of each case in seconds
+#define RUN_TIME            1.0
+
+// Timer period in microseconds
+#define TIMER_PERIOD_US     7
+
+// Minimum number of handler calls for a case to count
+#define MIN_INTERRUPTS      1000
+
+typedef struct
+{
+    uint32_t value[4];
+} Frame;
+
+static Snapshot_Channel Channel;
+
+// Set by the signal handler
+static volatile int Handler_Writes = 0;
+static volatile uint32_t Interrupts = 0;
+static volatile uint32_t Handler_Number = 0;
+static uint32_t Handler_Last_Number = 0;
+static volatile uint32_t Torn = 0;
+static volatile uint32_t Backwards = 0;
+
+// Checks one frame read from the channel and the number returned with it
+static void Check_Frame(const Frame *frame, uint32_t number, uint32_t *last_number)
+{
+    if (frame->value[0] != number || frame->value[1] != number ||
+        frame->value[2] != number || frame->value[3] != number)
+    {
+        Torn = Torn + 1;
+    }
+    if (number < *last_number) Backwards = Backwards + 1;
+    *last_number = number;
+}
+
+static void Write_Number(uint32_t number)
+{
+    Frame frame = {{number, number, number, number}};
+    Snapshot_Write(&Channel, &frame);
+}
+
+static void Handler(int signal)
+{
+    (void)signal;
+
+    Interrupts = Interrupts + 1;
+    if (Handler_Writes)
+    {
+        Handler_Number = Handler_Number + 1;
+        Write_Number(Handler_Number);
+    }
+    else
+    {
+        Frame frame;
+        uint32_t number = Snapshot_Read(&Channel, &frame);
+        Check_Frame(&frame, number, &Handler_Last_Number);
+    }
+}
+
+static void Set_Timer(long period_us)
+{
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = period_us;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static int Run(const char *name, int handler_writes, double run_time)
+{
+    Frame initial = {{0, 0, 0, 0}};
+    uint32_t last_number = 0;
+
+    Snapshot_Init(&Channel, &initial, sizeof(initial));
+    Handler_Writes = handler_writes;
+    Handler_Number = 0;
+    Handler_Last_Number = 0;
+    Interrupts = 0;
+    Torn = 0;
+    Backwards = 0;
+
+    double end = Now() + run_time;
+    long iterations = 0;
+
+    Set_Timer(TIMER_PERIOD_US);
+    for (long i = 1; ((i & 0x3FF) != 0) || (Now() < end); i++)
+    {
+        iterations = i;
+        if (handler_writes)
+        {
+            Frame frame;
+            uint32_t number = Snapshot_Read(&Channel, &frame);
+            Check_Frame(&frame, number, &last_number);
+        }
+        else
+        {
+            Write_Number((uint32_t)i);
+        }
+    }
+    Set_Timer(0);
+
+    int failed = (Torn != 0) || (Backwards != 0) || (Interrupts < MIN_INTERRUPTS);
+    printf("%-28s %9ld main, %8u handler: %u torn, %u out of order  %s\n", name, iterations,
+           Interrupts, Torn, Backwards, failed ? "FAIL" : "ok");
+    return failed;
+}
+
+int main(int argc, char **argv)
+{
+    double run_time = (argc > 1) ? atof(argv[1]) : RUN_TIME;
+    struct sigaction action;
+    int failures = 0;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &Handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &action, NULL);
+
+    failures += Run("writer preempts reader", 1, run_time);
+    failures += Run("reader preempts writer", 0, run_time);
+
+    if (failures)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file Telemetry_Decode.cpp
+ * @brief Command-line tool that converts a telemetry capture to CSV or column files.
+ *
+ * Usage:
+ *
+ *  telemetry_decode capture.bin [output.csv]
+ *  telemetry_decode --columns prefix capture.bin
+ *
+ * The first form writes one CSV row per record to the output file (or to stdout). The second form
+ * writes one file per field, named prefix.<field>.bin, holding the values as little-endian
+ * integers of the field's size (e.g. numpy.fromfile("run.position.bin", dtype="<i2")).
+ *
+ * Decoder statistics (frames, CRC errors, format errors, lost records) are printed on stderr.
+ *
+ */
+
+#include "Telemetry_Decoder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Size of the blocks read from the capture file
+static const size_t READ_SIZE = 1 << 20;
+
+// Writes the decimal representation of an unsigned value and returns the position after it
+static char *Write_Unsigned(char *out, uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0) *out++ = digits[--count];
+    return out;
+}
+
+// Writes the decimal representation of a signed value and returns the position after it
+static char *Write_Integer(char *out, int32_t value)
+{
+    if (value < 0) *out++ = '-';
+    return Write_Unsigned(out, (value < 0) ? 0u - (uint32_t)value : (uint32_t)value);
+}
+
+static void Write_CSV(FILE *output, const std::vector<Telemetry_Sample> &samples, std::vector<char> &text)
+{
+    // At most 8 fields of 11 characters with their separators per row
+    text.resize(samples.size() * 96);
+    char *out = text.data();
+
+    for (const Telemetry_Sample &sample : samples)
+    {
+        out = Write_Integer(out, sample.sequence);         *out++ = ',';
+        out = Write_Unsigned(out, sample.time);            *out++ = ',';
+        out = Write_Integer(out, sample.sensor_data);      *out++ = ',';
+        out = Write_Integer(out, sample.state);            *out++ = ',';
+        out = Write_Integer(out, sample.position);         *out++ = ',';
+        out = Write_Integer(out, sample.pid);              *out++ = ',';
+        out = Write_Integer(out, sample.duty_cycle_left);  *out++ = ',';
+        out = Write_Integer(out, sample.duty_cycle_right); *out++ = '\n';
+    }
+
+    fwrite(text.data(), 1, out - text.data(), output);
+}
+
+// One output file of the column format
+struct Column
+{
+    const char *name;
+    size_t size;
+    size_t offset;
+    FILE *file;
+};
+
+static Column Columns[] =
+{
+    {"sequence",         sizeof(uint16_t), offsetof(Telemetry_Sample, sequence),         nullptr},
+    {"time",             sizeof(uint32_t), offsetof(Telemetry_Sample, time),             nullptr},
+    {"sensor_data",      sizeof(uint8_t),  offsetof(Telemetry_Sample, sensor_data),      nullptr},
+    {"state",            sizeof(uint8_t),  offsetof(Telemetry_Sample, state),            nullptr},
+    {"position",         sizeof(int16_t),  offsetof(Telemetry_Sample, position),         nullptr},
+    {"pid",              sizeof(int16_t),  offsetof(Telemetry_Sample, pid),              nullptr},
+    {"duty_cycle_left",  sizeof(uint16_t), offsetof(Telemetry_Sample, duty_cycle_left),  nullptr},
+    {"duty_cycle_right", sizeof(uint16_t), offsetof(Telemetry_Sample, duty_cycle_right), nullptr}
+};
+
+static void Write_Columns(const std::vector<Telemetry_Sample> &samples, std::vector<char> &data)
+{
+    for (Column &column : Columns)
+    {
+        // Gather the field of every sample (the host is assumed to be little-endian)
+        data.resize(samples.size() * column.size);
+        char *out = data.data();
+        for (const Telemetry_Sample &sample : samples)
+        {
+            std::memcpy(out, reinterpret_cast<const char *>(&sample) + column.offset, column.size);
+            out += column.size;
+        }
+        fwrite(data.data(), 1, data.size(), column.file);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *prefix = nullptr;
+    int arg = 1;
+
+    if (arg < argc && std::strcmp(argv[arg], "--columns") == 0 && arg + 1 < argc)
+    {
+        prefix = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg >= argc)
+    {
+        fprintf(stderr, "usage: %s capture.bin [output.csv]\n       %s --columns prefix capture.bin\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    FILE *input = fopen(argv[arg], "rb");
+    if (input == nullptr)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+
+    FILE *output = stdout;
+    if (prefix)
+    {
+        for (Column &column : Columns)
+        {
+            std::string name = std::string(prefix) + "." + column.name + ".bin";
+            column.file = fopen(name.c_str(), "wb");
+            if (column.file == nullptr)
+            {
+                perror(name.c_str());
+                return 1;
+            }
+        }
+    }
+    else
+    {
+        if (arg + 1 < argc) output = fopen(argv[arg + 1], "w");
+        if (output == nullptr)
+        {
+            perror(argv[arg + 1]);
+            return 1;
+        }
+        fputs("sequence,time_ms,sensor_data,state,position,pid,duty_cycle_left,duty_cycle_right\n", output);
+    }
+
+    Telemetry_Decoder decoder;
+    std::vector<uint8_t> block(READ_SIZE);
+    std::vector<Telemetry_Sample> samples;
+    std::vector<char> text;
+    size_t length;
+
+    while ((length = fread(block.data(), 1, block.size(), input)) > 0)
+    {
+        samples.clear();
+        decoder.Decode(block.data(), length, samples);
+
+        if (prefix)
+        {
+            Write_Columns(samples, text);
+        }
+        else
+        {
+            Write_CSV(output, samples, text);
+        }
+    }
+
+    fclose(input);
+    if (prefix)
+    {
+        for (Column &column : Columns) fclose(column.file);
+    }
+    else if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    const Telemetry_Statistics &statistics = decoder.Statistics();
+    fprintf(stderr, "frames: %llu, CRC errors: %llu, format errors: %llu, lost records: %llu\n",
+            (unsigned long long)statistics.frames, (unsigned long long)statistics.crc_errors,
+            (unsigned long long)statistics.format_errors, (unsigned long long)statistics.lost_records);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file Telemetry_Decoder.cpp
+ * @brief Source code for the host-side telemetry decoder.
+ *
+ * This file contains the member function definitions of the Telemetry_Decoder class.
+ *
+ */
+
+#include "Telemetry_Decoder.h"
+
+#include <cstring>
+
+// Version and size of the payload written by the firmware (see inc/Telemetry.h)
+static const uint8_t TELEMETRY_VERSION = 1;
+static const size_t TELEMETRY_PAYLOAD_SIZE = 17;
+
+// CRC-16/CCITT-FALSE lookup table, one entry per byte value
+static uint16_t CRC_Table[256];
+
+static void CRC_Table_Init()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+        CRC_Table[i] = crc;
+    }
+}
+
+static uint16_t CRC(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = (uint16_t)((crc << 8) ^ CRC_Table[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+static uint16_t Read_16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t Read_32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+Telemetry_Decoder::Telemetry_Decoder()
+    : frame_length(0), overflow(false), have_sequence(false), next_sequence(0)
+{
+    std::memset(&statistics, 0, sizeof(statistics));
+    if (CRC_Table[1] == 0) CRC_Table_Init();
+}
+
+size_t Telemetry_Decoder::Decode(const uint8_t *data, size_t length, std::vector<Telemetry_Sample> &samples)
+{
+    size_t count = 0;
+    const uint8_t *end = data + length;
+
+    while (data < end)
+    {
+        const uint8_t *delimiter = static_cast<const uint8_t *>(std::memchr(data, 0, end - data));
+        size_t size = (delimiter ? delimiter : end) - data;
+
+        if (!overflow && frame_length + size <= MAX_FRAME_SIZE)
+        {
+            std::memcpy(&frame[frame_length], data, size);
+            frame_length += size;
+        }
+        else
+        {
+            overflow = true;
+        }
+
+        if (delimiter == nullptr) break;
+
+        if (overflow)
+        {
+            statistics.format_errors++;
+        }
+        else if (frame_length > 0)
+        {
+            Telemetry_Sample sample;
+            if (Decode_Frame(sample))
+            {
+                samples.push_back(sample);
+                count++;
+            }
+        }
+
+        frame_length = 0;
+        overflow = false;
+        data = delimiter + 1;
+    }
+
+    return count;
+}
+
+bool Telemetry_Decoder::Decode_Frame(Telemetry_Sample &sample)
+{
+    uint8_t payload[MAX_FRAME_SIZE];
+    size_t length = 0;
+
+    // Undo the COBS encoding: each code byte is followed by code - 1 data bytes and, unless it is
+    // the last block or 0xFF, a zero
+    size_t i = 0;
+    while (i < frame_length)
+    {
+        uint8_t code = frame[i++];
+        if (i + code - 1 > frame_length)
+        {
+            statistics.format_errors++;
+            return false;
+        }
+        std::memcpy(&payload[length], &frame[i], code - 1);
+        length += code - 1;
+        i += code - 1;
+        if (code != 0xFF && i < frame_length) payload[length++] = 0;
+    }
+
+    if (length < TELEMETRY_PAYLOAD_SIZE + 2 || payload[0] < TELEMETRY_VERSION)
+    {
+        statistics.format_errors++;
+        return false;
+    }
+
+    if (CRC(payload, length - 2) != Read_16(&payload[length - 2]))
+    {
+        statistics.crc_errors++;
+        return false;
+    }
+
+    // Later versions only append fields, so the known fields are read from any version
+    sample.version = payload[0];
+    sample.sequence = Read_16(&payload[1]);
+    sample.time = Read_32(&payload[3]);
+    sample.sensor_data = payload[7];
+    sample.state = payload[8];
+    sample.position = (int16_t)Read_16(&payload[9]);
+    sample.pid = (int16_t)Read_16(&payload[11]);
+    sample.duty_cycle_left = Read_16(&payload[13]);
+    sample.duty_cycle_right = Read_16(&payload[15]);
+
+    if (have_sequence) statistics.lost_records += (uint16_t)(sample.sequence - next_sequence);
+    next_sequence = (uint16_t)(sample.sequence + 1);
+    have_sequence = true;
+
+    statistics.frames++;
+    return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file Telemetry_Decoder.h
+ * @brief Header file for the host-side telemetry decoder.
+ *
+ * This file contains the class definition for a streaming decoder of the binary telemetry
+ * frames sent by the Telemetry module (see inc/Telemetry.h for the frame format). The capture
+ * can be fed in blocks of any size: a frame split across two blocks is reassembled, and a
+ * corrupted frame is skipped up to the next 0x00 delimiter. A capture that starts in the middle
+ * of a frame counts one format or CRC error for that frame.
+ *
+ * host/Telemetry_Decode.cpp uses it to convert a capture file to CSV or column files:
+ *
+ *  g++ -O2 -std=c++11 host/Telemetry_Decoder.cpp host/Telemetry_Decode.cpp -o telemetry_decode
+ *
+ */
+
+#ifndef TELEMETRY_DECODER_H_
+#define TELEMETRY_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief One decoded telemetry record.
+ */
+struct Telemetry_Sample
+{
+    uint8_t version;
+    uint16_t sequence;
+    uint32_t time;
+    uint8_t sensor_data;
+    uint8_t state;
+    int16_t position;
+    int16_t pid;
+    uint16_t duty_cycle_left;
+    uint16_t duty_cycle_right;
+};
+
+/**
+ * @brief Error and loss counters of a decoder.
+ *
+ *  - frames:         Frames decoded successfully
+ *  - crc_errors:     Frames rejected because of a CRC mismatch
+ *  - format_errors:  Frames rejected because of a COBS error, a short payload or an unknown version
+ *  - lost_records:   Records missing from the sequence numbers of the decoded frames
+ */
+struct Telemetry_Statistics
+{
+    uint64_t frames;
+    uint64_t crc_errors;
+    uint64_t format_errors;
+    uint64_t lost_records;
+};
+
+/**
+ * @brief Streaming decoder of COBS-framed telemetry records.
+ */
+class Telemetry_Decoder
+{
+public:
+    Telemetry_Decoder();
+
+    /**
+     * @brief Decodes a block of the capture.
+     *
+     * @param data    Pointer to the captured bytes.
+     * @param length  The number of bytes.
+     * @param samples The decoded records are appended to this vector.
+     *
+     * @return The number of records appended.
+     */
+    size_t Decode(const uint8_t *data, size_t length, std::vector<Telemetry_Sample> &samples);
+
+    /**
+     * @brief Returns the error and loss counters since the decoder was created.
+     */
+    const Telemetry_Statistics &Statistics() const { return statistics; }
+
+private:
+    bool Decode_Frame(Telemetry_Sample &sample);
+
+    // Largest encoded frame accepted, which leaves room for fields added by later versions
+    static const size_t MAX_FRAME_SIZE = 254;
+
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t frame_length;
+    bool overflow;
+    bool have_sequence;
+    uint16_t next_sequence;
+    Telemetry_Statistics statistics;
+};
+
+#endif /* TELEMETRY_DECODER_H_ */
@@ -0,0 +1,32 @@
+/**
+ * @file file.h
+ * @brief Host replacement for the TI run-time support file.h header.
+ *
+ * EUSCI_A0_UART_Init_Printf() registers the UART as a stdio device with add_device().
+ * On the host, stdout already goes to the terminal, so add_device() reports an error
+ * and EUSCI_A0_UART_Init_Printf() returns after initializing the UART.
+ *
+ */
+
+#ifndef FILE_H_
+#define FILE_H_
+
+#include <sys/types.h>
+
+#define _SSA    0x0000
+#define _MSA    0x0001
+
+static inline int add_device(char *name,
+                             unsigned flags,
+                             int (*dopen)(const char *path, unsigned flags, int llv_fd),
+                             int (*dclose)(int dev_fd),
+                             int (*dread)(int dev_fd, char *buf, unsigned count),
+                             int (*dwrite)(int dev_fd, const char *buf, unsigned count),
+                             off_t (*dlseek)(int dev_fd, off_t offset, int origin),
+                             int (*dunlink)(const char *path),
+                             int (*drename)(const char *old_name, const char *new_name))
+{
+    return -1;
+}
+
+#endif /* FILE_H_ */
@@ -0,0 +1,421 @@
+/**
+ * @file msp.h
+ * @brief Host replacement for the TI msp.h device header.
+ *
+ * This file is only used when the firmware is compiled for a Linux workstation with
+ * -DMSP432_HOST and -Ihost placed ahead of the TI include directories. It declares the
+ * subset of the MSP432P401R peripheral register layout that the drivers in software/ use,
+ * with the same type, register and instance names as the TI header, so none of the
+ * drivers need to change to run on the host.
+ *
+ * The register blocks are backed by emulated state in MSP432_Host.c:
+ *  - P1 - P10, PJ: GPIO ports with edge-triggered interrupts on P1 - P6
+ *  - TIMER_A0 - TIMER_A3: Up, Continuous and Up/Down modes, compare and capture
+ *  - SysTick, NVIC and SCB: exception priorities, enables and PRIMASK
+ *  - DWT and CoreDebug: the CYCCNT cycle counter, which follows the virtual clock
+ *  - ADC14: sequence-of-channels conversions sampled through a callback, started by ADC14SC or
+ *    by a Timer_A output (Set/Reset and Reset/Set modes)
+ *  - DMA: basic, auto-request and ping-pong transfers on channels 0 - 7, triggered by software
+ *    or by the eUSCI transmit/receive flags and the ADC14 end of sequence
+ *  - EUSCI_A0 - EUSCI_A3, EUSCI_B0 - EUSCI_B3: UART/SPI transmit and receive, I2C master
+ *  - PCM and CS: enough for Clock_Init48MHz() to complete
+ *  - FLCTL: read wait states, and erase and immediate programming of the information memory
+ *
+ * The EUSCI, ADC14 and FLCTL instances are reached through accessor functions instead of plain
+ * pointers. Every register access through them advances the virtual clock by a few cycles
+ * and services the peripheral, so busy-wait loops in the drivers make progress and take
+ * the same amount of virtual time that they take on the LaunchPad.
+ *
+ * @note Do not add this directory to the include path of the CCS project. The real
+ * msp.h from the TI toolchain must be used when building for the MSP432.
+ *
+ */
+
+#ifndef MSP_H_
+#define MSP_H_
+
+#include <stdint.h>
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+
+/**
+ * @brief Register layout of an interruptible digital I/O port (P1 - P10).
+ *
+ * @note Only P1 - P6 generate interrupts on the MSP432P401R. The IES, IE and IFG
+ * registers of P7 - P10 are kept for layout compatibility and are never serviced.
+ */
+typedef struct
+{
+    __I  uint8_t IN;
+    __IO uint8_t OUT;
+    __IO uint8_t DIR;
+    __IO uint8_t REN;
+    __IO uint8_t DS;
+    __IO uint8_t SEL0;
+    __IO uint8_t SEL1;
+    __I  uint16_t IV;
+    __IO uint8_t SELC;
+    __IO uint8_t IES;
+    __IO uint8_t IE;
+    __IO uint8_t IFG;
+} DIO_PORT_Interruptable_Type;
+
+typedef DIO_PORT_Interruptable_Type DIO_PORT_Odd_Interruptable_Type;
+typedef DIO_PORT_Interruptable_Type DIO_PORT_Even_Interruptable_Type;
+
+/**
+ * @brief Register layout of the non-interruptible digital I/O port (PJ).
+ */
+typedef struct
+{
+    __I  uint8_t IN;
+    __IO uint8_t OUT;
+    __IO uint8_t DIR;
+    __IO uint8_t REN;
+    __IO uint8_t DS;
+    __IO uint8_t SEL0;
+    __IO uint8_t SEL1;
+    __IO uint8_t SELC;
+} DIO_PORT_Not_Interruptable_Type;
+
+/**
+ * @brief Register layout of a Timer_A module.
+ */
+typedef struct
+{
+    __IO uint16_t CTL;
+    __IO uint16_t CCTL[7];
+    __IO uint16_t R;
+    __IO uint16_t CCR[7];
+    __IO uint16_t EX0;
+    __I  uint16_t IV;
+} Timer_A_Type;
+
+/**
+ * @brief Register layout of an eUSCI_A module (UART / SPI).
+ */
+typedef struct
+{
+    __IO uint16_t CTLW0;
+    __IO uint16_t CTLW1;
+    __IO uint16_t BRW;
+    __IO uint16_t MCTLW;
+    __IO uint16_t STATW;
+    __I  uint16_t RXBUF;
+    __IO uint16_t TXBUF;
+    __IO uint16_t ABCTL;
+    __IO uint16_t IRCTL;
+    __IO uint16_t IE;
+    __IO uint16_t IFG;
+    __I  uint16_t IV;
+} EUSCI_A_Type;
+
+/**
+ * @brief Register layout of an eUSCI_B module (SPI / I2C).
+ */
+typedef struct
+{
+    __IO uint16_t CTLW0;
+    __IO uint16_t CTLW1;
+    __IO uint16_t BRW;
+    __IO uint16_t STATW;
+    __IO uint16_t TBCNT;
+    __I  uint16_t RXBUF;
+    __IO uint16_t TXBUF;
+    __IO uint16_t I2COA0;
+    __IO uint16_t I2COA1;
+    __IO uint16_t I2COA2;
+    __IO uint16_t I2COA3;
+    __I  uint16_t ADDRX;
+    __IO uint16_t ADDMASK;
+    __IO uint16_t I2CSA;
+    __IO uint16_t IE;
+    __IO uint16_t IFG;
+    __I  uint16_t IV;
+} EUSCI_B_Type;
+
+/**
+ * @brief Register layout of the ADC14 module.
+ */
+typedef struct
+{
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t LO0;
+    __IO uint32_t HI0;
+    __IO uint32_t LO1;
+    __IO uint32_t HI1;
+    __IO uint32_t MCTL[32];
+    __IO uint32_t MEM[32];
+    __IO uint32_t IER0;
+    __IO uint32_t IER1;
+    __I  uint32_t IFGR0;
+    __I  uint32_t IFGR1;
+    __O  uint32_t CLRIFGR0;
+    __IO uint32_t CLRIFGR1;
+    __I  uint32_t IV;
+} ADC14_Type;
+
+/**
+ * @brief Register layout of the Power Control Manager.
+ */
+typedef struct
+{
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t IE;
+    __I  uint32_t IFG;
+    __O  uint32_t CLRIFG;
+} PCM_Type;
+
+/**
+ * @brief Register layout of the Clock System.
+ */
+typedef struct
+{
+    __IO uint32_t KEY;
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t CTL2;
+    __IO uint32_t CTL3;
+    __IO uint32_t CLKEN;
+    __I  uint32_t STAT;
+    __IO uint32_t IE;
+    __I  uint32_t IFG;
+    __O  uint32_t CLRIFG;
+    __O  uint32_t SETIFG;
+    __IO uint32_t DCOERCAL0;
+    __IO uint32_t DCOERCAL1;
+} CS_Type;
+
+/**
+ * @brief Register layout of the Flash Controller (read control, programming and erase).
+ */
+typedef struct
+{
+    __I  uint32_t POWER_STAT;
+    __IO uint32_t BANK0_RDCTL;
+    __IO uint32_t BANK1_RDCTL;
+    __IO uint32_t RDBRST_CTLSTAT;
+    __IO uint32_t PRG_CTLSTAT;
+    __IO uint32_t ERASE_CTLSTAT;
+    __IO uint32_t ERASE_SECTADDR;
+    __IO uint32_t BANK0_INFO_WEPROT;
+    __IO uint32_t BANK0_MAIN_WEPROT;
+    __IO uint32_t BANK1_INFO_WEPROT;
+    __IO uint32_t BANK1_MAIN_WEPROT;
+    __I  uint32_t IFG;
+    __IO uint32_t IE;
+    __O  uint32_t CLRIFG;
+    __O  uint32_t SETIFG;
+} FLCTL_Type;
+
+#define FLCTL_BANK0_RDCTL_WAIT_2            ((uint32_t)0x00002000)
+#define FLCTL_BANK1_RDCTL_WAIT_2            ((uint32_t)0x00002000)
+#define FLCTL_PRG_CTLSTAT_ENABLE            ((uint32_t)0x00000001)
+#define FLCTL_PRG_CTLSTAT_MODE              ((uint32_t)0x00000002)
+#define FLCTL_PRG_CTLSTAT_STATUS_MASK       ((uint32_t)0x00030000)
+#define FLCTL_ERASE_CTLSTAT_START           ((uint32_t)0x00000001)
+#define FLCTL_ERASE_CTLSTAT_MODE            ((uint32_t)0x00000002)
+#define FLCTL_ERASE_CTLSTAT_TYPE_MASK       ((uint32_t)0x0000000C)
+#define FLCTL_ERASE_CTLSTAT_TYPE_1          ((uint32_t)0x00000004)
+#define FLCTL_ERASE_CTLSTAT_STATUS_MASK     ((uint32_t)0x00030000)
+#define FLCTL_ERASE_CTLSTAT_STATUS_2        ((uint32_t)0x00020000)
+#define FLCTL_ERASE_CTLSTAT_STATUS_3        ((uint32_t)0x00030000)
+#define FLCTL_ERASE_CTLSTAT_ADDR_ERR        ((uint32_t)0x00040000)
+#define FLCTL_ERASE_CTLSTAT_CLR_STAT        ((uint32_t)0x00080000)
+#define FLCTL_BANK0_INFO_WEPROT_PROT0       ((uint32_t)0x00000001)
+#define FLCTL_IFG_ERASE                     ((uint32_t)0x00000020)
+#define FLCTL_IFG_PRG_ERR                   ((uint32_t)0x00000200)
+#define FLCTL_CLRIFG_ERASE                  ((uint32_t)0x00000020)
+#define FLCTL_CLRIFG_PRG_ERR                ((uint32_t)0x00000200)
+
+/**
+ * @brief Register layout of the SysTick timer.
+ */
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I  uint32_t CALIB;
+} SysTick_Type;
+
+/**
+ * @brief Register layout of the Nested Vectored Interrupt Controller.
+ *
+ * Writes to ISER, ICER, ISPR and ICPR follow the hardware set/clear semantics:
+ * writing a zero bit has no effect.
+ */
+typedef struct
+{
+    __IO uint32_t ISER[8];
+    __IO uint32_t ICER[8];
+    __IO uint32_t ISPR[8];
+    __IO uint32_t ICPR[8];
+    __IO uint32_t IABR[8];
+    __IO uint8_t  IP[240];
+    __O  uint32_t STIR;
+} NVIC_Type;
+
+/**
+ * @brief Register layout of the System Control Block.
+ */
+typedef struct
+{
+    __I  uint32_t CPUID;
+    __IO uint32_t ICSR;
+    __IO uint32_t VTOR;
+    __IO uint32_t AIRCR;
+    __IO uint32_t SCR;
+    __IO uint32_t CCR;
+    __IO uint8_t  SHP[12];
+    __IO uint32_t SHCSR;
+} SCB_Type;
+
+/**
+ * @brief Register layout of the DMA channel configuration registers.
+ */
+typedef struct
+{
+    __I  uint32_t DEVICE_CFG;
+    __IO uint32_t SW_CHTRIG;
+    uint32_t RESERVED0[2];
+    __IO uint32_t CH_SRCCFG[32];
+    uint32_t RESERVED1[28];
+    __IO uint32_t INT1_SRCCFG;
+    __IO uint32_t INT2_SRCCFG;
+    __IO uint32_t INT3_SRCCFG;
+    uint32_t RESERVED2;
+    __I  uint32_t INT0_SRCFLG;
+    __O  uint32_t INT0_CLRFLG;
+} DMA_Channel_Type;
+
+/**
+ * @brief Register layout of the DMA controller.
+ *
+ * @note CTLBASE is as wide as a pointer on the host, so that it can hold the address of
+ * the control table. Firmware should write it through a uintptr_t cast.
+ */
+typedef struct
+{
+    __I  uint32_t STAT;
+    __O  uint32_t CFG;
+    __IO uintptr_t CTLBASE;
+    __I  uint32_t ALTBASE;
+    __I  uint32_t WAITSTAT;
+    __O  uint32_t SWREQ;
+    __IO uint32_t USEBURSTSET;
+    __O  uint32_t USEBURSTCLR;
+    __IO uint32_t REQMASKSET;
+    __O  uint32_t REQMASKCLR;
+    __IO uint32_t ENASET;
+    __O  uint32_t ENACLR;
+    __IO uint32_t ALTSET;
+    __O  uint32_t ALTCLR;
+    __IO uint32_t PRIOSET;
+    __O  uint32_t PRIOCLR;
+    uint32_t RESERVED4[3];
+    __IO uint32_t ERRCLR;
+} DMA_Control_Type;
+
+/**
+ * @brief Register layout of the Data Watchpoint and Trace unit.
+ *
+ * Only CYCCNT is emulated. It counts MCLK cycles while CYCCNTENA is set in CTRL
+ * and TRCENA is set in CoreDebug->DEMCR.
+ */
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+    __IO uint32_t CPICNT;
+    __IO uint32_t EXCCNT;
+    __IO uint32_t SLEEPCNT;
+    __IO uint32_t LSUCNT;
+    __IO uint32_t FOLDCNT;
+    __I  uint32_t PCSR;
+} DWT_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk          ((uint32_t)0x00000001)
+
+/**
+ * @brief Register layout of the Core Debug block.
+ */
+typedef struct
+{
+    __IO uint32_t DHCSR;
+    __O  uint32_t DCRSR;
+    __IO uint32_t DCRDR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define CoreDebug_DEMCR_TRCENA_Msk      ((uint32_t)0x01000000)
+
+extern DIO_PORT_Interruptable_Type MSP432_Host_Port[10];
+extern DIO_PORT_Not_Interruptable_Type MSP432_Host_PortJ;
+extern Timer_A_Type MSP432_Host_Timer_A[4];
+extern PCM_Type MSP432_Host_PCM;
+extern CS_Type MSP432_Host_CS;
+extern uint32_t MSP432_Host_Info_Memory[4096];
+extern SysTick_Type MSP432_Host_SysTick;
+extern NVIC_Type MSP432_Host_NVIC;
+extern SCB_Type MSP432_Host_SCB;
+extern DWT_Type MSP432_Host_DWT;
+extern CoreDebug_Type MSP432_Host_CoreDebug;
+
+EUSCI_A_Type *MSP432_Host_EUSCI_A(uint8_t module);
+EUSCI_B_Type *MSP432_Host_EUSCI_B(uint8_t module);
+ADC14_Type *MSP432_Host_ADC14(void);
+FLCTL_Type *MSP432_Host_FLCTL_Registers(void);
+NVIC_Type *MSP432_Host_NVIC_Registers(void);
+DMA_Channel_Type *MSP432_Host_DMA_Channel(void);
+DMA_Control_Type *MSP432_Host_DMA_Control(void);
+
+#define P1          (&MSP432_Host_Port[0])
+#define P2          (&MSP432_Host_Port[1])
+#define P3          (&MSP432_Host_Port[2])
+#define P4          (&MSP432_Host_Port[3])
+#define P5          (&MSP432_Host_Port[4])
+#define P6          (&MSP432_Host_Port[5])
+#define P7          (&MSP432_Host_Port[6])
+#define P8          (&MSP432_Host_Port[7])
+#define P9          (&MSP432_Host_Port[8])
+#define P10         (&MSP432_Host_Port[9])
+#define PJ          (&MSP432_Host_PortJ)
+
+#define TIMER_A0    (&MSP432_Host_Timer_A[0])
+#define TIMER_A1    (&MSP432_Host_Timer_A[1])
+#define TIMER_A2    (&MSP432_Host_Timer_A[2])
+#define TIMER_A3    (&MSP432_Host_Timer_A[3])
+
+#define EUSCI_A0    (MSP432_Host_EUSCI_A(0))
+#define EUSCI_A1    (MSP432_Host_EUSCI_A(1))
+#define EUSCI_A2    (MSP432_Host_EUSCI_A(2))
+#define EUSCI_A3    (MSP432_Host_EUSCI_A(3))
+#define EUSCI_B0    (MSP432_Host_EUSCI_B(0))
+#define EUSCI_B1    (MSP432_Host_EUSCI_B(1))
+#define EUSCI_B2    (MSP432_Host_EUSCI_B(2))
+#define EUSCI_B3    (MSP432_Host_EUSCI_B(3))
+
+#define ADC14       (MSP432_Host_ADC14())
+
+#define DMA_Channel (MSP432_Host_DMA_Channel())
+#define DMA_Control (MSP432_Host_DMA_Control())
+
+#define PCM         (&MSP432_Host_PCM)
+#define CS          (&MSP432_Host_CS)
+#define FLCTL       (MSP432_Host_FLCTL_Registers())
+#define SysTick     (&MSP432_Host_SysTick)
+#define NVIC        (MSP432_Host_NVIC_Registers())
+#define SCB         (&MSP432_Host_SCB)
+#define DWT         (&MSP432_Host_DWT)
+#define CoreDebug   (&MSP432_Host_CoreDebug)
+
+// The 16 KB of information memory (0x00200000 on the MSP432P401R) are backed by a host array,
+// which MSP432_Host_Reset() does not clear, so that they survive a reset like flash does
+#define FLASH_INFO_MEMORY   (MSP432_Host_Info_Memory)
+
+#endif /* MSP_H_ */
@@ -20,11 +20,31 @@
 
 #include <stdint.h>
 #include "msp.h"
+#include "Analog_Distance_Sensor_Calibration.h"
 
-#define Ax 1195159
-#define Bx -1058
-#define Cx 40
-#define ANALOG_DISTANCE_SENSOR_MAX 2552
+// Sensors selected by Analog_Distance_Sensor_Calibrate_Sensor
+typedef enum
+{
+    ANALOG_DISTANCE_SENSOR_RIGHT = 0,   // A17, P9.0
+    ANALOG_DISTANCE_SENSOR_CENTER = 1,  // A14, P6.1
+    ANALOG_DISTANCE_SENSOR_LEFT = 2,    // A16, P9.1
+    ANALOG_DISTANCE_SENSOR_COUNT = 3
+} Analog_Distance_Sensor_Select;
+
+// Spacing of the calibration table breakpoints in ADC counts (1 << SHIFT). The table has
+// (16384 >> SHIFT) + 1 entries per sensor, and the results are interpolated between them.
+#define ANALOG_DISTANCE_SENSOR_TABLE_SHIFT 7
+
+// Number of A17/A14/A16 sequences kept by the DMA mode (must be a power of 2). The two
+// slots held by the DMA cannot be read, so Analog_Distance_Sensor_Get_Filtered must be called
+// at least once every RING_SIZE - 2 sequences to see all of them.
+#define ANALOG_DISTANCE_SENSOR_RING_SIZE 8
+
+// Depth of the low-pass filter (LPF_FILTER) of the DMA mode, in sequences
+#define ANALOG_DISTANCE_SENSOR_FILTER_SIZE 8
+
+// DMA channel used by the DMA mode (channel 7 is the only one triggered by ADC14)
+#define ANALOG_DISTANCE_SENSOR_DMA_CHANNEL 7
 
 /**
  * @brief Initialize the Sharp GP2Y0A21YK0F Analog Distance Sensors and configure ADC14 settings.
@@ -53,17 +73,76 @@ void Analog_Distance_Sensor_Init();
  */
 void Analog_Distance_Sensor_Start_Conversion(uint32_t *Ch_17, uint32_t *Ch_14, uint32_t *Ch_16);
 
+/**
+ * @brief Initialize the Sharp GP2Y0A21YK0F Analog Distance Sensors in DMA mode.
+ *
+ * The A17/A14/A16 sequence is converted in the background without any CPU involvement:
+ *  - ADC14 runs in repeat-sequence mode with the output of Timer A1 CCR2 as its sample-and-hold
+ *    source (ADC14SHSx = 4) instead of ADC14SC. Each period of Timer A1 converts one channel,
+ *    so a complete sequence takes three periods (3 ms with the 1 kHz scheduler timebase).
+ *  - At the end of each sequence, DMA channel 7 copies the three results into the next slot of
+ *    a ring of ANALOG_DISTANCE_SENSOR_RING_SIZE sequences. DMA_INT0 only reloads the DMA
+ *    structure that completed and moves the ring index.
+ *
+ * Timer A1 must already be running (Timer_A1_Interrupt_Init or Scheduler_Init), and DMA_Init
+ * must be called first. Analog_Distance_Sensor_Start_Conversion must not be used in this mode.
+ *
+ * @return None
+ */
+void Analog_Distance_Sensor_Init_DMA();
+
+/**
+ * @brief Returns the low-pass filtered results of the sequences converted in DMA mode. Never waits.
+ *
+ * The sequences completed since the previous call are fed to a three-channel LPF_FILTER of depth
+ * ANALOG_DISTANCE_SENSOR_FILTER_SIZE with LPF_Calc_Distance. The new slots of the ring are copied
+ * in a short critical section, so the filter never sees a sequence that is being written by the DMA.
+ * The first sequence fills the whole window of the filter.
+ *
+ * The filter state is not protected: this function must be called from a single context.
+ *
+ * @param Ch_17 Pointer to store the filtered result of channel A17 (P9.0).
+ * @param Ch_14 Pointer to store the filtered result of channel A14 (P6.1).
+ * @param Ch_16 Pointer to store the filtered result of channel A16 (P9.1).
+ *
+ * @return The number of new sequences filtered, up to ANALOG_DISTANCE_SENSOR_RING_SIZE - 2.
+ *         Before the first sequence completes, 0 is returned and the results are not written.
+ */
+uint32_t Analog_Distance_Sensor_Get_Filtered(uint32_t *Ch_17, uint32_t *Ch_14, uint32_t *Ch_16);
+
+/**
+ * @brief Returns the number of sequences converted since Analog_Distance_Sensor_Init_DMA.
+ *
+ * @return The number of sequences.
+ */
+uint32_t Analog_Distance_Sensor_Get_Count();
+
+/**
+ * @brief Calibrate the distance sensor reading of one sensor based on a filtered distance value.
+ *
+ * The calibration formula of the sensor (see Analog_Distance_Sensor_Calibration.h):
+ *  D = A / (filtered_distance + B) + C
+ *
+ * is evaluated at compile time every 128 ADC counts, and the result is interpolated linearly
+ * between the two nearest entries of the table. No division is performed at run time.
+ *
+ * @param sensor            The sensor the value was read from.
+ * @param filtered_distance The filtered ADC result of the sensor (0 to 16383).
+ *
+ * @return Calibrated distance in mm, or 800 if the filtered distance is less than the MAX
+ *         parameter of the sensor.
+ */
+int32_t Analog_Distance_Sensor_Calibrate_Sensor(Analog_Distance_Sensor_Select sensor, int filtered_distance);
+
 /**
  * @brief Calibrate the distance sensor reading based on a filtered distance value.
  *
- * This function calibrates the distance sensor reading based on a filtered distance value.
- * It applies a calibration formula to adjust the sensor data, providing a calibrated result.
- * The following calibration formula is used:
- *  Dx = (Ax / (filtered_distance + Bx) + Cx)
+ * Uses the calibration table of the center sensor. Analog_Distance_Sensor_Calibrate_Sensor
+ * should be used when the sensor is known.
  *
  * @param filtered_distance The filtered distance value obtained from the sensor.
  *
- * @return Calibrated distance value, or 800 if the filtered distance is less than ANALOG_DISTANCE_SENSOR_MAX.
+ * @return Calibrated distance value, or 800 if the filtered distance is less than ANALOG_DISTANCE_SENSOR_CAL_CENTER_MAX.
  */
 int32_t Analog_Distance_Sensor_Calibrate(int filtered_distance);
 
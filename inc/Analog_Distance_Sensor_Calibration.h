@@ -0,0 +1,37 @@
+/**
+ * @file Analog_Distance_Sensor_Calibration.h
+ * @brief Calibration parameters of the three Sharp GP2Y0A21YK0F Analog Distance Sensors.
+ *
+ * Each sensor has its own parameters for the calibration formula:
+ *  D = A / (ADC + B) + C (mm)
+ *
+ * MAX is the ADC result below which the distance is reported as 800 mm (out of range).
+ * The lookup tables of Analog_Distance_Sensor.c are built from these values at compile time.
+ *
+ * This file is written by host/Distance_Fit.cpp from logged (ADC, true distance) pairs.
+ * The values below are the original shared parameters, used until each sensor is fitted.
+ *
+ */
+
+#ifndef ANALOG_DISTANCE_SENSOR_CALIBRATION_H_
+#define ANALOG_DISTANCE_SENSOR_CALIBRATION_H_
+
+// Right sensor (A17, P9.0)
+#define ANALOG_DISTANCE_SENSOR_CAL_RIGHT_A      1195159
+#define ANALOG_DISTANCE_SENSOR_CAL_RIGHT_B      -1058
+#define ANALOG_DISTANCE_SENSOR_CAL_RIGHT_C      40
+#define ANALOG_DISTANCE_SENSOR_CAL_RIGHT_MAX    2552
+
+// Center sensor (A14, P6.1)
+#define ANALOG_DISTANCE_SENSOR_CAL_CENTER_A     1195159
+#define ANALOG_DISTANCE_SENSOR_CAL_CENTER_B     -1058
+#define ANALOG_DISTANCE_SENSOR_CAL_CENTER_C     40
+#define ANALOG_DISTANCE_SENSOR_CAL_CENTER_MAX   2552
+
+// Left sensor (A16, P9.1)
+#define ANALOG_DISTANCE_SENSOR_CAL_LEFT_A       1195159
+#define ANALOG_DISTANCE_SENSOR_CAL_LEFT_B       -1058
+#define ANALOG_DISTANCE_SENSOR_CAL_LEFT_C       40
+#define ANALOG_DISTANCE_SENSOR_CAL_LEFT_MAX     2552
+
+#endif /* ANALOG_DISTANCE_SENSOR_CALIBRATION_H_ */
@@ -0,0 +1,91 @@
+/**
+ * @file Buzzer.h
+ * @brief Header file for the Buzzer driver.
+ *
+ * This file contains the function definitions for the piezo buzzer driver.
+ * The tone is generated in hardware by Timer A2 in PWM mode on P5.6 (PM_TA2.1), so the CPU does not
+ * toggle the pin. Melodies are stored as constant tables of notes and queued with Buzzer_Play.
+ * The TA2_0 interrupt, running at a low priority, counts the periods of the current note and loads
+ * the next one when it ends. It only updates a counter on most periods, so a melody costs
+ * a few hundred short interrupts per second while the robot keeps driving.
+ *
+ * @note This driver takes over Timer A2, so it cannot be used together with the Timer_A2_PWM
+ * or Timer_A2_Capture drivers.
+ *
+ * @note The piezo buzzer must be connected to P5.6, since P10.0 has no timer output function.
+ *
+ */
+
+#ifndef BUZZER_H_
+#define BUZZER_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Note frequencies in Hz
+#define BUZZER_REST         0
+#define BUZZER_NOTE_C4      262
+#define BUZZER_NOTE_D4      294
+#define BUZZER_NOTE_E4      330
+#define BUZZER_NOTE_F4      349
+#define BUZZER_NOTE_F4S     370
+#define BUZZER_NOTE_G4      392
+#define BUZZER_NOTE_A4      440
+#define BUZZER_NOTE_B4      494
+#define BUZZER_NOTE_C5      523
+
+// Maximum number of melodies waiting to be played
+#define BUZZER_QUEUE_SIZE   4
+
+// Silence at the end of each note in milliseconds, so that repeated notes can be heard separately
+#define BUZZER_NOTE_GAP     10
+
+/**
+ * @brief One note of a melody.
+ *
+ *  - frequency: Tone frequency in Hz, from 46 Hz to 20 kHz, or BUZZER_REST for a silent note
+ *  - duration:  Length of the note in milliseconds. Notes with a duration of 0 are skipped.
+ */
+typedef struct
+{
+    uint16_t frequency;
+    uint16_t duration;
+} Buzzer_Note;
+
+/**
+ * @brief Initializes the buzzer.
+ *
+ * This function configures P5.6 as the Timer A2 PWM output and the TA2_0 interrupt with priority 6.
+ * The timer stays halted until a melody is queued.
+ *
+ * @return None
+ */
+void Buzzer_Init(void);
+
+/**
+ * @brief Queues a melody. It starts when the previous melodies have been played.
+ *
+ * The notes are not copied, so the table must stay valid until it has been played (e.g. a const table).
+ *
+ * @param melody Pointer to the first note of the melody.
+ * @param count  The number of notes in the melody.
+ *
+ * @return 1 if the melody was queued, 0 if the queue is full.
+ */
+uint8_t Buzzer_Play(const Buzzer_Note *melody, uint16_t count);
+
+/**
+ * @brief Silences the buzzer and clears the melody queue.
+ *
+ * @return None
+ */
+void Buzzer_Stop(void);
+
+/**
+ * @brief Indicates whether a melody is being played.
+ *
+ * @return 1 if the buzzer is playing or has queued melodies, 0 otherwise.
+ */
+uint8_t Buzzer_Busy(void);
+
+#endif /* BUZZER_H_ */
@@ -0,0 +1,31 @@
+/**
+ * @file COBS.h
+ * @brief Header file for the COBS module.
+ *
+ * This file contains the function definitions for Consistent Overhead Byte Stuffing (COBS),
+ * which removes every 0x00 byte from a block of data at the cost of one byte per 254 bytes.
+ * The encoded block is followed by a 0x00 delimiter, so a receiver can find the start of the
+ * next frame after a transmission error.
+ *
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+
+// Size of the frame produced by COBS_Encode for a block of the given length, including the delimiter
+#define COBS_FRAME_SIZE(length)     ((length) + ((length) / 254) + 2)
+
+/**
+ * @brief Encodes a block of data as one delimited frame.
+ *
+ * @param data   Pointer to the data to encode.
+ * @param length The number of bytes to encode.
+ * @param frame  Pointer to the output, at least COBS_FRAME_SIZE(length) bytes.
+ *
+ * @return The number of bytes written to the frame, including the 0x00 delimiter.
+ */
+uint16_t COBS_Encode(const uint8_t *data, uint16_t length, uint8_t *frame);
+
+#endif /* COBS_H_ */
@@ -0,0 +1,144 @@
+/**
+ * @file DMA.h
+ * @brief Header file for the DMA driver.
+ *
+ * This file contains the function definitions for the DMA driver. It owns the control table of
+ * the MSP432 DMA controller and the DMA_INT0 interrupt, so that several drivers (e.g. UART_DMA)
+ * can use their own channels side by side.
+ *
+ * Each channel has a primary and an alternate control structure. A transfer is described by a
+ * control word built from the macros below, e.g. a byte transfer from a buffer to a register:
+ *
+ *  DMA_SIZE_8 | DMA_SRC_INC_8 | DMA_DST_INC_NONE | DMA_ARBITRATE_1 | DMA_MODE_BASIC
+ *
+ * The completion of every channel is signaled through DMA_INT0, which calls the task registered
+ * with DMA_Configure_Channel.
+ *
+ * For more information regarding the DMA controller, refer to the DMA section (11)
+ * of the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Number of DMA channels of the MSP432P401R
+#define DMA_NUM_CHANNELS        8
+
+// Maximum number of items in one control structure
+#define DMA_MAX_TRANSFER        1024
+
+// Size of the items, for both the source and the destination
+#define DMA_SIZE_8              0x00000000
+#define DMA_SIZE_16             0x11000000
+#define DMA_SIZE_32             0x22000000
+
+// Source address increment
+#define DMA_SRC_INC_8           0x00000000
+#define DMA_SRC_INC_16          0x04000000
+#define DMA_SRC_INC_32          0x08000000
+#define DMA_SRC_INC_NONE        0x0C000000
+
+// Destination address increment
+#define DMA_DST_INC_8           0x00000000
+#define DMA_DST_INC_16          0x40000000
+#define DMA_DST_INC_32          0x80000000
+#define DMA_DST_INC_NONE        0xC0000000
+
+// Number of items transferred for each request
+#define DMA_ARBITRATE_1         0x00000000
+#define DMA_ARBITRATE_4         0x00008000
+
+// Transfer modes
+#define DMA_MODE_BASIC          0x00000001
+#define DMA_MODE_AUTO           0x00000002
+#define DMA_MODE_PING_PONG      0x00000003
+
+// Trigger source 1 selects the eUSCI_A transmit flag on even channels
+// (channel 0: EUSCI_A0, channel 2: EUSCI_A1, channel 4: EUSCI_A2, channel 6: EUSCI_A3)
+#define DMA_SOURCE_EUSCI_A      0x01
+
+// Trigger source 7 of channel 7 is ADC14, at the end of a conversion or of a sequence
+#define DMA_SOURCE_ADC14        0x07
+
+/**
+ * @brief Channel control structure, as read by the DMA controller.
+ *
+ * The end pointers address the last item of the transfer.
+ */
+typedef struct
+{
+    volatile void *source_end;
+    volatile void *destination_end;
+    volatile uint32_t control;
+    volatile uint32_t spare;
+} DMA_Control_Block;
+
+/**
+ * @brief Enables the DMA controller and the DMA_INT0 interrupt.
+ *
+ * The DMA_INT0 interrupt is set to priority 3.
+ *
+ * @return None
+ */
+void DMA_Init();
+
+/**
+ * @brief Selects the trigger of a channel and the task called when the channel completes a transfer.
+ *
+ * @param channel The channel number, 0 to 7.
+ * @param source  The trigger source (see the device datasheet, Table 6-32).
+ * @param task    The function called from DMA_INT0 at the end of each transfer, or null.
+ *
+ * @return None
+ */
+void DMA_Configure_Channel(uint8_t channel, uint8_t source, void (*task)(void));
+
+/**
+ * @brief Fills the primary or alternate control structure of a channel.
+ *
+ * @param channel     The channel number, 0 to 7.
+ * @param alternate   0 for the primary structure, 1 for the alternate structure.
+ * @param source      Address of the first source item.
+ * @param destination Address of the first destination item.
+ * @param control     The control word, without the item count (DMA_SIZE_x | DMA_SRC_INC_x | ...).
+ * @param count       The number of items to transfer, 1 to DMA_MAX_TRANSFER.
+ *
+ * @return None
+ */
+void DMA_Set_Transfer(uint8_t channel, uint8_t alternate, volatile void *source, volatile void *destination, uint32_t control, uint16_t count);
+
+/**
+ * @brief Enables a channel, starting with its primary control structure.
+ *
+ * @param channel The channel number, 0 to 7.
+ *
+ * @return None
+ */
+void DMA_Enable_Channel(uint8_t channel);
+
+/**
+ * @brief Requests a transfer on a channel by software.
+ *
+ * This starts a channel whose hardware trigger is already set when the channel is enabled,
+ * such as the eUSCI transmit flag.
+ *
+ * @param channel The channel number, 0 to 7.
+ *
+ * @return None
+ */
+void DMA_Software_Trigger(uint8_t channel);
+
+/**
+ * @brief Checks whether a channel is still enabled.
+ *
+ * @param channel The channel number, 0 to 7.
+ *
+ * @return 1 if the channel has not completed its transfer, 0 otherwise.
+ */
+uint8_t DMA_Channel_Busy(uint8_t channel);
+
+#endif /* DMA_H_ */
@@ -9,6 +9,11 @@
  *
  * @note The pins P1.2 and P1.3 are used for UART communication via USB.
  *
+ * @note After EUSCI_A0_UART_Init_Buffered, transmission and reception are interrupt-driven through
+ * two ring buffers. EUSCI_A0_UART_OutChar and the helpers built on it (OutString, OutUDec, OutSDec, ...)
+ * then return immediately: characters that do not fit in the transmit buffer are dropped and counted
+ * instead of stalling the caller, so they can be used from the control loop and interrupt handlers.
+ *
  * @author Aaron Nanas
  *
  */
@@ -21,6 +26,12 @@
 #include "msp.h"
 #include "file.h"
 
+// Size of the transmit ring buffer in bytes (must be a power of two)
+#define EUSCI_A0_UART_TX_BUFFER_SIZE    256
+
+// Size of the receive ring buffer in bytes (must be a power of two)
+#define EUSCI_A0_UART_RX_BUFFER_SIZE    64
+
 /**
  * @brief Carriage return character
  */
@@ -70,11 +81,75 @@
  */
 void EUSCI_A0_UART_Init();
 
+/**
+ * @brief Initializes EUSCI_A0 for interrupt-driven communication through ring buffers.
+ *
+ * The UART configuration is the same as EUSCI_A0_UART_Init. In addition, the receive interrupt is enabled
+ * and the transmit interrupt is enabled whenever the transmit buffer holds data. The EUSCIA0 interrupt
+ * has priority 3.
+ *
+ * @return None
+ */
+void EUSCI_A0_UART_Init_Buffered();
+
+/**
+ * @brief Queues bytes for transmission without waiting.
+ *
+ * @param data  Pointer to the bytes to transmit.
+ * @param count The number of bytes to transmit.
+ *
+ * @return The number of bytes queued, from 0 to count. The remaining bytes can be passed again later.
+ *
+ * @note EUSCI_A0_UART_Init_Buffered must be called first.
+ */
+uint32_t EUSCI_A0_UART_Write_Buffer(const uint8_t *data, uint32_t count);
+
+/**
+ * @brief Copies received bytes without waiting.
+ *
+ * @param data Pointer to the buffer that receives the bytes.
+ * @param max  The maximum number of bytes to copy.
+ *
+ * @return The number of bytes copied, from 0 to max.
+ *
+ * @note EUSCI_A0_UART_Init_Buffered must be called first.
+ */
+uint32_t EUSCI_A0_UART_Read_Buffer(uint8_t *data, uint32_t max);
+
+/**
+ * @brief Returns the free space in the transmit buffer.
+ *
+ * @return The number of bytes that EUSCI_A0_UART_Write_Buffer can accept right now.
+ */
+uint32_t EUSCI_A0_UART_TX_Free();
+
+/**
+ * @brief Returns the number of received bytes waiting in the receive buffer.
+ *
+ * @return The number of bytes that EUSCI_A0_UART_Read_Buffer can return right now.
+ */
+uint32_t EUSCI_A0_UART_RX_Available();
+
+/**
+ * @brief Returns the number of characters dropped by EUSCI_A0_UART_OutChar because the transmit buffer was full.
+ *
+ * @return The number of dropped characters.
+ */
+uint32_t EUSCI_A0_UART_TX_Dropped();
+
+/**
+ * @brief Returns the number of received characters lost because the receive buffer was full.
+ *
+ * @return The number of lost characters.
+ */
+uint32_t EUSCI_A0_UART_RX_Overruns();
+
 /**
  * @brief The EUSCI_A0_UART_InChar function reads a character from the UART receive buffer.
  *
  * This function waits until a character is available in the UART receive buffer (EUSCI_A0)
  * from the serial terminal input and returns the received character as a char type.
+ * In buffered mode, it waits for a character in the receive ring buffer.
  *
  * @param None
  *
@@ -87,6 +162,7 @@ char EUSCI_A0_UART_InChar();
  *
  * This function waits until the UART transmit buffer (EUSCI_A0) is ready to accept
  * a new character and then writes the specified character in the transmit buffer to the serial terminal.
+ * In buffered mode, it queues the character without waiting, or drops it if the transmit ring buffer is full.
  *
  * @param letter The character to be transmitted to the serial terminal.
  *
@@ -292,6 +368,10 @@ int EUSCI_A0_UART_Rename(const char *old_name, const char *new_name);
  *
  * This function initializes the UART module (EUSCI_A0) for communication and configures it for printf output.
  * It adds the UART device to the device list, sets stdout to use the UART output, and turns off buffering for stdout.
+ * Calling EUSCI_A0_UART_Init_Buffered afterwards makes printf non-blocking.
+ *
+ * @note printf formats the text on the MCU. The LOG macro (Log.h) defers the formatting to the
+ *       host and can be used from interrupt handlers.
  *
  * @param None
  *
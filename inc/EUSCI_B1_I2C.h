@@ -3,7 +3,9 @@
  * @brief Header file for the EUSCI_B1_I2C driver.
  *
  * This file contains the function definitions for the EUSCI_B1_I2C driver.
- * The EUSCI_B1_I2C driver uses busy-wait implementation.
+ * The EUSCI_B1_I2C driver uses busy-wait implementation by default. After EUSCI_B1_I2C_Init_Queued,
+ * transactions are placed in a queue and run in the background by the EUSCI_B1 interrupt,
+ * which calls a completion function at the end of each transaction.
  *
  * @note This function assumes that the necessary pin configurations for I2C communication have been performed
  *       on the corresponding pins. The output from the pins will be observed using an oscilloscope.
@@ -23,6 +25,48 @@
 #include <stdint.h>
 #include "msp.h"
 
+// Number of transactions that can wait in the queue (must be a power of 2)
+#define EUSCI_B1_I2C_QUEUE_SIZE         8
+
+// Maximum number of bytes written by one queued transaction
+#define EUSCI_B1_I2C_MAX_WRITE_LENGTH   8
+
+/**
+ * @brief Result of a queued transaction, passed to its completion function.
+ */
+typedef enum
+{
+    EUSCI_B1_I2C_OK     = 0,
+    EUSCI_B1_I2C_NACK   = 1
+} EUSCI_B1_I2C_Status;
+
+/**
+ * @brief Descriptor of a queued transaction.
+ *
+ * The kind of transaction follows from the lengths:
+ *  - write_length > 0, read_length = 0:  START, address, write bytes, STOP
+ *  - write_length = 0, read_length > 0:  START, address, read bytes, STOP
+ *  - write_length > 0, read_length > 0:  START, address, write bytes, repeated START, address, read bytes, STOP
+ *
+ * With read_length = 1, the STOP condition is requested when the byte arrives, so the slave
+ * sends a second byte before the NACK and STOP. That byte stays in RXBUF with UCRXIFG0 set until
+ * the next transaction clears the flags, and the register pointer of the slave advances by one
+ * extra byte.
+ *
+ * The write bytes are copied into the queue, so the descriptor may be a local variable.
+ * The read buffer must stay valid until the transaction is done. The completion function
+ * (which may be null) is called from the EUSCI_B1 interrupt handler.
+ */
+typedef struct
+{
+    uint8_t slave_address;
+    uint8_t write_data[EUSCI_B1_I2C_MAX_WRITE_LENGTH];
+    uint8_t write_length;
+    uint8_t *read_data;
+    uint16_t read_length;
+    void (*done)(EUSCI_B1_I2C_Status status);
+} EUSCI_B1_I2C_Transaction;
+
 /**
  * @brief Initializes the I2C module EUSCI_B1 for communication.
  *
@@ -143,4 +187,64 @@ uint8_t EUSCI_B1_I2C_Receive_A_Byte(uint8_t slave_address);
  */
 void EUSCI_B1_I2C_Receive_Multiple_Bytes(uint8_t slave_address, uint8_t *data_buffer, uint16_t packet_length);
 
+/**
+ * @brief Initializes EUSCI_B1 and the queue of interrupt-driven transactions.
+ *
+ * This function calls EUSCI_B1_I2C_Init, clears the queue and enables the EUSCI_B1 interrupt
+ * (priority 2) in the NVIC. The busy-wait functions above must not be used afterwards.
+ *
+ * @return None
+ */
+void EUSCI_B1_I2C_Init_Queued();
+
+/**
+ * @brief Adds a transaction to the queue. Never waits.
+ *
+ * The transaction starts at once if the bus is idle, or after the transactions queued before it.
+ * This function may be called from any context, including completion functions.
+ *
+ * @param transaction Pointer to the descriptor of the transaction.
+ *
+ * @return 1 if the transaction was queued, or 0 if the queue is full or the descriptor is invalid.
+ */
+uint8_t EUSCI_B1_I2C_Queue(const EUSCI_B1_I2C_Transaction *transaction);
+
+/**
+ * @brief Returns whether a queued transaction is waiting or running.
+ *
+ * @return 1 while the queue is not empty, 0 otherwise.
+ */
+uint8_t EUSCI_B1_I2C_Busy();
+
+/**
+ * @brief Waits until every queued transaction is done.
+ *
+ * @note The transactions complete in the EUSCI_B1 interrupt, so this function must be called with
+ *       interrupts enabled, from the main program or from an interrupt handler whose priority is
+ *       lower than that of EUSCI_B1 (priority 3 or above in the NVIC). Otherwise it never returns.
+ *       The PRIMASK of the caller is left unchanged.
+ *
+ * @return None
+ */
+void EUSCI_B1_I2C_Wait();
+
+/**
+ * @brief Queues a transaction and waits until it is done.
+ *
+ * If the queue is full, this function first waits for the queued transactions to finish.
+ * The same restrictions as for EUSCI_B1_I2C_Wait apply.
+ *
+ * @param transaction Pointer to the descriptor of the transaction.
+ *
+ * @return None
+ */
+void EUSCI_B1_I2C_Transfer(const EUSCI_B1_I2C_Transaction *transaction);
+
+/**
+ * @brief Returns the number of queued transactions that were not acknowledged by the slave.
+ *
+ * @return The number of NACKs.
+ */
+uint32_t EUSCI_B1_I2C_Get_NACKs();
+
 #endif /* EUSCI_B1_I2C_H_ */
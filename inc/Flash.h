@@ -0,0 +1,68 @@
+/**
+ * @file Flash.h
+ * @brief Header file for the Flash driver.
+ *
+ * This file contains the function definitions for storing a small record in the information
+ * memory of the MSP432, so that it survives a reset or a power cycle (e.g. sensor calibration).
+ *
+ * Bank 0 sector 0 of the information memory (4 KB at 0x00200000) is used. The other information
+ * sectors hold the device descriptor (TLV) and the bootloader, and are never written.
+ *
+ * This sector is also the flash boot-override mailbox of the MSP432P401R: after a reset, the boot
+ * code parses it as a list of commands (e.g. factory reset, JTAG lock) only if its first word is
+ * the mailbox start word FLASH_INFO_MAILBOX_START. A record must therefore never start with that
+ * word, and Flash_Info_Write rejects it; a signature of the record's own is enough.
+ *
+ * A write erases the whole sector, so the record is replaced as a whole. A sector can be erased
+ * at least 20,000 times: records should be written when they change, not periodically.
+ *
+ * For more information regarding the flash controller, refer to the Flash Controller section (9)
+ * of the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#ifndef FLASH_H_
+#define FLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "msp.h"
+
+// Address and size of the information memory sector used for records
+#define FLASH_INFO_SECTOR_ADDRESS   0x00200000
+#define FLASH_INFO_SECTOR_SIZE      4096
+
+// First word of a flash boot-override mailbox (the boot code ignores the sector otherwise)
+#define FLASH_INFO_MAILBOX_START    0x0115ACF6
+
+// Start of the information memory as seen by the CPU (redirected on the host)
+#ifndef FLASH_INFO_MEMORY
+#define FLASH_INFO_MEMORY           ((volatile uint32_t *)FLASH_INFO_SECTOR_ADDRESS)
+#endif
+
+/**
+ * @brief Returns a pointer to the record stored in the information memory sector.
+ *
+ * The sector reads as 0xFF bytes when nothing was written. The caller is responsible for
+ * checking that the record is valid (e.g. with a signature and a checksum).
+ *
+ * @return Pointer to the start of the sector.
+ */
+const volatile void *Flash_Info_Read(void);
+
+/**
+ * @brief Erases the information memory sector and programs a record at its start.
+ *
+ * Blocks for the duration of the erase (a few ms) and of the programming. Interrupts stay
+ * enabled, but code executing from the same flash bank is stalled while it is busy.
+ *
+ * @param data   Pointer to the record.
+ * @param length The size of the record in bytes, up to FLASH_INFO_SECTOR_SIZE. It is rounded
+ *               up to a multiple of 4 bytes.
+ *
+ * @return true if the record was erased, programmed and read back without error, false if it
+ *         failed or if the record starts with FLASH_INFO_MAILBOX_START (nothing is written).
+ */
+bool Flash_Info_Write(const void *data, uint32_t length);
+
+#endif /* FLASH_H_ */
@@ -329,6 +329,4 @@ void LED_Controller(uint8_t button_status, uint8_t switch_status);
  */
 void P8_Init();
 
-void Note_Pattern_1(void);
-
 #endif /* GPIO_H_ */
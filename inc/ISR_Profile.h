@@ -0,0 +1,170 @@
+/**
+ * @file ISR_Profile.h
+ * @brief Header file for the ISR_Profile module.
+ *
+ * This file contains the function definitions for measuring interrupt handlers with the
+ * Cortex-M4 DWT cycle counter (CYCCNT). For each instrumented vector, the module records:
+ *  - Entry latency: MCLK cycles from the hardware event to the first instruction of the handler
+ *  - Execution time: MCLK cycles spent in the handler, including any handler that preempts it
+ *
+ * Each measurement updates a fixed-bucket histogram and the minimum, maximum and sum, from which
+ * ISR_Profile_Dump prints the mean and the share of the CPU used by each vector.
+ * All statistics are statically allocated.
+ *
+ * Profiling is enabled by defining ISR_PROFILE_ACTIVE for the whole project (e.g. -DISR_PROFILE_ACTIVE).
+ * Otherwise ISR_PROFILE_ENTER and ISR_PROFILE_EXIT expand to nothing and the functions below are
+ * empty inline functions, so the handlers compile exactly as without instrumentation.
+ *
+ * A handler is instrumented as follows:
+ *
+ *  void SysTick_Handler(void)
+ *  {
+ *      ISR_PROFILE_ENTER(ISR_PROFILE_SYSTICK_LATENCY());
+ *      ...
+ *      ISR_PROFILE_EXIT(ISR_PROFILE_SYSTICK);
+ *  }
+ *
+ * ISR_PROFILE_EXIT must be placed before every return statement of the handler.
+ *
+ * @note The latency of timer interrupts is derived from the timer count, so its resolution is
+ * one timer count (4 MCLK cycles for SMCLK divided by 1). Port, eUSCI and DMA interrupts have no
+ * hardware timestamp, so only their execution time is recorded.
+ *
+ * @note CYCCNT wraps around after about 89 seconds at 48 MHz. The CPU shares printed by
+ * ISR_Profile_Dump are only valid if ISR_Profile_Reset was called less than 89 seconds before.
+ *
+ */
+
+#ifndef ISR_PROFILE_H_
+#define ISR_PROFILE_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Number of histogram buckets. The last bucket also counts every larger value.
+#define ISR_PROFILE_BUCKETS         16
+
+// Width of the latency buckets: 2^3 = 8 cycles, covering 0 - 127 cycles
+#define ISR_PROFILE_LATENCY_SHIFT   3
+
+// Width of the execution time buckets: 2^7 = 128 cycles, covering 0 - 2047 cycles
+#define ISR_PROFILE_DURATION_SHIFT  7
+
+// Number of MCLK cycles in one SMCLK cycle (MCLK = 48 MHz, SMCLK = 12 MHz)
+#define ISR_PROFILE_SMCLK_CYCLES    4
+
+// Latency value for interrupts that have no hardware timestamp
+#define ISR_PROFILE_NO_LATENCY      0xFFFFFFFF
+
+/**
+ * @brief Instrumented interrupt vectors.
+ */
+typedef enum
+{
+    ISR_PROFILE_SYSTICK = 0,
+    ISR_PROFILE_TA1_0 = 1,
+    ISR_PROFILE_TA1_N = 2,
+    ISR_PROFILE_TA2_0 = 3,
+    ISR_PROFILE_TA3_0 = 4,
+    ISR_PROFILE_TA3_N = 5,
+    ISR_PROFILE_PORT4 = 6,
+    ISR_PROFILE_PORT6 = 7,
+    ISR_PROFILE_EUSCIA0 = 8,
+    ISR_PROFILE_EUSCIB1 = 9,
+    ISR_PROFILE_DMA_INT0 = 10,
+    ISR_PROFILE_VECTORS = 11
+} ISR_Profile_Vector;
+
+/**
+ * @brief Statistics of one measured quantity, in MCLK cycles.
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[ISR_PROFILE_BUCKETS];
+} ISR_Profile_Stats;
+
+#ifdef ISR_PROFILE_ACTIVE
+
+// Latency and execution time of each vector
+extern ISR_Profile_Stats ISR_Profile_Latency[ISR_PROFILE_VECTORS];
+extern ISR_Profile_Stats ISR_Profile_Duration[ISR_PROFILE_VECTORS];
+
+// Starts the measurement of a handler. Must be the first statement of the handler.
+#define ISR_PROFILE_ENTER(latency) \
+    uint32_t isr_profile_start = DWT->CYCCNT; \
+    uint32_t isr_profile_latency = (latency)
+
+// Ends the measurement of a handler and records it for the given vector
+#define ISR_PROFILE_EXIT(vector) \
+    ISR_Profile_Record((vector), isr_profile_latency, isr_profile_start)
+
+// Latency of the SysTick interrupt: cycles elapsed since the counter reloaded
+#define ISR_PROFILE_SYSTICK_LATENCY() \
+    (SysTick->LOAD - SysTick->VAL)
+
+// Latency of a Timer_A interrupt whose event occurred when the count was equal to event
+#define ISR_PROFILE_TIMER_LATENCY(timer, event) \
+    ISR_Profile_Timer_Latency((timer), (event))
+
+/**
+ * @brief Enables the DWT cycle counter and clears the statistics.
+ *
+ * @return None
+ */
+void ISR_Profile_Init(void);
+
+/**
+ * @brief Clears the statistics of every vector.
+ *
+ * @return None
+ */
+void ISR_Profile_Reset(void);
+
+/**
+ * @brief Records one measurement. Called by ISR_PROFILE_EXIT.
+ *
+ * @param vector  The instrumented vector.
+ * @param latency The entry latency in cycles, or ISR_PROFILE_NO_LATENCY.
+ * @param start   The value of CYCCNT when the handler started.
+ *
+ * @return None
+ */
+void ISR_Profile_Record(ISR_Profile_Vector vector, uint32_t latency, uint32_t start);
+
+/**
+ * @brief Computes the entry latency of a Timer_A interrupt from the current count.
+ *
+ * The timer must be clocked by SMCLK in Up or Continuous mode.
+ *
+ * @param timer Pointer to the Timer_A registers.
+ * @param event The count at which the interrupt flag was set (e.g. CCR[0] in Up mode, or the captured value).
+ *
+ * @return The latency in MCLK cycles, or ISR_PROFILE_NO_LATENCY if the timer configuration is not supported.
+ */
+uint32_t ISR_Profile_Timer_Latency(Timer_A_Type *timer, uint16_t event);
+
+/**
+ * @brief Prints the statistics and histograms of every vector that ran, using EUSCI_A0_UART.
+ *
+ * EUSCI_A0_UART_Init must be called first. This function waits for the transmission.
+ *
+ * @return None
+ */
+void ISR_Profile_Dump(void);
+
+#else
+
+#define ISR_PROFILE_ENTER(latency)
+#define ISR_PROFILE_EXIT(vector)
+
+static inline void ISR_Profile_Init(void) {}
+static inline void ISR_Profile_Reset(void) {}
+static inline void ISR_Profile_Dump(void) {}
+
+#endif /* ISR_PROFILE_ACTIVE */
+
+#endif /* ISR_PROFILE_H_ */
@@ -1,12 +1,18 @@
 /**
  * @file      LPF.h
- * @brief     implements three FIR low-pass filters
+ * @brief     implements FIR low-pass filters
  * @details   Finite length LPF<br>
- 1) Size is the depth 2 to 512<br>
+ 1) Each filter has its own depth, fixed when it is defined<br>
  2) y(n) = (sum(x(n)+x(n-1)+...+x(n-size-1))/size<br>
- 3) To use a filter<br>
-   a) initialize it once<br>
-   b) call the filter at the sampling rate<br>
+ 3) One filter holds any number of channels, all updated together<br>
+ 4) To use a filter<br>
+   a) define it once with LPF_FILTER<br>
+   b) initialize it once<br>
+   c) call the filter at the sampling rate<br>
+ 5) Example, filtering the three distance sensors over 16 samples<br>
+   LPF_FILTER(Distance_Filter, 16, 3);<br>
+   LPF_Init(&Distance_Filter, initial);<br>
+   LPF_Calc_Distance(&Distance_Filter, &Ch_17, &Ch_14, &Ch_16);<br>
  * @version   TI-RSLK MAX v1.1
  * @author    Daniel Valvano and Jonathan Valvano
  * @copyright Copyright 2019 by Jonathan W. Valvano, valvano@mail.utexas.edu,
@@ -55,92 +61,134 @@ policies, either expressed or implied, of the FreeBSD Project.
 */
 
 
+#ifndef LPF_H_
+#define LPF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
 /**
- * Initialize first LPF<br>
- * Set all data to an initial value<br>
- * @param initial value to preload into MACQ
- * @param size depth of the filter, 2 to 512
- * @return none
- * @note  all three filters share the same size
- * @brief  Initialize first LPF
+ * @details  State of one filter<br>
+ * The buffer holds the last size samples of each channel, interleaved:
+ * sample i of channel c is at buffer[i*channels + c].
+ * Samples are stored on 16 bits, enough for the 14-bit ADC results.
+ * The sums of the samples and of their squares over the window are
+ * updated with each sample, so the mean and the variance are O(1).
+ * Use LPF_FILTER to define a filter with its storage.
  */
-void LPF_Init(uint32_t initial, uint32_t size);
+typedef struct
+{
+    uint16_t *buffer;   // size*channels samples
+    uint32_t *sum;      // sum of the last size samples of each channel
+    uint64_t *squares;  // sum of the squares of the last size samples of each channel
+    uint32_t size;      // depth of the filter
+    uint32_t channels;  // number of channels
+    uint32_t index;     // index of the oldest sample
+} LPF_Filter;
 
 /**
- * First LPF, calculate one filter output<br>
- * Called at sampling rate
- * @param newdata new ADC data
- * @return result filter output
- * @brief  FIR low pass filter
+ * Places a variable in the .TI.noinit section, which the startup code
+ * does not zero. Used for the filter storage, which LPF_Init fills.
+ * Other compilers (and host builds) use the regular .bss section.
  */
-uint32_t LPF_Calc(uint32_t newdata);
+#ifdef __TI_COMPILER_VERSION__
+#define LPF_NOINIT __attribute__((noinit))
+#else
+#define LPF_NOINIT
+#endif
 
 /**
- * First LPF, calculate noise as standard deviation<br>
- * Called every time the buffer refills
- * @param none
- * @return standard deviation
- * @brief  calculate amount of random noise
+ * Defines a filter and its storage, sized for its depth and channels<br>
+ * Use at file scope; the filter is static to the file.
+ * The samples and sums are not initialized at reset: LPF_Init must be
+ * called before the first LPF_Calc.
+ * @param name name of the LPF_Filter variable
+ * @param size depth of the filter, 1 or more
+ * @param channels number of channels, 1 or more
+ * @brief  Define a filter
  */
-int32_t Noise(void);
+#define LPF_FILTER(name, size, channels) \
+    static uint16_t name##_Buffer[(size) * (channels)] LPF_NOINIT; \
+    static uint32_t name##_Sum[channels] LPF_NOINIT; \
+    static uint64_t name##_Squares[channels] LPF_NOINIT; \
+    static LPF_Filter name = {name##_Buffer, name##_Sum, name##_Squares, (size), (channels), 0}
 
 /**
- * Initialize second LPF<br>
- * Set all data to an initial value<br>
- * @param initial value to preload into MACQ
- * @param size depth of the filter, 2 to 512
+ * Initialize a filter<br>
+ * Set all data of all channels to an initial value
+ * @param filter pointer to the filter
+ * @param initial value to preload into MACQ, 0 to 65535
  * @return none
- * @note  all three filters share the same size
- * @brief  Initialize second LPF
+ * @brief  Initialize a LPF
  */
-void LPF_Init2(uint32_t initial, uint32_t size);
+void LPF_Init(LPF_Filter *filter, uint32_t initial);
 
 /**
- * Second LPF, calculate one filter output<br>
+ * Calculate one filter output of a single-channel filter<br>
  * Called at sampling rate
- * @param newdata new ADC data
+ * @param filter pointer to the filter, with one channel
+ * @param newdata new ADC data, 0 to 65535
  * @return result filter output
  * @brief  FIR low pass filter
  */
-uint32_t LPF_Calc2(uint32_t newdata);
+uint32_t LPF_Calc(LPF_Filter *filter, uint32_t newdata);
 
 /**
- * Second LPF, calculate noise as standard deviation<br>
- * Called every time the buffer refills
- * @param none
- * @return standard deviation
- * @brief  calculate amount of random noise
+ * Calculate one filter output for every channel<br>
+ * Called at sampling rate
+ * @param filter pointer to the filter
+ * @param newdata new ADC data, one value per channel, 0 to 65535
+ * @param result filter outputs, one value per channel (may be newdata)
+ * @return none
+ * @brief  FIR low pass filter, all channels
  */
-int32_t Noise2(void);
+void LPF_Calc_Channels(LPF_Filter *filter, const uint32_t *newdata, uint32_t *result);
 
 /**
- * Initialize third LPF<br>
- * Set all data to an initial value<br>
- * @param initial value to preload into MACQ
- * @param size depth of the filter, 2 to 512
+ * Calculate one filter output for the three distance sensors<br>
+ * Called at sampling rate, with the results of
+ * Analog_Distance_Sensor_Start_Conversion, which are replaced by the filter outputs.
+ * In DMA mode, Analog_Distance_Sensor_Get_Filtered feeds its own filter
+ * @param filter pointer to the filter, with three channels
+ * @param Ch_17 new A17 data, replaced by the channel 0 output
+ * @param Ch_14 new A14 data, replaced by the channel 1 output
+ * @param Ch_16 new A16 data, replaced by the channel 2 output
  * @return none
- * @note  all three filters share the same size
- * @brief  Initialize third LPF
+ * @brief  FIR low pass filter, three distance sensors
  */
-void LPF_Init3(uint32_t initial, uint32_t size);
+void LPF_Calc_Distance(LPF_Filter *filter, uint32_t *Ch_17, uint32_t *Ch_14, uint32_t *Ch_16);
 
 /**
- * Third LPF, calculate one filter output<br>
- * Called at sampling rate
- * @param newdata new ADC data
- * @return result filter output
- * @brief  FIR low pass filter
+ * Calculate the variance of one channel over the window<br>
+ * O(1): uses the running sums, may be called after every sample
+ * @param filter pointer to the filter
+ * @param channel channel number, 0 to channels-1
+ * @return sample variance, in ADC counts squared (0 if size < 2)
+ * @brief  calculate variance of the random noise
  */
-uint32_t LPF_Calc3(uint32_t newdata);
+uint32_t LPF_Variance(const LPF_Filter *filter, uint32_t channel);
 
 /**
- * Third LPF, calculate noise as standard deviation<br>
- * Called every time the buffer refills
- * @param none
- * @return standard deviation
+ * Calculate noise of one channel as standard deviation<br>
+ * O(1): uses the running sums, may be called after every sample
+ * @param filter pointer to the filter
+ * @param channel channel number, 0 to channels-1
+ * @return standard deviation, in ADC counts
  * @brief  calculate amount of random noise
  */
-int32_t Noise3(void);
+int32_t LPF_Noise(const LPF_Filter *filter, uint32_t channel);
+
+/**
+ * Check the signal-to-noise ratio of one channel<br>
+ * O(1), without square root: compares mean^2 with snr^2*variance,
+ * e.g. to reject a distance sensor blinded by sunlight
+ * @param filter pointer to the filter
+ * @param channel channel number, 0 to channels-1
+ * @param snr minimum ratio of the mean to the standard deviation, 1 to 65535
+ * @return true if mean/sigma is less than snr
+ * @brief  check amount of random noise
+ */
+bool LPF_Is_Noisy(const LPF_Filter *filter, uint32_t channel, uint32_t snr);
 
 /**
  * 3-wide non recursive Median filter <br>
@@ -152,9 +200,11 @@ int32_t Noise3(void);
 int32_t Median(int32_t newdata);
 
 /**
- * Newton's method square root
+ * Integer square root, one result bit per iteration, no division
  * @param s is an integer
- * @return is an integer
+ * @return is an integer, floor(sqrt(s))
  * @brief  square root
  */
 uint32_t isqrt(uint32_t s);
+
+#endif /* LPF_H_ */
@@ -0,0 +1,124 @@
+/**
+ * @file Log.h
+ * @brief Header file for the Log module.
+ *
+ * This file contains the function definitions for deferred (tokenized) logging. The LOG macro
+ * does not format anything on the MCU: it stores the address of its format string, the DWT cycle
+ * count and up to four raw 32-bit arguments in a ring buffer, which takes a few dozen cycles
+ * and may be done from any interrupt handler. Log_Task later sends each record on EUSCI_A0 as
+ * a COBS frame, and host/Log_Render.cpp prints the text on a workstation.
+ *
+ *  LOG("Bump: sensors 0x%02X", bumper_sensor_state);
+ *  LOG("State %d -> %d at position %d", previous_state, current_state, Line_Sensor_Position);
+ *
+ * The format strings are placed in the .log_strings section, which the linker command file keeps
+ * in the output file for the renderer but never loads into flash. The address of a string is
+ * its ID, so the table of strings is produced by the build itself.
+ *
+ * Logging is enabled by defining LOG_ACTIVE for the whole project (e.g. -DLOG_ACTIVE).
+ * Otherwise LOG expands to an empty statement and the functions below are empty inline functions.
+ *
+ * Each frame holds, little-endian:
+ *
+ *  Offset  Size  Field
+ *  0       4     Format string address (0 for a report of dropped records)
+ *  4       4     DWT cycle count (MCLK cycles, wraps around after about 89 seconds at 48 MHz)
+ *  8       4*n   Arguments (n = 0 to 4)
+ *
+ * @note Arguments are sent as 32-bit integers, so the format strings may use the d, i, u, x, X,
+ *       o and c conversions (with flags, width and precision), but not s, f or the length modifiers.
+ *
+ * @note EUSCI_A0_UART_Init_Buffered must be called before Log_Init. Other output on EUSCI_A0
+ *       (telemetry, ISR_Profile_Dump) must not be used while logging is active.
+ *
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Size of the ring buffer in 32-bit words (must be a power of 2)
+#define LOG_BUFFER_WORDS    256
+
+// Maximum number of arguments of one record
+#define LOG_MAX_ARGUMENTS   4
+
+#ifdef LOG_ACTIVE
+
+// Places a format string in the .log_strings section
+#define LOG_STRING(format) \
+    static const char log_format[] __attribute__((section(".log_strings"), used)) = format
+
+// Selects LOG_0 to LOG_4 according to the number of arguments after the format string
+#define LOG_SELECT(_1, _2, _3, _4, _5, name, ...) name
+#define LOG(...) LOG_SELECT(__VA_ARGS__, LOG_4, LOG_3, LOG_2, LOG_1, LOG_0, )(__VA_ARGS__)
+
+#define LOG_0(format) \
+    do { LOG_STRING(format); Log_Write((uint32_t)(uintptr_t)log_format, 0, 0); } while (0)
+
+#define LOG_1(format, a) \
+    do { LOG_STRING(format); Log_Write((uint32_t)(uintptr_t)log_format, 1, \
+         (const uint32_t[]){(uint32_t)(a)}); } while (0)
+
+#define LOG_2(format, a, b) \
+    do { LOG_STRING(format); Log_Write((uint32_t)(uintptr_t)log_format, 2, \
+         (const uint32_t[]){(uint32_t)(a), (uint32_t)(b)}); } while (0)
+
+#define LOG_3(format, a, b, c) \
+    do { LOG_STRING(format); Log_Write((uint32_t)(uintptr_t)log_format, 3, \
+         (const uint32_t[]){(uint32_t)(a), (uint32_t)(b), (uint32_t)(c)}); } while (0)
+
+#define LOG_4(format, a, b, c, d) \
+    do { LOG_STRING(format); Log_Write((uint32_t)(uintptr_t)log_format, 4, \
+         (const uint32_t[]){(uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)}); } while (0)
+
+/**
+ * @brief Enables the DWT cycle counter used for the timestamps and clears the ring buffer.
+ *
+ * @return None
+ */
+void Log_Init(void);
+
+/**
+ * @brief Adds a record to the ring buffer. Called by the LOG macro.
+ *
+ * The record is dropped if the ring buffer is full. This function may be called from any context.
+ *
+ * @param id        The address of the format string.
+ * @param count     The number of arguments, 0 to LOG_MAX_ARGUMENTS.
+ * @param arguments Pointer to the arguments.
+ *
+ * @return None
+ */
+void Log_Write(uint32_t id, uint32_t count, const uint32_t *arguments);
+
+/**
+ * @brief Sends the buffered records through the EUSCI_A0 transmit ring. Never waits.
+ *
+ * Records that do not fit in the transmit ring stay in the log buffer until the next call.
+ * A record reporting the number of dropped records is sent after records were dropped.
+ *
+ * @return None
+ */
+void Log_Task(void);
+
+/**
+ * @brief Returns the number of records dropped because the ring buffer was full.
+ *
+ * @return The number of dropped records.
+ */
+uint32_t Log_Get_Dropped(void);
+
+#else
+
+#define LOG(...) do { } while (0)
+
+static inline void Log_Init(void) {}
+static inline void Log_Task(void) {}
+static inline uint32_t Log_Get_Dropped(void) { return 0; }
+
+#endif /* LOG_ACTIVE */
+
+#endif /* LOG_H_ */
@@ -69,6 +69,9 @@ typedef union
  * interrupt reporting. Ensure that the required hardware and peripheral configurations are
  * in place before calling this function.
  *
+ * @note The registers are accessed through the queue of EUSCI_B1 transactions, so
+ *       EUSCI_B1_I2C_Init_Queued must be called first.
+ *
  * @note The OPT3001_Config structure defines the sensor's configuration parameters and should be
  *     correctly initialized before calling this function.
  *
@@ -94,3 +97,16 @@ void OPT3001_Init();
  * @return An OPT3001_Result structure containing the raw light intensity data.
  */
 OPT3001_Result OPT3001_Read_Light(void);
+
+/**
+ * @brief Starts reading the light intensity in the background.
+ *
+ * This function queues the read of the Result register and returns without waiting for the bus.
+ * The completion function is called from the EUSCI_B1 interrupt handler with the same data that
+ * OPT3001_Read_Light returns. It is not called if the sensor does not acknowledge.
+ *
+ * @param done The function that receives the result.
+ *
+ * @return 1 if the read was queued, or 0 if a read is already in progress or the queue is full.
+ */
+uint8_t OPT3001_Request_Light(void (*done)(OPT3001_Result result));
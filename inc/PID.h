@@ -0,0 +1,121 @@
+/**
+ * @file PID.h
+ * @brief Header file for the PID controller module.
+ *
+ * This file contains the function definitions for a fixed-point PID controller.
+ * Every controller keeps its own state in a PID_Controller structure, so several
+ * loops (e.g. line following and wheel speed) can run side by side.
+ *
+ * Gains and internal state use the Q16.16 fixed-point format: a value x is stored
+ * as the 32-bit integer x * 65536. Use PID_Q16() to convert constants at compile time.
+ * Only integer multiply, add and shift instructions are used, so the update is cheap
+ * enough to run every 1 ms tick of the scheduler: the line follower calls it from
+ * Motor_Control_Task, in thread mode, dispatched by the Timer A1 scheduler.
+ *
+ * The controller provides:
+ *  - Integral clamping and conditional integration (anti-windup) while the output saturates
+ *  - Derivative on the measurement, which avoids a kick when the setpoint changes
+ *  - A first-order low-pass filter on the derivative term
+ *  - Output saturation to a caller-defined range
+ *
+ */
+
+#ifndef PID_H_
+#define PID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The value 1.0 in Q16.16 fixed-point format
+#define PID_Q16_ONE         65536
+
+// Converts a constant to Q16.16 fixed-point format, rounded to the nearest value
+#define PID_Q16(x)          ((int32_t)((x) * 65536.0 + (((x) >= 0) ? 0.5 : -0.5)))
+
+/**
+ * @brief State and configuration of one PID controller.
+ *
+ * Gains, the integral and the filtered derivative are in Q16.16 format. The integral and the
+ * derivative are kept in 64 bits, so any 32-bit output or integral limit can be used.
+ * Limits, setpoint, measurement and output are plain integers in the units of the plant.
+ */
+typedef struct
+{
+    int32_t Kp;
+    int32_t Ki;
+    int32_t Kd;
+    int32_t derivative_alpha;
+    int32_t output_min;
+    int32_t output_max;
+    int32_t integral_min;
+    int32_t integral_max;
+    int64_t integral;
+    int64_t derivative;
+    int32_t previous_measurement;
+    bool first_update;
+} PID_Controller;
+
+/**
+ * @brief Initializes a PID controller.
+ *
+ * The integral limits default to the output limits and the derivative filter is disabled.
+ *
+ * @param pid        Pointer to the controller instance.
+ * @param kp         Proportional gain in Q16.16 format.
+ * @param ki         Integral gain per update in Q16.16 format.
+ * @param kd         Derivative gain per update in Q16.16 format.
+ * @param output_min The minimum value returned by PID_Update.
+ * @param output_max The maximum value returned by PID_Update.
+ *
+ * @return None
+ */
+void PID_Init(PID_Controller *pid, int32_t kp, int32_t ki, int32_t kd, int32_t output_min, int32_t output_max);
+
+/**
+ * @brief Sets the range of the integral term.
+ *
+ * @param pid          Pointer to the controller instance.
+ * @param integral_min The minimum contribution of the integral term, in output units.
+ * @param integral_max The maximum contribution of the integral term, in output units.
+ *
+ * @return None
+ */
+void PID_Set_Integral_Limits(PID_Controller *pid, int32_t integral_min, int32_t integral_max);
+
+/**
+ * @brief Sets the smoothing factor of the derivative low-pass filter.
+ *
+ * The filtered derivative is updated as D = D + alpha * (D_new - D).
+ *
+ * @param pid   Pointer to the controller instance.
+ * @param alpha Smoothing factor in Q16.16 format, from 1 (heaviest filtering) to PID_Q16_ONE (no filtering).
+ *
+ * @return None
+ */
+void PID_Set_Derivative_Filter(PID_Controller *pid, int32_t alpha);
+
+/**
+ * @brief Clears the integral and derivative state of a controller.
+ *
+ * The next call to PID_Update uses its measurement as the previous measurement.
+ *
+ * @param pid Pointer to the controller instance.
+ *
+ * @return None
+ */
+void PID_Reset(PID_Controller *pid);
+
+/**
+ * @brief Computes one PID update.
+ *
+ * This function should be called at a fixed rate, since Ki and Kd are expressed per update.
+ *
+ * @param pid         Pointer to the controller instance.
+ * @param setpoint    The desired value.
+ * @param measurement The measured value.
+ *
+ * @return The controller output, saturated to [output_min, output_max].
+ */
+int32_t PID_Update(PID_Controller *pid, int32_t setpoint, int32_t measurement);
+
+#endif /* PID_H_ */
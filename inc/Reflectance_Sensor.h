@@ -40,6 +40,48 @@
 #include <stdint.h>
 #include "msp.h"
 #include "../inc/Clock.h"
+#include "../inc/Timer_A1_Interrupt.h"
+
+/**
+ * @brief Intersection classes reported by Reflectance_Sensor_Table.
+ *
+ *  - REFLECTANCE_LINE_NONE:          No sensor is active (dead end or off the track)
+ *  - REFLECTANCE_LINE_TRACK:         A line segment that is not an intersection
+ *  - REFLECTANCE_LINE_RIGHT_BRANCH:  The four rightmost sensors (P7.0 - P7.3) are active
+ *  - REFLECTANCE_LINE_LEFT_BRANCH:   The four leftmost sensors (P7.4 - P7.7) are active
+ *  - REFLECTANCE_LINE_CROSS:         All eight sensors are active
+ */
+typedef enum
+{
+    REFLECTANCE_LINE_NONE           = 0,
+    REFLECTANCE_LINE_TRACK          = 1,
+    REFLECTANCE_LINE_RIGHT_BRANCH   = 2,
+    REFLECTANCE_LINE_LEFT_BRANCH    = 3,
+    REFLECTANCE_LINE_CROSS          = 4
+} Reflectance_Sensor_Line_Class;
+
+/**
+ * @brief Precomputed information about one 8-bit sensor reading.
+ *
+ *  - position:     Same value as Reflectance_Sensor_Position(), in 0.1mm
+ *  - count:        Number of active sensors
+ *  - line_class:   Intersection class (Reflectance_Sensor_Line_Class)
+ */
+typedef struct
+{
+    int16_t position;
+    uint8_t count;
+    uint8_t line_class;
+} Reflectance_Sensor_Line;
+
+/**
+ * @brief Lookup table indexed by [shifted][data].
+ *
+ * Reflectance_Sensor_Table[0][data] describes the reading as it is.
+ * Reflectance_Sensor_Table[1][data] describes the reading shifted right by one bit,
+ * which is used to ignore the leftmost sensor while turning.
+ */
+extern const Reflectance_Sensor_Line Reflectance_Sensor_Table[2][256];
 
 /**
  * @brief Initializes the 8-Channel QTRX Sensor Array module.
@@ -98,9 +140,54 @@ uint8_t Reflectance_Sensor_Center(uint32_t time);
  * @param data 8-bit result from the line sensor.
  *
  * @return Position in 0.1mm relative to the center of the line.
+ *
+ * @note The position is read from Reflectance_Sensor_Table, which is computed at compile time.
  */
 int32_t Reflectance_Sensor_Position(uint8_t data);
 
+/**
+ * @brief Measures the decay time of each of the eight sensors from the 8-Channel QTRX Sensor Array module.
+ *
+ * The QTRX output decays slowly over a dark surface and quickly over a reflective one, so the
+ * decay time is a grayscale reflectance value. P7 has no interrupt capability, so the decay is
+ * timed with repeated snapshots of P7->IN:
+ *  1. Turns on the 8 IR LEDs.
+ *  2. Pulses the 8 sensors high for 10 microseconds.
+ *  3. Makes the sensor pins input.
+ *  4. Reads the sensors every step microseconds and records when each one goes low.
+ *  5. Turns off the 8 IR LEDs.
+ *
+ * The function returns as soon as every sensor has decayed, or after max_time microseconds.
+ *
+ * @param decay_time Array of 8 values that receives the decay time of each sensor in microseconds,
+ *                   ordered like Weight[] (index 0 is P7.0). Sensors that have not decayed report max_time.
+ * @param step       The time between snapshots in microseconds (the resolution of decay_time), 1 or more.
+ *                   A step of 0 is read as 1.
+ * @param max_time   The longest time to wait for the sensors to decay in microseconds. The last snapshot
+ *                   is taken at max_time, so decay_time never exceeds it and fits in 16 bits.
+ *
+ * @return Sensor readings at the end of the measurement (8-bit value). "1" indicates black, while "0" indicates white.
+ *
+ * @note Assumes that Reflectance_Init() has been called to initialize the sensor module.
+ *
+ * @note The CPU is busy for up to max_time microseconds.
+ */
+uint8_t Reflectance_Sensor_Read_Grayscale(uint16_t *decay_time, uint16_t step, uint16_t max_time);
+
+/**
+ * @brief Calculates the line position from the decay time of each sensor.
+ *
+ * Each sensor contributes its weight in proportion to how much longer than white_time it took
+ * to decay, so the position is interpolated between sensors instead of taking one of the values
+ * returned by Reflectance_Sensor_Position().
+ *
+ * @param decay_time Array of 8 decay times in microseconds from Reflectance_Sensor_Read_Grayscale().
+ * @param white_time The decay time of a sensor over a white surface in microseconds.
+ *
+ * @return Position in 0.1mm relative to the center of the line, or Weight[0] + 1 if no sensor is darker than white.
+ */
+int32_t Reflectance_Sensor_Grayscale_Position(const uint16_t *decay_time, uint16_t white_time);
+
 /**
  * @brief Begins the process of reading the eight sensors from the 8-Channel QTRX Sensor Array module.
  *
@@ -126,4 +213,31 @@ void Reflectance_Sensor_Start();
  */
 uint8_t Reflectance_Sensor_End();
 
+/**
+ * @brief Starts a non-blocking read of the eight sensors from the 8-Channel QTRX Sensor Array module.
+ *
+ * This function performs the same sequence as Reflectance_Sensor_Read(), but the waits are
+ * timed by one-shot Timer A1 compare interrupts instead of busy-wait delays:
+ *  1. Turns on the 8 IR LEDs and drives the 8 sensors high, then returns.
+ *  2. After charge_time, makes the sensor pins input.
+ *  3. After decay_time, reads the sensors, turns off the 8 IR LEDs and calls the task with the reading.
+ *
+ * @param charge_time The time to drive the sensors high in microseconds (at least 10 us).
+ * @param decay_time  The time to wait before reading the sensors in microseconds.
+ * @param task        The function that receives the sensor readings. "1" indicates black, while "0" indicates white.
+ *                    It is called from TA1_N_IRQHandler.
+ *
+ * @return 1 if the read was started, or 0 if a previous read is still in progress.
+ *
+ * @note Assumes that Reflectance_Init() and Timer_A1_Interrupt_Init() have been called.
+ */
+uint8_t Reflectance_Sensor_Sample_Start(uint16_t charge_time, uint16_t decay_time, void(*task)(uint8_t data));
+
+/**
+ * @brief Indicates whether a read started with Reflectance_Sensor_Sample_Start() is in progress.
+ *
+ * @return 1 if the read is in progress, 0 otherwise.
+ */
+uint8_t Reflectance_Sensor_Sample_Busy();
+
 #endif /* REFLECTANCE_SENSOR_H_ */
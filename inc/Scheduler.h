@@ -0,0 +1,113 @@
+/**
+ * @file Scheduler.h
+ * @brief Header file for the Scheduler module.
+ *
+ * This file contains the function definitions for a time-triggered cooperative task scheduler.
+ * Tasks are listed in a static table with a period, a phase offset and a priority. The Timer A1
+ * periodic interrupt (1 kHz) is the only timebase: on each tick, Scheduler_Tick releases the tasks
+ * that are due. Scheduler_Dispatch, called from the main loop, runs the released tasks to completion
+ * in priority order and puts the CPU to sleep when nothing is left to run.
+ *
+ * For each task the scheduler records the number of runs, the worst-case and total execution time,
+ * and the number of deadline misses. The deadline of a task is its next release: a miss is counted
+ * when a task completes after its deadline or is still waiting when it is released again.
+ *
+ * Times are measured with the Timer A1 count, in units of 1 / TIMER_A1_TICKS_PER_US microseconds.
+ * The one-shot compare channel of Timer A1 (Timer_A1_Compare_Start) can still be used.
+ *
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Number of Timer A1 counts in one scheduler tick (1 ms)
+#define SCHEDULER_TICK_COUNTS   12000
+
+/**
+ * @brief One entry of the task table.
+ *
+ * Only the first four fields are set in the table; the others are maintained by the scheduler.
+ *
+ *  - task:       Function that runs to completion each time the task is released
+ *  - period:     Number of ticks between releases
+ *  - phase:      Tick of the first release, used to spread tasks that share a period
+ *  - priority:   Tasks released in the same tick run in increasing order of priority (0 first)
+ *  - countdown:  Ticks until the next release
+ *  - pending:    Set when the task is released, cleared when it starts
+ *  - release:    Time of the latest release
+ *  - runs:       Number of completed runs
+ *  - misses:     Number of deadline misses
+ *  - wcet:       Worst-case execution time
+ *  - busy:       Total execution time
+ */
+typedef struct
+{
+    void (*task)(void);
+    uint16_t period;
+    uint16_t phase;
+    uint8_t priority;
+    uint16_t countdown;
+    volatile uint8_t pending;
+    uint32_t release;
+    uint32_t runs;
+    uint32_t misses;
+    uint32_t wcet;
+    uint64_t busy;
+} Scheduler_Task;
+
+/**
+ * @brief Initializes the scheduler and starts its timebase.
+ *
+ * This function initializes Timer A1 with a periodic interrupt at a rate of 1 kHz,
+ * so Timer_A1_Interrupt_Init must not be called separately.
+ *
+ * @param tasks Pointer to the task table.
+ * @param count The number of tasks in the table.
+ *
+ * @return None
+ */
+void Scheduler_Init(Scheduler_Task *tasks, uint8_t count);
+
+/**
+ * @brief Runs every released task in priority order, then sleeps until the next interrupt.
+ *
+ * This function should be called repeatedly from the main loop.
+ *
+ * @return None
+ */
+void Scheduler_Dispatch(void);
+
+/**
+ * @brief Returns the number of ticks since Scheduler_Init.
+ *
+ * @return The tick counter.
+ */
+uint32_t Scheduler_Get_Ticks(void);
+
+/**
+ * @brief Returns the current time in Timer A1 counts. It wraps around after about 358 seconds.
+ *
+ * @return The time since Scheduler_Init, in units of 1 / TIMER_A1_TICKS_PER_US microseconds.
+ */
+uint32_t Scheduler_Get_Time(void);
+
+/**
+ * @brief Returns the share of the CPU used by a task since the statistics were last cleared.
+ *
+ * @param index The position of the task in the table.
+ *
+ * @return The CPU load in units of 0.01% (10000 = 100%).
+ */
+uint32_t Scheduler_Get_Load(uint8_t index);
+
+/**
+ * @brief Clears the run counts, deadline misses and execution times of every task.
+ *
+ * @return None
+ */
+void Scheduler_Clear_Stats(void);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,92 @@
+/**
+ * @file Sequencer.h
+ * @brief Header file for the Sequencer module.
+ *
+ * This file contains the function definitions for a timed action sequencer.
+ * A sequence is a static table of steps. Each step calls an action function when it begins
+ * (e.g. stop, reverse or turn the motors) and then lasts for a fixed number of ticks.
+ * Sequencer_Tick is called at a fixed rate (from a periodic interrupt or a scheduler task),
+ * so a sequence never blocks the CPU.
+ *
+ * Sequencer_Start only records a request, so it can be called from an interrupt
+ * (e.g. the bumper sensors) that preempts the context calling Sequencer_Tick. Every action then
+ * runs in the context that calls Sequencer_Tick.
+ *
+ */
+
+#ifndef SEQUENCER_H_
+#define SEQUENCER_H_
+
+#include <stdint.h>
+
+/**
+ * @brief One step of a sequence.
+ *
+ *  - action:   Function called when the step begins, or null
+ *  - duration: Number of ticks before the next step begins. Steps with a duration of 0 take no time.
+ */
+typedef struct
+{
+    void (*action)(void);
+    uint16_t duration;
+} Sequencer_Step;
+
+/**
+ * @brief State of one sequencer.
+ */
+typedef struct
+{
+    const Sequencer_Step *steps;
+    uint8_t count;
+    uint8_t index;
+    uint16_t remaining;
+    uint8_t active;
+    volatile uint8_t start_request;
+    void (*done)(void);
+} Sequencer;
+
+/**
+ * @brief Initializes a sequencer with its table of steps.
+ *
+ * @param sequencer Pointer to the sequencer.
+ * @param steps     Pointer to the table of steps.
+ * @param count     The number of steps in the table.
+ * @param done      Function called after the last step, or null.
+ *
+ * @return None
+ */
+void Sequencer_Init(Sequencer *sequencer, const Sequencer_Step *steps, uint8_t count, void(*done)(void));
+
+/**
+ * @brief Requests the sequence to start from its first step.
+ *
+ * The first step begins on the next call to Sequencer_Tick. If the sequence is already running,
+ * it restarts from the first step.
+ *
+ * @param sequencer Pointer to the sequencer.
+ *
+ * @return None
+ */
+void Sequencer_Start(Sequencer *sequencer);
+
+/**
+ * @brief Advances the sequence by one tick.
+ *
+ * This function should be called at a fixed rate.
+ *
+ * @param sequencer Pointer to the sequencer.
+ *
+ * @return 1 if the sequence is running, 0 if it is idle or has just finished.
+ */
+uint8_t Sequencer_Tick(Sequencer *sequencer);
+
+/**
+ * @brief Indicates whether a sequence is running or about to start.
+ *
+ * @param sequencer Pointer to the sequencer.
+ *
+ * @return 1 if the sequence is running or has been requested, 0 otherwise.
+ */
+uint8_t Sequencer_Active(Sequencer *sequencer);
+
+#endif /* SEQUENCER_H_ */
@@ -0,0 +1,73 @@
+/**
+ * @file Snapshot.h
+ * @brief Header file for the Snapshot module.
+ *
+ * This file contains the function definitions for a single-writer / multi-reader channel
+ * used to exchange small frames (e.g. motor duty cycles and the FSM state) between
+ * interrupt handlers and the main loop without disabling interrupts.
+ *
+ * The channel holds two copies of the frame, each with a sequence counter:
+ *  - The writer fills the copy that is not published, then publishes it. It never waits.
+ *  - A reader copies the published frame and checks that its sequence counter did not change
+ *    during the copy. If the writer preempted the reader and rewrote that copy, the reader
+ *    copies the newly published frame again. A reader that preempts the writer always finds
+ *    a complete frame, so it never waits for the writer.
+ *
+ * @note Only one context may call Snapshot_Write for a given channel.
+ *
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stdint.h>
+
+// Largest frame that can be exchanged through a channel, in bytes
+#define SNAPSHOT_MAX_SIZE   16
+
+/**
+ * @brief State of one snapshot channel.
+ */
+typedef struct
+{
+    volatile uint32_t sequence[2];
+    volatile uint32_t number[2];
+    volatile uint32_t published;
+    volatile uint8_t frame[2][SNAPSHOT_MAX_SIZE];
+    uint32_t size;
+} Snapshot_Channel;
+
+/**
+ * @brief Initializes a snapshot channel with its first frame.
+ *
+ * @param channel Pointer to the channel.
+ * @param initial Pointer to the initial frame.
+ * @param size    The size of the frame in bytes, up to SNAPSHOT_MAX_SIZE.
+ *
+ * @return None
+ */
+void Snapshot_Init(Snapshot_Channel *channel, const void *initial, uint32_t size);
+
+/**
+ * @brief Publishes a new frame. Wait-free.
+ *
+ * @param channel Pointer to the channel.
+ * @param frame   Pointer to the frame to publish.
+ *
+ * @return None
+ */
+void Snapshot_Write(Snapshot_Channel *channel, const void *frame);
+
+/**
+ * @brief Copies the most recently published frame.
+ *
+ * The copy is never a mix of two frames.
+ *
+ * @param channel Pointer to the channel.
+ * @param frame   Pointer to the buffer that receives the frame.
+ *
+ * @return The number of the frame that was copied (1 for the first Snapshot_Write), which can be used to detect a new frame.
+ */
+uint32_t Snapshot_Read(Snapshot_Channel *channel, void *frame);
+
+#endif /* SNAPSHOT_H_ */
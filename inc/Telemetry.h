@@ -0,0 +1,117 @@
+/**
+ * @file Telemetry.h
+ * @brief Header file for the Telemetry module.
+ *
+ * This file contains the function definitions for a binary telemetry stream of the line follower
+ * state. Records are pushed from the line sensor handler into a fixed-size queue and sent on
+ * EUSCI_A0 by Telemetry_Task through the UART_DMA driver, so logging does not block the control loop.
+ *
+ * Each record is sent as one frame:
+ *
+ *  COBS(payload | CRC) 0x00
+ *
+ * The payload is TELEMETRY_PAYLOAD_SIZE bytes, little-endian:
+ *
+ *  Offset  Size  Field
+ *  0       1     Format version (TELEMETRY_VERSION)
+ *  1       2     Sequence number, incremented for every record pushed (including dropped records)
+ *  3       4     Time in milliseconds (scheduler ticks)
+ *  7       1     Line sensor data
+ *  8       1     Line follower state
+ *  9       2     Line sensor position (signed)
+ *  11      2     PID output (signed)
+ *  13      2     Left motor duty cycle
+ *  15      2     Right motor duty cycle
+ *
+ * The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the payload,
+ * sent little-endian. Consistent Overhead Byte Stuffing (COBS) removes every 0x00 from the frame,
+ * so a receiver can resynchronize on the next 0x00 after an error. Fields are only appended in
+ * later versions of the format, so a decoder can read the known fields of a newer record.
+ *
+ * host/Telemetry_Decoder.h decodes a capture of the stream on a workstation.
+ *
+ * @note Telemetry_Init requires EUSCI_A0_UART_Init to be called first. Other output on
+ *       EUSCI_A0 (printf, ISR_Profile_Dump) must not be used while telemetry is active.
+ *
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+// Version of the record format
+#define TELEMETRY_VERSION           1
+
+// Size of the record payload in bytes, without the CRC
+#define TELEMETRY_PAYLOAD_SIZE      17
+
+// Largest frame on the line: payload, CRC, COBS overhead byte and delimiter
+#define TELEMETRY_FRAME_SIZE        (TELEMETRY_PAYLOAD_SIZE + 2 + 1 + 1)
+
+// Number of records held by the queue (must be a power of 2)
+#define TELEMETRY_QUEUE_SIZE        16
+
+// Size of each half of the UART DMA double buffer, in bytes
+#define TELEMETRY_BUFFER_SIZE       128
+
+/**
+ * @brief Line follower state captured in one telemetry record.
+ */
+typedef struct
+{
+    uint32_t time;
+    int16_t position;
+    int16_t pid;
+    uint16_t duty_cycle_left;
+    uint16_t duty_cycle_right;
+    uint8_t sensor_data;
+    uint8_t state;
+} Telemetry_Record;
+
+/**
+ * @brief Initializes the telemetry queue and DMA transmission on EUSCI_A0.
+ *
+ * @param divider Only every divider-th record passed to Telemetry_Push is kept (0 disables telemetry).
+ *
+ * @return None
+ */
+void Telemetry_Init(uint16_t divider);
+
+/**
+ * @brief Changes the rate of the telemetry stream.
+ *
+ * @param divider Only every divider-th record passed to Telemetry_Push is kept (0 disables telemetry).
+ *
+ * @return None
+ */
+void Telemetry_Set_Divider(uint16_t divider);
+
+/**
+ * @brief Adds a record to the queue.
+ *
+ * This function may be called from one interrupt handler or from the main loop, but not both.
+ *
+ * @param record Pointer to the record to copy.
+ *
+ * @return 1 if the record was queued, 0 if it was skipped by the divider or dropped because the queue is full.
+ */
+uint8_t Telemetry_Push(const Telemetry_Record *record);
+
+/**
+ * @brief Encodes the queued records into a free half of the DMA buffer and starts its transmission.
+ *
+ * This function should be called periodically from the main loop (e.g. as a scheduler task).
+ *
+ * @return None
+ */
+void Telemetry_Task(void);
+
+/**
+ * @brief Returns the number of records dropped because the queue was full.
+ *
+ * @return The number of dropped records.
+ */
+uint32_t Telemetry_Get_Dropped(void);
+
+#endif /* TELEMETRY_H_ */
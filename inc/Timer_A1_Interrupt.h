@@ -30,6 +30,9 @@
 
 void (*Timer_A1_Task)(void);
 
+// Number of Timer A1 ticks per microsecond (SMCLK = 12 MHz, divided by 1)
+#define TIMER_A1_TICKS_PER_US   12
+
 /**
  * @brief Initialize Timer A1 for periodic interrupt generation.
  *
@@ -57,4 +60,30 @@ void Timer_A1_Interrupt_Init(void(*task)(void), uint16_t period);
  */
 void TimerA1_Stop(void);
 
+/**
+ * @brief Schedule a one-shot task using the Capture/Compare 1 channel of Timer A1.
+ *
+ * This function arms CCR1 so that the task is executed once from TA1_N_IRQHandler after the given delay.
+ * Timer A1 keeps running in up mode for the periodic interrupt, so delays longer than half of its
+ * period are split into several compare events. Calling this function again before the task runs
+ * replaces the pending task.
+ *
+ * @param task A pointer to the task function to be executed once after the delay.
+ * @param delay The delay before executing the task, in timer ticks (see TIMER_A1_TICKS_PER_US).
+ *
+ * @note Timer_A1_Interrupt_Init must be called first so that Timer A1 is running.
+ *
+ * @note The task can call Timer_A1_Compare_Start again to schedule the next step of a sequence.
+ *
+ * @return None
+ */
+void Timer_A1_Compare_Start(void(*task)(void), uint32_t delay);
+
+/**
+ * @brief Cancel a pending one-shot task scheduled with Timer_A1_Compare_Start.
+ *
+ * @return None
+ */
+void Timer_A1_Compare_Stop(void);
+
 #endif /* TIMER_A1_INTERRUPT_H_ */
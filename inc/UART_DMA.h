@@ -0,0 +1,96 @@
+/**
+ * @file UART_DMA.h
+ * @brief Header file for the UART_DMA driver.
+ *
+ * This file contains the function definitions for the UART_DMA driver, which transmits bulk data
+ * (e.g. telemetry bursts) through EUSCI_A0 or EUSCI_A2 with the DMA controller instead of the CPU.
+ *
+ * The caller provides one buffer split into two halves. While the DMA drains one half into the
+ * transmit buffer register, the application fills the other:
+ *
+ *  uint8_t *buffer = UART_DMA_Get_Buffer(UART_DMA_A0);
+ *  if (buffer) { ...write up to half_size bytes...; UART_DMA_Send(UART_DMA_A0, length); }
+ *
+ * A half that is sent while the other one is draining is queued and started from the DMA
+ * completion interrupt, so the line stays busy without CPU involvement between bytes. The
+ * completion callback is called from the DMA_INT0 handler each time a half has been handed
+ * to the eUSCI and can be filled again.
+ *
+ * Channels used:
+ *  - EUSCI_A0 TX: DMA channel 0
+ *  - EUSCI_A2 TX: DMA channel 4
+ *
+ * @note EUSCI_A0_UART_Init or EUSCI_A2_UART_Init must be called before UART_DMA_Init.
+ *       The transmit interrupt of the eUSCI must stay disabled, so this driver cannot be combined
+ *       with EUSCI_A0_UART_Init_Buffered for transmission on the same port.
+ *
+ */
+
+#ifndef UART_DMA_H_
+#define UART_DMA_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "DMA.h"
+
+/**
+ * @brief Identifies the UART ports that can be driven by the DMA.
+ */
+typedef enum
+{
+    UART_DMA_A0 = 0,
+    UART_DMA_A2 = 1
+} UART_DMA_Port;
+
+// Number of ports supported by the driver
+#define UART_DMA_NUM_PORTS      2
+
+/**
+ * @brief Initializes DMA transmission on a UART port.
+ *
+ * The driver does not allocate memory: the buffer must hold 2 * half_size bytes and stay valid
+ * while the port is in use. DMA_Init is called by this function.
+ *
+ * @param port      The UART port.
+ * @param buffer    Pointer to the double buffer.
+ * @param half_size The size of each half in bytes, 1 to DMA_MAX_TRANSFER.
+ * @param done      Function called from the DMA interrupt when a half becomes free, or null.
+ *
+ * @return None
+ */
+void UART_DMA_Init(UART_DMA_Port port, uint8_t *buffer, uint16_t half_size, void (*done)(UART_DMA_Port port));
+
+/**
+ * @brief Returns the half of the buffer that can be filled next.
+ *
+ * @param port The UART port.
+ *
+ * @return Pointer to a free half of half_size bytes, or null if both halves are queued or draining.
+ */
+uint8_t *UART_DMA_Get_Buffer(UART_DMA_Port port);
+
+/**
+ * @brief Queues the half returned by UART_DMA_Get_Buffer for transmission.
+ *
+ * The transfer starts immediately if the DMA is idle on this port, otherwise it starts as soon as
+ * the other half has been drained.
+ *
+ * @param port   The UART port.
+ * @param length The number of bytes written to the half, 1 to half_size.
+ *
+ * @return 1 if the half was queued, 0 if no half was free or the length is out of range.
+ */
+uint8_t UART_DMA_Send(UART_DMA_Port port, uint16_t length);
+
+/**
+ * @brief Checks whether a port still has data queued or draining.
+ *
+ * The last byte may still be in the eUSCI shift register when this function returns 0.
+ *
+ * @param port The UART port.
+ *
+ * @return 1 if a half is queued or draining, 0 otherwise.
+ */
+uint8_t UART_DMA_Busy(UART_DMA_Port port);
+
+#endif /* UART_DMA_H_ */
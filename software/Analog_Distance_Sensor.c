@@ -17,6 +17,76 @@
  */
 
 #include "../inc/Analog_Distance_Sensor.h"
+#include "../inc/CortexM.h"
+#include "../inc/DMA.h"
+#include "../inc/LPF.h"
+
+// Ring of sequences written by DMA channel 7: A17, A14 and A16 results of each sequence
+static uint32_t Sequence_Ring[ANALOG_DISTANCE_SENSOR_RING_SIZE][3];
+
+// Number of sequences completed. Slot (Sequence_Count & (size - 1)) is being written.
+static volatile uint32_t Sequence_Count;
+
+// Low-pass filter of the DMA mode, fed by Analog_Distance_Sensor_Get_Filtered, the number of
+// sequences completed when it was last fed and its latest outputs
+LPF_FILTER(Distance_Filter, ANALOG_DISTANCE_SENSOR_FILTER_SIZE, 3);
+static uint32_t Filtered_Count;
+static uint32_t Filtered_Result[3];
+
+// Item count and control word of one sequence: three 32-bit results from ADC14MEM2 - ADC14MEM4,
+// moved in a single arbitration cycle, alternating between the primary and alternate structures
+#define SEQUENCE_ITEMS      3
+#define SEQUENCE_CONTROL    (DMA_SIZE_32 | DMA_SRC_INC_32 | DMA_DST_INC_32 | DMA_ARBITRATE_4 | DMA_MODE_PING_PONG)
+
+// Number of entries of each calibration table
+#define TABLE_SIZE          ((16384 >> ANALOG_DISTANCE_SENSOR_TABLE_SHIFT) + 1)
+
+#if ANALOG_DISTANCE_SENSOR_TABLE_SHIFT != 7
+#error "TABLE_ENTRIES_129 must be updated for the new table size"
+#endif
+
+// First breakpoint of the segment that holds MAX, the lowest breakpoint used by the interpolation
+#define TABLE_FIRST(s)      ((ANALOG_DISTANCE_SENSOR_CAL_##s##_MAX >> ANALOG_DISTANCE_SENSOR_TABLE_SHIFT) << ANALOG_DISTANCE_SENSOR_TABLE_SHIFT)
+
+#if (TABLE_FIRST(RIGHT) + ANALOG_DISTANCE_SENSOR_CAL_RIGHT_B <= 0) || \
+    (TABLE_FIRST(CENTER) + ANALOG_DISTANCE_SENSOR_CAL_CENTER_B <= 0) || \
+    (TABLE_FIRST(LEFT) + ANALOG_DISTANCE_SENSOR_CAL_LEFT_B <= 0)
+#error "The calibration formula must be defined from the breakpoint below MAX to 16384"
+#endif
+
+// Calibration formula of a sensor at the ADC result of breakpoint i. The breakpoints below
+// TABLE_FIRST are never used and hold the value at TABLE_FIRST, so that the formula is never
+// evaluated with a negative or zero denominator.
+#define TABLE_INPUT(s, i)   ((((i) << ANALOG_DISTANCE_SENSOR_TABLE_SHIFT) > TABLE_FIRST(s)) ? \
+                             ((i) << ANALOG_DISTANCE_SENSOR_TABLE_SHIFT) : TABLE_FIRST(s))
+
+#define TABLE_ENTRY(s, i)   ((uint16_t)(ANALOG_DISTANCE_SENSOR_CAL_##s##_A / (TABLE_INPUT(s, i) + ANALOG_DISTANCE_SENSOR_CAL_##s##_B) \
+                             + ANALOG_DISTANCE_SENSOR_CAL_##s##_C))
+
+#define TABLE_ENTRIES_8(s, i)   TABLE_ENTRY(s, (i)), TABLE_ENTRY(s, (i) + 1), TABLE_ENTRY(s, (i) + 2), TABLE_ENTRY(s, (i) + 3), \
+                                TABLE_ENTRY(s, (i) + 4), TABLE_ENTRY(s, (i) + 5), TABLE_ENTRY(s, (i) + 6), TABLE_ENTRY(s, (i) + 7)
+
+#define TABLE_ENTRIES_64(s, i)  TABLE_ENTRIES_8(s, (i)), TABLE_ENTRIES_8(s, (i) + 8), TABLE_ENTRIES_8(s, (i) + 16), \
+                                TABLE_ENTRIES_8(s, (i) + 24), TABLE_ENTRIES_8(s, (i) + 32), TABLE_ENTRIES_8(s, (i) + 40), \
+                                TABLE_ENTRIES_8(s, (i) + 48), TABLE_ENTRIES_8(s, (i) + 56)
+
+#define TABLE_ENTRIES_129(s)    { TABLE_ENTRIES_64(s, 0), TABLE_ENTRIES_64(s, 64), TABLE_ENTRY(s, 128) }
+
+// Calibrated distance (mm) of each sensor at every breakpoint, computed by the compiler
+static const uint16_t Calibration_Table[ANALOG_DISTANCE_SENSOR_COUNT][TABLE_SIZE] =
+{
+    TABLE_ENTRIES_129(RIGHT),
+    TABLE_ENTRIES_129(CENTER),
+    TABLE_ENTRIES_129(LEFT)
+};
+
+// ADC result below which each sensor is out of range
+static const uint16_t Calibration_Max[ANALOG_DISTANCE_SENSOR_COUNT] =
+{
+    ANALOG_DISTANCE_SENSOR_CAL_RIGHT_MAX,
+    ANALOG_DISTANCE_SENSOR_CAL_CENTER_MAX,
+    ANALOG_DISTANCE_SENSOR_CAL_LEFT_MAX
+};
 
 void Analog_Distance_Sensor_Init()
 {
@@ -141,14 +211,148 @@ void Analog_Distance_Sensor_Start_Conversion(uint32_t *Ch_17, uint32_t *Ch_14, u
     *Ch_16 = ADC14->MEM[4];
 }
 
-int32_t Analog_Distance_Sensor_Calibrate(int filtered_distance)
+// Called from DMA_INT0 at the end of each sequence
+static void Analog_Distance_Sensor_Sequence_Done(void)
+{
+    uint32_t count = Sequence_Count + 1;
+
+    // The structure that just completed is reloaded with the slot after the one the other
+    // structure is writing now. Completions alternate between primary and alternate.
+    DMA_Set_Transfer(ANALOG_DISTANCE_SENSOR_DMA_CHANNEL, (count - 1) & 1, &ADC14->MEM[2],
+                     Sequence_Ring[(count + 1) & (ANALOG_DISTANCE_SENSOR_RING_SIZE - 1)],
+                     SEQUENCE_CONTROL, SEQUENCE_ITEMS);
+
+    Sequence_Count = count;
+}
+
+void Analog_Distance_Sensor_Init_DMA()
+{
+    Analog_Distance_Sensor_Init();
+
+    // Clear ADC14ENC (Bit 1) to 0 to disable conversion
+    ADC14->CTL0 &= ~0x00000002;
+
+    //     CTL0 Register Configuration
+    //
+    //     Bit(s)         Field             Value       Description
+    //     -----        ----------          ------      -------------
+    //     31-30        ADC14PDIV           00b         Predivide selected ADC14CLK: Predivide by 1
+    //     29-27        ADC14SHSx           100b        Sample-and-hold source select: TA1_C2
+    //      26          ADC14SHP            1b          SAMPCON signal is sourced from the sampling timer
+    //      25          ADC14ISSH           0b          Sample-input signal is not inverted
+    //     24-22        ADC14DIVx           000b        Divide ADC14CLK frequency by 1
+    //     21-19        ADC14SSELx          100b        ADC14CLK clock source: SMCLK
+    //     18-17        ADC14CONSEQx        11b         Conversion sequence mode: Repeat-sequence-of-channels
+    //      16          ADC14BUSY           0b          ADC14 busy status. Read-only.
+    //     15-12        ADC14SHT1x          0011b       Sample-and-hold time of 32 ADC14CLK clock cycles
+    //     11-8         ADC14SHT0x          0011b       Sample-and-hold time of 32 ADC14CLK clock cycles
+    //      7           ADC14MSC            0b          Each sample-and-conversion requires a rising edge of SHI
+    //     6-5          Reserved            00b         Reserved
+    //      4           ADC14ON             1b          ADC14 on
+    //     3-2          Reserved            00b         Reserved
+    //      1           ADC14ENC            0b          Disable conversion
+    //      0           ADC14SC             0b          No sample-and-conversion start
+    ADC14->CTL0 = 0x24263310;
+
+    Sequence_Count = 0;
+    Filtered_Count = 0;
+
+    // DMA channel 7 is triggered by ADC14 at the end of each sequence. The primary structure
+    // writes slot 0 and the alternate structure slot 1.
+    DMA_Configure_Channel(ANALOG_DISTANCE_SENSOR_DMA_CHANNEL, DMA_SOURCE_ADC14, &Analog_Distance_Sensor_Sequence_Done);
+    DMA_Set_Transfer(ANALOG_DISTANCE_SENSOR_DMA_CHANNEL, 0, &ADC14->MEM[2], Sequence_Ring[0], SEQUENCE_CONTROL, SEQUENCE_ITEMS);
+    DMA_Set_Transfer(ANALOG_DISTANCE_SENSOR_DMA_CHANNEL, 1, &ADC14->MEM[2], Sequence_Ring[1], SEQUENCE_CONTROL, SEQUENCE_ITEMS);
+    DMA_Enable_Channel(ANALOG_DISTANCE_SENSOR_DMA_CHANNEL);
+
+    // Timer A1 CCR2 in Set/Reset mode (OUTMOD = 011b) rises once per period, halfway between
+    // two CCR0 interrupts. It has no pin and no interrupt.
+    TIMER_A1->CCR[2] = (TIMER_A1->CCR[0] + 1) / 2;
+    TIMER_A1->CCTL[2] = 0x0060;
+
+    // Set ADC14ENC (Bit 1) to 1 to enable conversion
+    ADC14->CTL0 |= 0x00000002;
+}
+
+uint32_t Analog_Distance_Sensor_Get_Filtered(uint32_t *Ch_17, uint32_t *Ch_14, uint32_t *Ch_16)
+{
+    uint32_t sequences[ANALOG_DISTANCE_SENSOR_RING_SIZE - 2][3];
+
+    // The DMA structures hold the slots of Sequence_Count and Sequence_Count + 1, so up to
+    // RING_SIZE - 2 new sequences can be read; older ones have been overwritten. They are
+    // copied in a critical section so that no slot is reused while it is read.
+    long sr = StartCritical();
+
+    uint32_t count = Sequence_Count;
+    uint32_t n = count - Filtered_Count;
+    if (n > ANALOG_DISTANCE_SENSOR_RING_SIZE - 2) n = ANALOG_DISTANCE_SENSOR_RING_SIZE - 2;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const uint32_t *sequence = Sequence_Ring[(count - n + i) & (ANALOG_DISTANCE_SENSOR_RING_SIZE - 1)];
+        sequences[i][0] = sequence[0];
+        sequences[i][1] = sequence[1];
+        sequences[i][2] = sequence[2];
+    }
+
+    EndCritical(sr);
+
+    if (count == 0) return 0;
+
+    // The window is filled with the first sequence, so the output starts without a ramp
+    if (Filtered_Count == 0)
+    {
+        LPF_Init(&Distance_Filter, 0);
+        for (uint32_t i = 1; i < ANALOG_DISTANCE_SENSOR_FILTER_SIZE; i++)
+        {
+            uint32_t first[3] = {sequences[0][0], sequences[0][1], sequences[0][2]};
+            LPF_Calc_Distance(&Distance_Filter, &first[0], &first[1], &first[2]);
+        }
+    }
+    Filtered_Count = count;
+
+    // The outputs replace the sequences, and the last ones are kept for the calls without new data
+    for (uint32_t i = 0; i < n; i++)
+    {
+        LPF_Calc_Distance(&Distance_Filter, &sequences[i][0], &sequences[i][1], &sequences[i][2]);
+        Filtered_Result[0] = sequences[i][0];
+        Filtered_Result[1] = sequences[i][1];
+        Filtered_Result[2] = sequences[i][2];
+    }
+
+    *Ch_17 = Filtered_Result[0];
+    *Ch_14 = Filtered_Result[1];
+    *Ch_16 = Filtered_Result[2];
+    return n;
+}
+
+uint32_t Analog_Distance_Sensor_Get_Count()
+{
+    return Sequence_Count;
+}
+
+int32_t Analog_Distance_Sensor_Calibrate_Sensor(Analog_Distance_Sensor_Select sensor, int filtered_distance)
 {
     // If the filtered distance (after LPF) is less than the max, return 800 mm
-    if (filtered_distance < ANALOG_DISTANCE_SENSOR_MAX)
+    if (filtered_distance < Calibration_Max[sensor])
     {
         return 800;
     }
 
-    // Otherwise, calculate the calibrated distance using the calibration formula
-    return (Ax / (filtered_distance + Bx) + Cx);
+    if (filtered_distance > 16383)
+    {
+        filtered_distance = 16383;
+    }
+
+    // Interpolate between the two breakpoints around the filtered distance. The distance
+    // decreases as the ADC result increases, so the difference is never negative.
+    const uint16_t *entry = &Calibration_Table[sensor][filtered_distance >> ANALOG_DISTANCE_SENSOR_TABLE_SHIFT];
+    uint32_t fraction = filtered_distance & ((1 << ANALOG_DISTANCE_SENSOR_TABLE_SHIFT) - 1);
+    uint32_t difference = entry[0] - entry[1];
+
+    return entry[0] - (int32_t)((difference * fraction + (1 << (ANALOG_DISTANCE_SENSOR_TABLE_SHIFT - 1))) >> ANALOG_DISTANCE_SENSOR_TABLE_SHIFT);
+}
+
+int32_t Analog_Distance_Sensor_Calibrate(int filtered_distance)
+{
+    return Analog_Distance_Sensor_Calibrate_Sensor(ANALOG_DISTANCE_SENSOR_CENTER, filtered_distance);
 }
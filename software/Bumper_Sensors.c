@@ -29,6 +29,7 @@
  */
 
 #include "../inc/Bumper_Sensors.h"
+#include "../inc/ISR_Profile.h"
 
 void Bumper_Sensors_Init(void(*task)(uint8_t))
 {
@@ -95,9 +96,13 @@ uint8_t Bumper_Read(void)
  */
 void PORT4_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+
     // Clear the interrupt flags for P4.7 - P4.5, P4.3, P4.2, and P4.0
     P4->IFG &= ~0xED;
 
     // Execute the user-defined task
     (*Bumper_Task)(Bumper_Read());
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_PORT4);
 }
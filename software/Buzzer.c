@@ -0,0 +1,215 @@
+/**
+ * @file Buzzer.c
+ * @brief Source code for the Buzzer driver.
+ *
+ * This file contains the function definitions for the piezo buzzer driver.
+ * It uses Timer A2 in up mode: CCR0 holds the period of the note and CCR1 produces a square wave
+ * on P5.6 (PM_TA2.1) in Reset / Set mode.
+ *
+ */
+
+#include "../inc/Buzzer.h"
+#include "../inc/CortexM.h"
+#include "../inc/ISR_Profile.h"
+
+// Timer A2 clock frequency (SMCLK = 12 MHz divided by 4)
+#define BUZZER_TIMER_CLOCK  3000000
+
+// Period used while resting, 1 ms
+#define BUZZER_REST_PERIOD  (BUZZER_TIMER_CLOCK / 1000)
+
+// Melodies waiting to be played
+static const Buzzer_Note *Buzzer_Queue_Melody[BUZZER_QUEUE_SIZE];
+static uint16_t Buzzer_Queue_Count[BUZZER_QUEUE_SIZE];
+static volatile uint8_t Buzzer_Queue_Head;
+static volatile uint8_t Buzzer_Queue_Tail;
+
+// Position in the melody being played
+static const Buzzer_Note *Buzzer_Note_Current;
+static uint16_t Buzzer_Notes_Left;
+
+// Timer periods left in the current note, and the number of them that are silent
+static uint32_t Buzzer_Periods_Left;
+static uint32_t Buzzer_Periods_Gap;
+
+static void Buzzer_Halt(void)
+{
+    // Halt Timer A2 by clearing MC bits
+    TIMER_A2->CTL &= ~0x0030;
+
+    // Drive the output low (OUTMOD = 0, OUT = 0)
+    TIMER_A2->CCTL[1] = 0x0000;
+
+    Buzzer_Notes_Left = 0;
+    Buzzer_Periods_Left = 0;
+}
+
+static void Buzzer_Start(void)
+{
+    // The first interrupt, 1 ms from now, loads the first note
+    Buzzer_Periods_Left = 0;
+    TIMER_A2->CCTL[1] = 0x0000;
+    TIMER_A2->CCR[0] = BUZZER_REST_PERIOD - 1;
+
+    // Clear any pending flag and enable the CCR0 interrupt
+    TIMER_A2->CCTL[0] = 0x0010;
+
+    // Choose SMCLK as timer clock source (TASSEL = 10b)
+    // Divide by 4 (ID = 10b)
+    // Set the TACLR bit and enable Timer A2 in up mode
+    TIMER_A2->CTL = 0x0294;
+}
+
+static void Buzzer_Load_Note(const Buzzer_Note *note)
+{
+    uint32_t frequency = note->frequency;
+    uint32_t period;
+
+    if (frequency == BUZZER_REST)
+    {
+        // Output low for the whole note
+        TIMER_A2->CCTL[1] = 0x0000;
+        period = BUZZER_REST_PERIOD;
+        Buzzer_Periods_Left = note->duration;
+        Buzzer_Periods_Gap = 0;
+    }
+    else
+    {
+        if (frequency < (BUZZER_TIMER_CLOCK / 65536) + 1) frequency = (BUZZER_TIMER_CLOCK / 65536) + 1;
+        period = (BUZZER_TIMER_CLOCK + (frequency / 2)) / frequency;
+
+        // Square wave with a 50% duty cycle (OUTMOD = 7, Reset / Set)
+        TIMER_A2->CCR[1] = period / 2;
+        TIMER_A2->CCTL[1] = 0x00E0;
+
+        Buzzer_Periods_Left = ((uint32_t)note->duration * frequency + 500) / 1000;
+        Buzzer_Periods_Gap = (BUZZER_NOTE_GAP * frequency + 500) / 1000;
+        if (Buzzer_Periods_Gap >= Buzzer_Periods_Left) Buzzer_Periods_Gap = 0;
+    }
+
+    // The interrupt runs at the start of a period, so the new period applies right away
+    TIMER_A2->CCR[0] = period - 1;
+}
+
+void Buzzer_Init(void)
+{
+    // Configure pin P5.6 (PM_TA2.1) to peripheral function mode
+    P5->SEL0 |= 0x40;
+    P5->SEL1 &= ~0x40;
+
+    // Configure pin P5.6 as output to drive the buzzer
+    P5->DIR |= 0x40;
+
+    // Divide the SMCLK frequency by 1
+    TIMER_A2->EX0 = 0x0000;
+
+    Buzzer_Queue_Head = 0;
+    Buzzer_Queue_Tail = 0;
+    Buzzer_Halt();
+
+    // Set interrupt priority level to 6
+    NVIC->IP[12] = 0xC0;
+
+    // Enable Interrupt 12 in NVIC
+    NVIC->ISER[0] = 0x00001000;
+}
+
+uint8_t Buzzer_Play(const Buzzer_Note *melody, uint16_t count)
+{
+    uint8_t queued = 0;
+
+    if (count == 0) return 1;
+
+    long sr = StartCritical();
+
+    uint8_t next = (Buzzer_Queue_Head + 1) % BUZZER_QUEUE_SIZE;
+    if (next != Buzzer_Queue_Tail)
+    {
+        Buzzer_Queue_Melody[Buzzer_Queue_Head] = melody;
+        Buzzer_Queue_Count[Buzzer_Queue_Head] = count;
+        Buzzer_Queue_Head = next;
+        queued = 1;
+
+        // Start the timer if it is halted
+        if ((TIMER_A2->CTL & 0x0030) == 0) Buzzer_Start();
+    }
+
+    EndCritical(sr);
+
+    return queued;
+}
+
+void Buzzer_Stop(void)
+{
+    long sr = StartCritical();
+
+    Buzzer_Queue_Tail = Buzzer_Queue_Head;
+    Buzzer_Halt();
+
+    // Clear the CCR0 interrupt enable and any pending flag
+    TIMER_A2->CCTL[0] = 0x0000;
+
+    EndCritical(sr);
+}
+
+uint8_t Buzzer_Busy(void)
+{
+    return (((TIMER_A2->CTL & 0x0030) != 0) || (Buzzer_Queue_Head != Buzzer_Queue_Tail));
+}
+
+void TA2_0_IRQHandler(void)
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER_LATENCY(TIMER_A2, TIMER_A2->CCR[0]));
+
+    // Acknowledge Capture/Compare interrupt and clear it
+    TIMER_A2->CCTL[0] &= ~0x0001;
+
+    // Keep playing the current note
+    if (Buzzer_Periods_Left > 1)
+    {
+        Buzzer_Periods_Left = Buzzer_Periods_Left - 1;
+
+        // Silence the end of the note
+        if (Buzzer_Periods_Left == Buzzer_Periods_Gap) TIMER_A2->CCTL[1] = 0x0000;
+        ISR_PROFILE_EXIT(ISR_PROFILE_TA2_0);
+        return;
+    }
+
+    long sr = StartCritical();
+
+    while (1)
+    {
+        // Take the next melody from the queue when the current one has ended
+        if (Buzzer_Notes_Left == 0)
+        {
+            if (Buzzer_Queue_Tail == Buzzer_Queue_Head) break;
+
+            Buzzer_Note_Current = Buzzer_Queue_Melody[Buzzer_Queue_Tail];
+            Buzzer_Notes_Left = Buzzer_Queue_Count[Buzzer_Queue_Tail];
+            Buzzer_Queue_Tail = (Buzzer_Queue_Tail + 1) % BUZZER_QUEUE_SIZE;
+            continue;
+        }
+
+        // Skip the notes with a duration of 0, which would otherwise sound for one period
+        if (Buzzer_Note_Current->duration != 0) break;
+
+        Buzzer_Note_Current = Buzzer_Note_Current + 1;
+        Buzzer_Notes_Left = Buzzer_Notes_Left - 1;
+    }
+
+    if (Buzzer_Notes_Left == 0)
+    {
+        // Nothing left to play
+        Buzzer_Halt();
+    }
+    else
+    {
+        Buzzer_Load_Note(Buzzer_Note_Current);
+        Buzzer_Note_Current = Buzzer_Note_Current + 1;
+        Buzzer_Notes_Left = Buzzer_Notes_Left - 1;
+    }
+
+    EndCritical(sr);
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_TA2_0);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file COBS.c
+ * @brief Source code for the COBS module.
+ *
+ * This file contains the function definitions for the COBS module.
+ *
+ */
+
+#include "../inc/COBS.h"
+
+uint16_t COBS_Encode(const uint8_t *data, uint16_t length, uint8_t *frame)
+{
+    // Each code byte gives the distance to the next zero, which it replaces.
+    // A code of 0xFF marks a block of 254 non-zero bytes that is not followed by a zero.
+    uint16_t code_index = 0;
+    uint16_t size = 1;
+    uint8_t code = 1;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (data[i] == 0)
+        {
+            frame[code_index] = code;
+            code_index = size++;
+            code = 1;
+        }
+        else
+        {
+            frame[size++] = data[i];
+            code++;
+
+            if (code == 0xFF)
+            {
+                frame[code_index] = code;
+                code_index = size++;
+                code = 1;
+            }
+        }
+    }
+    frame[code_index] = code;
+
+    // Frame delimiter
+    frame[size++] = 0x00;
+    return size;
+}
@@ -45,6 +45,10 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include "msp.h"
 #include "../inc/Clock.h"
 
+#ifdef MSP432_HOST
+#include "MSP432_Host.h"
+#endif
+
 uint32_t ClockFrequency = 3000000; // cycles/second
 //static uint32_t SubsystemFrequency = 3000000; // cycles/second
 
@@ -144,20 +148,31 @@ uint32_t Clock_GetFreq(void){
 // which delays about 6*ulCount cycles
 // ulCount=8000 => 1ms = (8000 loops)*(6 cycles/loop)*(20.83 ns/cycle)
   //Code Composer Studio Code
+#ifndef MSP432_HOST
 void delay(unsigned long ulCount){
   __asm (  "pdloop:  subs    r0, #1\n"
       "    bne    pdloop\n");
 }
+#else
+// On the host the loop is replaced by the same number of cycles on the virtual clock
+void delay(unsigned long ulCount){
+  MSP432_Host_Advance(6*(uint64_t)ulCount);
+}
+#endif
 
 // ------------Clock_Delay1us------------
 // Simple delay function which delays about n microseconds.
 // Inputs: n, number of us to wait
 // Outputs: none
 void Clock_Delay1us(uint32_t n){
+#ifndef MSP432_HOST
   n = (382*n)/100;; // 1 us, tuned at 48 MHz
   while(n){
     n--;
   }
+#else
+  MSP432_Host_Advance((uint64_t)n*(ClockFrequency/1000000));
+#endif
 }
 
 // ------------Clock_Delay1ms------------
@@ -166,7 +181,11 @@ void Clock_Delay1us(uint32_t n){
 // Outputs: none
 void Clock_Delay1ms(uint32_t n){
   while(n){
+#ifndef MSP432_HOST
     delay(ClockFrequency/9162);   // 1 msec, tuned at 48 MHz
+#else
+    MSP432_Host_Advance(ClockFrequency/1000);
+#endif
     n--;
   }
 }
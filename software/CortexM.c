@@ -37,6 +37,8 @@ policies, either expressed or implied, of the FreeBSD Project.
  */
 #include <stdint.h>
 
+// The host build provides these functions in host/MSP432_Host.c
+#ifndef MSP432_HOST
 
 //*********** DisableInterrupts ***************
 // disable interrupts
@@ -83,4 +85,4 @@ void WaitForInterrupt(void){
           "    BX     LR\n");
 }
 
-
+#endif
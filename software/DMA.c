@@ -0,0 +1,97 @@
+/**
+ * @file DMA.c
+ * @brief Source code for the DMA driver.
+ *
+ * This file contains the function definitions for the DMA driver.
+ *
+ * For more information regarding the DMA controller, refer to the DMA section (11)
+ * of the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#include <stdint.h>
+#include "../inc/DMA.h"
+#include "../inc/ISR_Profile.h"
+
+// Control table: primary structures followed by the alternate structures.
+// The controller requires the table to be aligned to its size.
+static DMA_Control_Block DMA_Control_Table[2 * DMA_NUM_CHANNELS] __attribute__((aligned(256)));
+
+// Tasks called at the end of a transfer, indexed by channel
+static void (*DMA_Tasks[DMA_NUM_CHANNELS])(void);
+
+void DMA_Init()
+{
+    // Enable the DMA controller
+    DMA_Control->CFG = 0x01;
+
+    // Set the base address of the control table
+    DMA_Control->CTLBASE = (uintptr_t)DMA_Control_Table;
+
+    // Set the priority of DMA_INT0 to 3 in the NVIC
+    NVIC->IP[34] = 0x60;
+
+    // Enable the DMA_INT0 interrupt in the NVIC
+    NVIC->ISER[1] = 0x00000004;
+}
+
+void DMA_Configure_Channel(uint8_t channel, uint8_t source, void (*task)(void))
+{
+    // Disable the channel while its trigger is changed
+    DMA_Control->ENACLR = (1 << channel);
+
+    DMA_Channel->CH_SRCCFG[channel] = source;
+    DMA_Tasks[channel] = task;
+
+    // Use the primary structure first and accept hardware requests
+    DMA_Control->ALTCLR = (1 << channel);
+    DMA_Control->REQMASKCLR = (1 << channel);
+}
+
+void DMA_Set_Transfer(uint8_t channel, uint8_t alternate, volatile void *source, volatile void *destination, uint32_t control, uint16_t count)
+{
+    DMA_Control_Block *block = &DMA_Control_Table[channel + (alternate ? DMA_NUM_CHANNELS : 0)];
+    uint32_t source_increment = (control >> 26) & 0x3;
+    uint32_t destination_increment = (control >> 30) & 0x3;
+
+    // The controller expects the address of the last item, unless the address does not increment
+    block->source_end = (volatile uint8_t *)source + ((source_increment == 3) ? 0 : ((uint32_t)(count - 1) << source_increment));
+    block->destination_end = (volatile uint8_t *)destination + ((destination_increment == 3) ? 0 : ((uint32_t)(count - 1) << destination_increment));
+    block->control = (control & ~0x00003FF0) | ((uint32_t)(count - 1) << 4);
+}
+
+void DMA_Enable_Channel(uint8_t channel)
+{
+    DMA_Control->ALTCLR = (1 << channel);
+    DMA_Control->ENASET = (1 << channel);
+}
+
+void DMA_Software_Trigger(uint8_t channel)
+{
+    DMA_Channel->SW_CHTRIG = (1 << channel);
+}
+
+uint8_t DMA_Channel_Busy(uint8_t channel)
+{
+    return (DMA_Control->ENASET >> channel) & 0x01;
+}
+
+void DMA_INT0_IRQHandler()
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+
+    uint32_t flags = DMA_Channel->INT0_SRCFLG;
+
+    // Acknowledge the completed channels before calling their tasks, so that a task can start a new transfer
+    DMA_Channel->INT0_CLRFLG = flags;
+
+    for (uint8_t channel = 0; channel < DMA_NUM_CHANNELS; channel++)
+    {
+        if ((flags & (1 << channel)) && DMA_Tasks[channel])
+        {
+            (*DMA_Tasks[channel])();
+        }
+    }
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_DMA_INT0);
+}
@@ -14,6 +14,23 @@
  */
 
 #include "../inc/EUSCI_A0_UART.h"
+#include "../inc/CortexM.h"
+#include "../inc/ISR_Profile.h"
+
+// Ring buffers used in buffered mode. The indices run freely and are masked on access.
+static uint8_t EUSCI_A0_UART_TX_Buffer[EUSCI_A0_UART_TX_BUFFER_SIZE];
+static uint8_t EUSCI_A0_UART_RX_Buffer[EUSCI_A0_UART_RX_BUFFER_SIZE];
+static volatile uint32_t EUSCI_A0_UART_TX_Head;
+static volatile uint32_t EUSCI_A0_UART_TX_Tail;
+static volatile uint32_t EUSCI_A0_UART_RX_Head;
+static volatile uint32_t EUSCI_A0_UART_RX_Tail;
+
+// Set by EUSCI_A0_UART_Init_Buffered
+static uint8_t EUSCI_A0_UART_Buffered = 0;
+
+// Number of characters dropped by EUSCI_A0_UART_OutChar and lost on reception
+static uint32_t EUSCI_A0_UART_Dropped;
+static uint32_t EUSCI_A0_UART_Overruns;
 
 void EUSCI_A0_UART_Init()
 {
@@ -45,10 +62,141 @@ void EUSCI_A0_UART_Init()
     // - Start Bit Interrupt
     // - Transmit Complete Interrupt
     EUSCI_A0->IE &= ~0xF;
+
+    EUSCI_A0_UART_Buffered = 0;
+}
+
+void EUSCI_A0_UART_Init_Buffered()
+{
+    EUSCI_A0_UART_Init();
+
+    EUSCI_A0_UART_TX_Head = 0;
+    EUSCI_A0_UART_TX_Tail = 0;
+    EUSCI_A0_UART_RX_Head = 0;
+    EUSCI_A0_UART_RX_Tail = 0;
+    EUSCI_A0_UART_Dropped = 0;
+    EUSCI_A0_UART_Overruns = 0;
+    EUSCI_A0_UART_Buffered = 1;
+
+    // Enable the receive interrupt
+    // The transmit interrupt is enabled when data is queued
+    EUSCI_A0->IE |= 0x01;
+
+    // Set interrupt priority level to 3
+    NVIC->IP[16] = 0x60;
+
+    // Enable Interrupt 16 in NVIC
+    NVIC->ISER[0] = 0x00010000;
+}
+
+uint32_t EUSCI_A0_UART_Write_Buffer(const uint8_t *data, uint32_t count)
+{
+    // Several contexts may queue data, so the copy is done in a critical section
+    long sr = StartCritical();
+
+    uint32_t head = EUSCI_A0_UART_TX_Head;
+    uint32_t free = EUSCI_A0_UART_TX_BUFFER_SIZE - (head - EUSCI_A0_UART_TX_Tail);
+    if (count > free) count = free;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EUSCI_A0_UART_TX_Buffer[(head + i) & (EUSCI_A0_UART_TX_BUFFER_SIZE - 1)] = data[i];
+    }
+    EUSCI_A0_UART_TX_Head = head + count;
+
+    // Enable the transmit interrupt, which is requested while TXBUF is empty
+    if (count) EUSCI_A0->IE |= 0x02;
+
+    EndCritical(sr);
+
+    return count;
+}
+
+uint32_t EUSCI_A0_UART_Read_Buffer(uint8_t *data, uint32_t max)
+{
+    uint32_t tail = EUSCI_A0_UART_RX_Tail;
+    uint32_t count = EUSCI_A0_UART_RX_Head - tail;
+    if (count > max) count = max;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        data[i] = EUSCI_A0_UART_RX_Buffer[(tail + i) & (EUSCI_A0_UART_RX_BUFFER_SIZE - 1)];
+    }
+    EUSCI_A0_UART_RX_Tail = tail + count;
+
+    return count;
+}
+
+uint32_t EUSCI_A0_UART_TX_Free()
+{
+    return EUSCI_A0_UART_TX_BUFFER_SIZE - (EUSCI_A0_UART_TX_Head - EUSCI_A0_UART_TX_Tail);
+}
+
+uint32_t EUSCI_A0_UART_RX_Available()
+{
+    return EUSCI_A0_UART_RX_Head - EUSCI_A0_UART_RX_Tail;
+}
+
+uint32_t EUSCI_A0_UART_TX_Dropped()
+{
+    return EUSCI_A0_UART_Dropped;
+}
+
+uint32_t EUSCI_A0_UART_RX_Overruns()
+{
+    return EUSCI_A0_UART_Overruns;
+}
+
+void EUSCIA0_IRQHandler(void)
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+
+    // Move a received character to the receive buffer
+    if (EUSCI_A0->IFG & 0x01)
+    {
+        uint8_t data = EUSCI_A0->RXBUF;
+        uint32_t head = EUSCI_A0_UART_RX_Head;
+
+        if ((head - EUSCI_A0_UART_RX_Tail) < EUSCI_A0_UART_RX_BUFFER_SIZE)
+        {
+            EUSCI_A0_UART_RX_Buffer[head & (EUSCI_A0_UART_RX_BUFFER_SIZE - 1)] = data;
+            EUSCI_A0_UART_RX_Head = head + 1;
+        }
+        else
+        {
+            EUSCI_A0_UART_Overruns = EUSCI_A0_UART_Overruns + 1;
+        }
+    }
+
+    // Send the next queued character when TXBUF is empty
+    if ((EUSCI_A0->IE & 0x02) && (EUSCI_A0->IFG & 0x02))
+    {
+        uint32_t tail = EUSCI_A0_UART_TX_Tail;
+
+        if (tail != EUSCI_A0_UART_TX_Head)
+        {
+            EUSCI_A0->TXBUF = EUSCI_A0_UART_TX_Buffer[tail & (EUSCI_A0_UART_TX_BUFFER_SIZE - 1)];
+            EUSCI_A0_UART_TX_Tail = tail + 1;
+        }
+        else
+        {
+            // Nothing left to send
+            EUSCI_A0->IE &= ~0x02;
+        }
+    }
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_EUSCIA0);
 }
 
 char EUSCI_A0_UART_InChar()
 {
+    if (EUSCI_A0_UART_Buffered)
+    {
+        uint8_t data;
+        while (EUSCI_A0_UART_Read_Buffer(&data, 1) == 0);
+        return (char)data;
+    }
+
     while((EUSCI_A0->IFG & 0x01) == 0);
 
     return((char)(EUSCI_A0->RXBUF));
@@ -56,6 +204,16 @@ char EUSCI_A0_UART_InChar()
 
 void EUSCI_A0_UART_OutChar(char letter)
 {
+    if (EUSCI_A0_UART_Buffered)
+    {
+        // Never wait: drop the character if the transmit buffer is full
+        if (EUSCI_A0_UART_Write_Buffer((const uint8_t *)&letter, 1) == 0)
+        {
+            EUSCI_A0_UART_Dropped = EUSCI_A0_UART_Dropped + 1;
+        }
+        return;
+    }
+
     while((EUSCI_A0->IFG & 0x02) == 0);
 
     EUSCI_A0->TXBUF = letter;
@@ -226,7 +384,8 @@ void EUSCI_A0_UART_OutUHex(uint32_t number)
 
 int EUSCI_A0_UART_Open(const char *path, unsigned flags, int llv_fd)
 {
-    EUSCI_A0_UART_Init();
+    // Keep the ring buffers if buffered mode is already active
+    if (EUSCI_A0_UART_Buffered == 0) EUSCI_A0_UART_Init();
     return 0;
 }
 
@@ -3,7 +3,9 @@
  * @brief Source code for the EUSCI_B1_I2C driver.
  *
  * This file contains the function definitions for the EUSCI_B1_I2C driver.
- * The EUSCI_B1_I2C driver uses busy-wait implementation.
+ * The EUSCI_B1_I2C driver uses busy-wait implementation by default. After EUSCI_B1_I2C_Init_Queued,
+ * transactions are placed in a queue and run in the background by the EUSCI_B1 interrupt,
+ * which calls a completion function at the end of each transaction.
  *
  * @note This function assumes that the necessary pin configurations for I2C communication have been performed
  *       on the corresponding pins. The output from the pins will be observed using an oscilloscope.
@@ -18,6 +20,21 @@
  */
 
 #include "../inc/EUSCI_B1_I2C.h"
+#include "../inc/CortexM.h"
+#include "../inc/ISR_Profile.h"
+
+// Queue of transactions. The indices run freely and are masked on access. The transaction at
+// the tail is the one on the bus, and it is released once its STOP condition has been sent.
+static EUSCI_B1_I2C_Transaction EUSCI_B1_I2C_Transactions[EUSCI_B1_I2C_QUEUE_SIZE];
+static volatile uint32_t EUSCI_B1_I2C_Head;
+static volatile uint32_t EUSCI_B1_I2C_Tail;
+
+// Progress of the transaction on the bus
+static uint16_t EUSCI_B1_I2C_Write_Index;
+static uint16_t EUSCI_B1_I2C_Read_Index;
+static EUSCI_B1_I2C_Status EUSCI_B1_I2C_Current_Status;
+
+static uint32_t EUSCI_B1_I2C_NACKs;
 
 void EUSCI_B1_I2C_Init()
 {
@@ -211,3 +228,223 @@ void EUSCI_B1_I2C_Receive_Multiple_Bytes(uint8_t slave_address, uint8_t *data_bu
     // Note: UCTXSTP is automatically cleared after the STOP condition is generated
     while(EUSCI_B1->CTLW0 & 0x0004);
 }
+
+// Generates a START condition to read the bytes of the current transaction
+static void EUSCI_B1_I2C_Start_Read(const EUSCI_B1_I2C_Transaction *transaction)
+{
+    EUSCI_B1_I2C_Read_Index = 0;
+
+    // Disable the transmit interrupt and enable the receive interrupt
+    EUSCI_B1->IE = (EUSCI_B1->IE & ~0x0002) | 0x0001;
+
+    // Clear UCTR (Bit 4): Receive mode
+    // Set UCTXSTT (Bit 1): Generate START condition (a repeated START after a write)
+    EUSCI_B1->CTLW0 = (EUSCI_B1->CTLW0 & ~0x0010) | 0x0002;
+}
+
+// Starts the transaction at the tail of the queue
+static void EUSCI_B1_I2C_Start(void)
+{
+    const EUSCI_B1_I2C_Transaction *transaction = &EUSCI_B1_I2C_Transactions[EUSCI_B1_I2C_Tail & (EUSCI_B1_I2C_QUEUE_SIZE - 1)];
+
+    EUSCI_B1_I2C_Write_Index = 0;
+    EUSCI_B1_I2C_Current_Status = EUSCI_B1_I2C_OK;
+
+    // Clear the flags left by the previous transaction
+    EUSCI_B1->IFG = 0x0000;
+
+    // Set the slave address
+    EUSCI_B1->I2CSA = transaction->slave_address;
+
+    // Enable the NACK and STOP interrupts
+    EUSCI_B1->IE = 0x0028;
+
+    if (transaction->write_length == 0)
+    {
+        EUSCI_B1_I2C_Start_Read(transaction);
+        return;
+    }
+
+    // Enable the transmit interrupt
+    EUSCI_B1->IE |= 0x0002;
+
+    // Configure I2C master transmit mode
+    // Clear UCTXSTP (Bit 2): No STOP condition
+    // Set UCTR (Bit 4): Transmitter mode
+    // Set UCTXSTT (Bit 1): Generate START condition
+    EUSCI_B1->CTLW0 = (EUSCI_B1->CTLW0 & ~0x0004) | 0x0012;
+}
+
+void EUSCI_B1_I2C_Init_Queued()
+{
+    EUSCI_B1_I2C_Init();
+
+    EUSCI_B1_I2C_Head = 0;
+    EUSCI_B1_I2C_Tail = 0;
+    EUSCI_B1_I2C_NACKs = 0;
+
+    // Set interrupt priority level to 2
+    NVIC->IP[21] = 0x40;
+
+    // Enable Interrupt 21 in NVIC
+    NVIC->ISER[0] = 0x00200000;
+}
+
+uint8_t EUSCI_B1_I2C_Queue(const EUSCI_B1_I2C_Transaction *transaction)
+{
+    if ((transaction->write_length == 0 && transaction->read_length == 0)
+        || transaction->write_length > EUSCI_B1_I2C_MAX_WRITE_LENGTH)
+    {
+        return 0;
+    }
+
+    // Several contexts may queue transactions, so the copy is done in a critical section
+    long sr = StartCritical();
+
+    uint32_t head = EUSCI_B1_I2C_Head;
+    if ((head - EUSCI_B1_I2C_Tail) >= EUSCI_B1_I2C_QUEUE_SIZE)
+    {
+        EndCritical(sr);
+        return 0;
+    }
+
+    EUSCI_B1_I2C_Transactions[head & (EUSCI_B1_I2C_QUEUE_SIZE - 1)] = *transaction;
+    EUSCI_B1_I2C_Head = head + 1;
+
+    // Start the transaction now if the bus was idle
+    if (head == EUSCI_B1_I2C_Tail)
+    {
+        EUSCI_B1_I2C_Start();
+    }
+
+    EndCritical(sr);
+
+    return 1;
+}
+
+uint8_t EUSCI_B1_I2C_Busy()
+{
+    return EUSCI_B1_I2C_Head != EUSCI_B1_I2C_Tail;
+}
+
+void EUSCI_B1_I2C_Wait()
+{
+    while (EUSCI_B1_I2C_Busy())
+    {
+        // Interrupts are masked between the check and WFI so that the last completion
+        // cannot be missed. WFI still wakes up on the pending interrupt, which is taken
+        // when the PRIMASK of the caller is restored.
+        long sr = StartCritical();
+        if (EUSCI_B1_I2C_Busy())
+        {
+            WaitForInterrupt();
+        }
+        EndCritical(sr);
+    }
+}
+
+void EUSCI_B1_I2C_Transfer(const EUSCI_B1_I2C_Transaction *transaction)
+{
+    while (!EUSCI_B1_I2C_Queue(transaction))
+    {
+        EUSCI_B1_I2C_Wait();
+    }
+    EUSCI_B1_I2C_Wait();
+}
+
+uint32_t EUSCI_B1_I2C_Get_NACKs()
+{
+    return EUSCI_B1_I2C_NACKs;
+}
+
+void EUSCIB1_IRQHandler(void)
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+
+    EUSCI_B1_I2C_Transaction *transaction = &EUSCI_B1_I2C_Transactions[EUSCI_B1_I2C_Tail & (EUSCI_B1_I2C_QUEUE_SIZE - 1)];
+    uint16_t flags = EUSCI_B1->IFG & EUSCI_B1->IE;
+
+    // UCNACKIFG: the slave did not acknowledge, so end the transaction with a STOP condition
+    if (flags & 0x0020)
+    {
+        EUSCI_B1->IFG &= ~0x0020;
+        EUSCI_B1->IE &= ~0x0003;
+        EUSCI_B1->CTLW0 |= 0x0004;
+        EUSCI_B1_I2C_Current_Status = EUSCI_B1_I2C_NACK;
+        EUSCI_B1_I2C_NACKs = EUSCI_B1_I2C_NACKs + 1;
+        ISR_PROFILE_EXIT(ISR_PROFILE_EUSCIB1);
+        return;
+    }
+
+    // UCRXIFG0: store the received byte (reading RXBUF clears the flag)
+    if (flags & 0x0001)
+    {
+        uint16_t index = EUSCI_B1_I2C_Read_Index;
+        transaction->read_data[index] = EUSCI_B1->RXBUF;
+        EUSCI_B1_I2C_Read_Index = index + 1;
+
+        // Request the STOP condition while the last byte is being received. A single-byte read
+        // has no earlier byte, so the STOP condition is requested here instead of waiting for the
+        // address to be sent: the slave sends one extra byte (its register pointer advances by
+        // one more), which is NACKed and stays in RXBUF with UCRXIFG0 set until the next
+        // EUSCI_B1_I2C_Start clears the flags.
+        if (index + 2 == transaction->read_length)
+        {
+            EUSCI_B1->CTLW0 |= 0x0004;
+        }
+        else if (index + 1 == transaction->read_length)
+        {
+            EUSCI_B1->IE &= ~0x0001;
+            if (transaction->read_length == 1)
+            {
+                EUSCI_B1->CTLW0 |= 0x0004;
+            }
+        }
+    }
+
+    // UCTXIFG0: load the next byte, or continue with the read or the STOP condition
+    if (flags & 0x0002)
+    {
+        uint16_t index = EUSCI_B1_I2C_Write_Index;
+        if (index < transaction->write_length)
+        {
+            EUSCI_B1->TXBUF = transaction->write_data[index];
+            EUSCI_B1_I2C_Write_Index = index + 1;
+        }
+        else if (transaction->read_length > 0)
+        {
+            EUSCI_B1_I2C_Start_Read(transaction);
+        }
+        else
+        {
+            // Set UCTXSTP (Bit 2): Generate STOP condition after the last byte
+            EUSCI_B1->IE &= ~0x0002;
+            EUSCI_B1->CTLW0 |= 0x0004;
+        }
+    }
+
+    // UCSTPIFG: the transaction is done
+    if (flags & 0x0008)
+    {
+        EUSCI_B1->IFG &= ~0x0008;
+        EUSCI_B1->IE = 0x0000;
+
+        void (*done)(EUSCI_B1_I2C_Status status) = transaction->done;
+        EUSCI_B1_I2C_Status status = EUSCI_B1_I2C_Current_Status;
+
+        // Release the transaction before the completion function, which may queue another one.
+        // A higher priority handler may queue a transaction at the same time.
+        long sr = StartCritical();
+        uint32_t tail = EUSCI_B1_I2C_Tail + 1;
+        EUSCI_B1_I2C_Tail = tail;
+        if (tail != EUSCI_B1_I2C_Head)
+        {
+            EUSCI_B1_I2C_Start();
+        }
+        EndCritical(sr);
+
+        if (done) done(status);
+    }
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_EUSCIB1);
+}
@@ -25,29 +25,26 @@
 #include "../inc/LPF.h"
 #include "../inc/Analog_Distance_Sensor.h"
 #include "../inc/Reflectance_Sensor.h"
-
-// buzzer
-const int BUZZER_DURATION   = 200;
-const int NOTE_INTERVAL     = 500;
-// buzzer notes
-const int C4_NOTE_FREQ       = 1980; // C4 (261 Hz)
-const int D4_NOTE_FREQ       = 1750; // D4 (293 Hz)
-const int E4_NOTE_FREQ       = 1555; // E4 (330 Hz)
-const int F4_NOTE_FREQ       = 1470; // F4 (349 Hz)
-const int F4S_NOTE_FREQ      = 1390; // F4# (370 Hz)
-const int G4_NOTE_FREQ       = 1310; // G4 (392 Hz)
-const int A4_NOTE_FREQ       = 1165; // A4 (440 Hz)
-const int B4_NOTE_FREQ       = 1040; // B4 (493 Hz)
-const int C5_NOTE_FREQ       = 980; // C5 (523 Hz)
-
-// PID controller
-double desired = 0.0;   // Desired value
-double integral = 0.0;         // Integral term starts at 0
-double previous = 0.0;      // Previous error
-uint16_t PID = 0;       // PID to change PWM values
-double Kp = 20.0;        // proportional constant
-double Ki = 0.0;        // integral constant
-double Kd = 1.0;         // derivative constant
+#include "../inc/PID.h"
+#include "../inc/Snapshot.h"
+#include "../inc/Sequencer.h"
+#include "../inc/Buzzer.h"
+#include "../inc/Scheduler.h"
+#include "../inc/ISR_Profile.h"
+#include "../inc/Telemetry.h"
+#include "../inc/Log.h"
+
+// ISR_Profile_Dump, the telemetry stream and the log all transmit on EUSCI_A0
+#if (defined(ISR_PROFILE_ACTIVE) + defined(TELEMETRY_ACTIVE) + defined(LOG_ACTIVE)) > 1
+#error "Only one of ISR_PROFILE_ACTIVE, TELEMETRY_ACTIVE and LOG_ACTIVE can be defined"
+#endif
+
+// Number of line sensor readings per telemetry record (1: every 10 ms)
+#define TELEMETRY_DIVIDER   1
+
+// Melody note lengths in milliseconds
+#define NOTE_QUARTER        400
+#define NOTE_EIGHTH         200
 
 // Initialize constant PWM duty cycle values for the motors
 #define PWM_NOMINAL         3500 //3500
@@ -55,6 +52,20 @@ double Kd = 1.0;         // derivative constant
 #define PWM_MIN             (PWM_NOMINAL - PWM_SWING)
 #define PWM_MAX             (PWM_NOMINAL + PWM_SWING)
 
+// PID controller gains in Q16.16 format
+#define PID_KP              PID_Q16(20.0)   // proportional constant
+#define PID_KI              PID_Q16(0.0)    // integral constant
+#define PID_KD              PID_Q16(1.0)    // derivative constant
+#define PID_DERIVATIVE_LPF  PID_Q16(0.5)    // derivative low-pass filter smoothing factor
+
+// PID controller used to keep the line centered under the sensor array
+PID_Controller Line_PID;
+int32_t PID = 0;        // PID to change PWM values
+
+// Reflectance sensor charge and decay times in microseconds
+#define REFLECTANCE_CHARGE_TIME 10
+#define REFLECTANCE_DECAY_TIME  1000
+
 #define LOWER_BOUND         47 // 47
 #define UPPER_BOUND         332 // 332
 // Declare global variables used to update PWM duty cycle values for the motors
@@ -69,12 +80,12 @@ uint8_t Line_Sensor_Data;
 // Declare global variable used to store line sensor position
 int32_t Line_Sensor_Position;
 
-// Global variable counter to keep track of the number of SysTick interrupts
-// that have occurred. It increments in SysTick_Handler on each interrupt event.
-uint32_t SysTick_counter = 0;
-
-int dead_right = 0;
-int ignore_left = 0;
+// Turn flags set by Line_Follower_FSM_1 (thread mode) and read by Line_Sensor_Handler (TA1_N).
+// They are not part of Control_Frame, which flows the other way. Each flag is one aligned word
+// with a single writer, so a store is atomic, and the handler reads ignore_left once per reading,
+// so a whole reading is processed with either the old or the new value. dead_right is not read.
+volatile int dead_right = 0;
+volatile int ignore_left = 0;
 
 // Define the states for the Line Follower FSM
 typedef enum
@@ -92,51 +103,116 @@ typedef enum
 
 // Initialize the current state to CENTER
 Line_Follower_State current_state = CENTER;
-/** @brief This function handles the robot's collision function. It will stop then back up, 
- * turn around, then play a tune. It is designed to no longer move after handling this collision.
+
+// Control frame published by Line_Sensor_Handler and applied by Line_Follower_FSM_1
+typedef struct
+{
+    uint16_t duty_cycle_left;
+    uint16_t duty_cycle_right;
+    uint32_t state;
+} Control_Frame;
+
+// Channel used to pass the control frame between the two interrupt handlers
+// without tearing the duty cycle pair
+Snapshot_Channel Control_Channel;
+// Melody played by the buzzer after a collision
+const Buzzer_Note Note_Pattern_1[] =
+{
+    {BUZZER_NOTE_D4,  NOTE_QUARTER}, {BUZZER_NOTE_G4,  NOTE_QUARTER}, {BUZZER_NOTE_G4,  NOTE_EIGHTH},  {BUZZER_NOTE_A4,  NOTE_EIGHTH},
+    {BUZZER_NOTE_G4,  NOTE_EIGHTH},  {BUZZER_NOTE_F4S, NOTE_EIGHTH},  {BUZZER_NOTE_E4,  NOTE_QUARTER}, {BUZZER_NOTE_E4,  NOTE_QUARTER},
+    {BUZZER_NOTE_E4,  NOTE_QUARTER}, {BUZZER_NOTE_A4,  NOTE_QUARTER}, {BUZZER_NOTE_A4,  NOTE_EIGHTH},  {BUZZER_NOTE_B4,  NOTE_EIGHTH},
+    {BUZZER_NOTE_A4,  NOTE_EIGHTH},  {BUZZER_NOTE_G4,  NOTE_EIGHTH},  {BUZZER_NOTE_F4S, NOTE_QUARTER}, {BUZZER_NOTE_D4,  NOTE_QUARTER},
+    {BUZZER_NOTE_D4,  NOTE_QUARTER}, {BUZZER_NOTE_B4,  NOTE_QUARTER}, {BUZZER_NOTE_B4,  NOTE_EIGHTH},  {BUZZER_NOTE_C5,  NOTE_EIGHTH},
+    {BUZZER_NOTE_B4,  NOTE_EIGHTH},  {BUZZER_NOTE_A4,  NOTE_EIGHTH},  {BUZZER_NOTE_G4,  NOTE_QUARTER}, {BUZZER_NOTE_E4,  NOTE_QUARTER},
+    {BUZZER_NOTE_D4,  NOTE_EIGHTH},  {BUZZER_NOTE_D4,  NOTE_EIGHTH},  {BUZZER_NOTE_E4,  NOTE_QUARTER}, {BUZZER_NOTE_A4,  NOTE_QUARTER},
+    {BUZZER_NOTE_F4S, NOTE_QUARTER}, {BUZZER_NOTE_G4,  NOTE_QUARTER}
+};
+
+// Collision recovery step durations in milliseconds (scheduler ticks of Motor_Control_Task)
+#define COLLISION_STOP_TIME     50
+#define COLLISION_REVERSE_TIME  200
+#define COLLISION_PAUSE_TIME    50
+#define COLLISION_TURN_TIME     250
+
+// Collision recovery motor duty cycle
+#define COLLISION_PWM           4500
+
+// Set when the collision recovery has finished, cleared by Line_Sensor_Handler
+// once it has restarted the line search
+volatile uint8_t Line_Search_Request = 0;
+
+/**
+ * @brief Stops the motors at the beginning of the collision recovery.
+ *
+ * @return None
  */
-void Handle_Collision()
+void Collision_Stop()
 {
-    // Stop the motors
     Motor_Stop();
-    // Make a function call to Clock_Delay1ms(2000)
-    Clock_Delay1ms(1000);
-
-    // Flash the LEDs to indicate collision event after stopping the motors
-    for (int i = 0; i < 5; i++)
-    {
-        LED1_Output(RED_LED_OFF);
-        LED2_Output(RGB_LED_OFF);
-        Clock_Delay1ms(200);
-        LED1_Output(RED_LED_ON);
-        LED2_Output(RGB_LED_RED);
-        Clock_Delay1ms(200);
-    }
+    LED1_Output(RED_LED_ON);
+    LED2_Output(RGB_LED_RED);
+}
 
-    // Move the motors backward with 30% duty cycle
-    Motor_Backward(4500, 4500);
-    // Make a function call to Clock_Delay1ms(3000)
-    Clock_Delay1ms(500);
+/**
+ * @brief Backs away from the obstacle.
+ *
+ * @return None
+ */
+void Collision_Reverse()
+{
+    Motor_Backward(COLLISION_PWM, COLLISION_PWM);
+    LED2_Output(RGB_LED_PINK);
+}
 
-    // Stop the motors
+/**
+ * @brief Stops the motors between the reverse and turn steps.
+ *
+ * @return None
+ */
+void Collision_Pause()
+{
     Motor_Stop();
-    // Make a function call to Clock_Delay1ms(1000)
-    Clock_Delay1ms(500);
+}
+
+/**
+ * @brief Turns to the right, away from the obstacle.
+ *
+ * @return None
+ */
+void Collision_Turn()
+{
+    Motor_Right(COLLISION_PWM, COLLISION_PWM);
+    LED2_Output(RGB_LED_WHITE);
+}
 
-    // Make the robot turn to the right with 10% duty cycle
-    Motor_Right(4500, 4500);
-    // Make a function call to Clock_Delay1ms(5000)
-    Clock_Delay1ms(1300);
+/**
+ * @brief Called after the last step of the collision recovery. It asks Line_Sensor_Handler to
+ * search for the line again, hands the motors back to Line_Follower_FSM_1 and plays a tune.
+ *
+ * @return None
+ */
+void Collision_Recovery_Done()
+{
+    LED1_Output(RED_LED_OFF);
+    Line_Search_Request = 1;
+    LOG("Collision recovery done");
 
-    // Stop the motors
-    Motor_Stop();
+    // Play the tune in the background unless it is already playing
+    if (Buzzer_Busy() == 0) Buzzer_Play(Note_Pattern_1, sizeof(Note_Pattern_1) / sizeof(Note_Pattern_1[0]));
+}
 
-    Note_Pattern_1();
-    while(1){
+// Collision recovery sequence: stop, reverse, stop, turn, then resume the line search
+const Sequencer_Step Collision_Recovery_Steps[] =
+{
+    {&Collision_Stop,       COLLISION_STOP_TIME},
+    {&Collision_Reverse,    COLLISION_REVERSE_TIME},
+    {&Collision_Pause,      COLLISION_PAUSE_TIME},
+    {&Collision_Turn,       COLLISION_TURN_TIME}
+};
 
-    }
+// Sequencer that runs the collision recovery from Motor_Control_Task
+Sequencer Collision_Sequencer;
 
-}
 /**
  * @brief Implements the finite state machine (FSM) for a simple Line Follower robot.
  *
@@ -150,7 +226,11 @@ void Handle_Collision()
  */
 void Line_Follower_FSM_1()
 {
-    switch(current_state)
+    // Take a consistent copy of the latest state and duty cycles
+    Control_Frame frame;
+    Snapshot_Read(&Control_Channel, &frame);
+
+    switch(frame.state)
     {
         case LEFT_T:
         {
@@ -158,9 +238,9 @@ void Line_Follower_FSM_1()
             LED2_Output(RGB_LED_BLUE);
             ignore_left = 0;
             dead_right = 0;
-            Duty_Cycle_Left = PWM_NOMINAL;
-            Duty_Cycle_Right = PWM_NOMINAL;
-            Motor_Forward(Duty_Cycle_Left, Duty_Cycle_Right);
+            frame.duty_cycle_left = PWM_NOMINAL;
+            frame.duty_cycle_right = PWM_NOMINAL;
+            Motor_Forward(frame.duty_cycle_left, frame.duty_cycle_right);
             break;
         }
         case R3:
@@ -169,7 +249,7 @@ void Line_Follower_FSM_1()
             LED2_Output(RGB_LED_RED);
             dead_right = 1;
             ignore_left = 1;
-            Motor_Right(Duty_Cycle_Left, Duty_Cycle_Right);
+            Motor_Right(frame.duty_cycle_left, frame.duty_cycle_right);
             break;
         }
         case R1:
@@ -178,7 +258,7 @@ void Line_Follower_FSM_1()
             LED2_Output(RGB_LED_OFF);
             dead_right = 1;
             ignore_left = 0;
-            Motor_Forward(Duty_Cycle_Left, Duty_Cycle_Right);
+            Motor_Forward(frame.duty_cycle_left, frame.duty_cycle_right);
             break;
         }
         case CENTER:
@@ -186,7 +266,7 @@ void Line_Follower_FSM_1()
             LED1_Output(RGB_LED_GREEN);
             LED2_Output(RGB_LED_GREEN);
             ignore_left = 0;
-            Motor_Forward(Duty_Cycle_Left, Duty_Cycle_Right);
+            Motor_Forward(frame.duty_cycle_left, frame.duty_cycle_right);
             break;
         }
         case L1:
@@ -195,13 +275,13 @@ void Line_Follower_FSM_1()
             LED2_Output(RGB_LED_YELLOW);
             dead_right = 0;
             ignore_left = 0;
-            Motor_Forward(Duty_Cycle_Left, Duty_Cycle_Right);
+            Motor_Forward(frame.duty_cycle_left, frame.duty_cycle_right);
             break;
         }
         case DEAD_END:
         {
             ignore_left = 0;
-            Motor_Left(Duty_Cycle_Left, Duty_Cycle_Right);
+            Motor_Left(frame.duty_cycle_left, frame.duty_cycle_right);
             LED2_Output(RGB_LED_SKY_BLUE);
             break;
         }
@@ -209,205 +289,187 @@ void Line_Follower_FSM_1()
 }
 
 
-/* @brief PID controller function is used for self correction when following the line.
- *
- * @param double actual
+/**
+ * @brief Processes one reading of the reflectance sensor array for the line follower.
  *
+ * This function is called from TA1_N_IRQHandler when the read started by Line_Sensor_Task
+ * completes. It updates the line position, the PID correction, the next state of the FSM and
+ * the motor duty cycles.
  *
- * @return double PID
+ * @param line_sensor_data 8-bit reading from the reflectance sensor array.
  *
+ * @return None
  */
-double pidController(double actual) {
-
-    double error = desired - actual;    // calculated error
-    double proportional = Kp * error;              // proportional term,   Kp global
-    integral += Ki * error;                    // integral term,       Ki global
-    double derivative = Kd * (error - previous);     // derivative term,     Kd global
-    double PID = proportional + integral + derivative;             // total PID
-    previous = error;                       // set prev to current error
-    return PID;
-}
+void Line_Sensor_Handler(uint8_t line_sensor_data)
+{
+    Line_Follower_State previous_state = current_state;
+    Line_Sensor_Data = line_sensor_data;
 
+    // Read ignore_left once, so that the whole reading is processed with the same value
+    uint8_t shifted = (ignore_left == 1);
 
+    // Look up the position and intersection class of the reading,
+    // shifted right by one bit when the leftmost sensor is ignored
+    const Reflectance_Sensor_Line *line = &Reflectance_Sensor_Table[shifted][Line_Sensor_Data];
+    if(shifted) Line_Sensor_Data = Line_Sensor_Data >> 1;
+    Line_Sensor_Position = line->position;
 
-/**
- * @brief The Line follower program follows a line, prioritizing the right turns. The robot fully explores 
- * any intersection. Once an object has collided with its bumper sensors. It will back up and play a tune.
- *
- *
- * @return None
- */
-void Line_Follower_Controller_2()
-{
-    // Increment SysTick_counter by 1 every time the SysTick periodic interrupt occurs
-    SysTick_counter = SysTick_counter + 1;
+    // The correction is limited so that both duty cycles stay within PWM_MIN and PWM_MAX
+    PID = PID_Update(&Line_PID, 0, Line_Sensor_Position);
 
-    // Start the process of reading the reflectance sensor array every 10 ms (i.e. 11, 21, 31, ...)
-    if ((SysTick_counter % 10) == 1)
+    // After a collision, search for the line from scratch
+    if (Line_Search_Request)
     {
-        Reflectance_Sensor_Start();
+        Line_Search_Request = 0;
+        PID_Reset(&Line_PID);
+        PID = 0;
+        current_state = DEAD_END;
     }
 
-    // Finish reading the reflectance sensor sensor array after 1 ms (i.e. 12, 22, 32, ...)
-    if ((SysTick_counter % 10) == 2)
+    if (current_state == DEAD_END){
+        if(-48 < Line_Sensor_Position && Line_Sensor_Position < 48)
+            current_state = CENTER;
+        else
+            current_state = DEAD_END;
+    }
+    else if (current_state == R3){
+        if(Line_Sensor_Position > 48 && Line_Sensor_Position < 238)
+            current_state = R1;
+        else
+            current_state = R3;
+    }
+    else if(line->line_class == REFLECTANCE_LINE_NONE) {
+        current_state = DEAD_END;
+    }
+    else if(line->line_class == REFLECTANCE_LINE_RIGHT_BRANCH || line->line_class == REFLECTANCE_LINE_CROSS) {
+        current_state = R3;
+    }
+    else if(line->line_class == REFLECTANCE_LINE_LEFT_BRANCH) {
+        current_state = LEFT_T;
+    }
+    else if(Line_Sensor_Position >= 48){
+        current_state = R1;
+    }
+    else if(Line_Sensor_Position <= -48){
+        current_state = L1;
+    }
+    else if(-48 < Line_Sensor_Position && Line_Sensor_Position < 48)
     {
-        Line_Sensor_Data = Reflectance_Sensor_End();
-        if(ignore_left == 1) Line_Sensor_Data = Line_Sensor_Data >> 1;
-        Line_Sensor_Position = Reflectance_Sensor_Position(Line_Sensor_Data);
+        current_state = CENTER;
+    }
+    else{
+        current_state = DEAD_END;
+    }
 
-        PID = pidController(Line_Sensor_Position);
+    if (current_state != previous_state)
+    {
+        LOG("State %d -> %d at position %d (sensors 0x%02X)", previous_state, current_state, Line_Sensor_Position, Line_Sensor_Data);
+    }
 
-        if (current_state == DEAD_END){
-            if(-48 < Line_Sensor_Position && Line_Sensor_Position < 48)
-                current_state = CENTER;
-            else
-                current_state = DEAD_END;
-        }
-        else if (current_state == R3){
-            if(Line_Sensor_Position > 48 && Line_Sensor_Position < 238)
-                current_state = R1;
-            else
-                current_state = R3;
-        }
-        else if(Line_Sensor_Data == 0) {
-            current_state = DEAD_END;
-        }
-        else if(Line_Sensor_Data & 0xF == 0xF) {
-            current_state = R3;
-        }
-        else if(Line_Sensor_Data & 0xF0 == 0xF0) {
-            current_state = LEFT_T;
-        }
-        else if(Line_Sensor_Position >= 48){
-            current_state = R1;
-        }
-        else if(Line_Sensor_Position <= -48){
-            current_state = L1;
-        }
-        else if(-48 < Line_Sensor_Position && Line_Sensor_Position < 48)
-        {
-            current_state = CENTER;
-        }
-        else{
-            current_state = DEAD_END;
-        }
+    Duty_Cycle_Right = PWM_NOMINAL + PID;
+    Duty_Cycle_Left = PWM_NOMINAL - PID;
 
-        Duty_Cycle_Right = PWM_NOMINAL + PID;
-        Duty_Cycle_Left = PWM_NOMINAL - PID;
+    // Ensure that the duty cycle for the right motor does not go below the minimum PWM value
+    if (Duty_Cycle_Right < PWM_MIN) Duty_Cycle_Right = PWM_MIN;
 
-        // Ensure that the duty cycle for the right motor does not go below the minimum PWM value
-        if (Duty_Cycle_Right < PWM_MIN) Duty_Cycle_Right = PWM_MIN;
+    // Ensure that the duty cycle for the right motor does not exceed the maximum PWM value
+    if (Duty_Cycle_Right > PWM_MAX) Duty_Cycle_Right = PWM_MAX;
 
-        // Ensure that the duty cycle for the right motor does not exceed the maximum PWM value
-        if (Duty_Cycle_Right > PWM_MAX) Duty_Cycle_Right = PWM_MAX;
+    // Ensure that the duty cycle for the left motor does not go below the minimum PWM value
+    if (Duty_Cycle_Left  < PWM_MIN) Duty_Cycle_Left  = PWM_MIN;
 
-        // Ensure that the duty cycle for the left motor does not go below the minimum PWM value
-        if (Duty_Cycle_Left  < PWM_MIN) Duty_Cycle_Left  = PWM_MIN;
+    // Ensure that the duty cycle for the left motor does not exceed the maximum PWM value
+    if (Duty_Cycle_Left  > PWM_MAX) Duty_Cycle_Left  = PWM_MAX;
 
-        // Ensure that the duty cycle for the left motor does not exceed the maximum PWM value
-        if (Duty_Cycle_Left  > PWM_MAX) Duty_Cycle_Left  = PWM_MAX;
-    }
-}
+    // Publish the new state and duty cycles to Line_Follower_FSM_1
+    Control_Frame frame = {Duty_Cycle_Left, Duty_Cycle_Right, current_state};
+    Snapshot_Write(&Control_Channel, &frame);
 
-void Bumper_Sensors_Handler(uint8_t bumper_sensor_state)
-{
-    Handle_Collision();
+#ifdef TELEMETRY_ACTIVE
+    // Log the reading and the resulting control outputs
+    Telemetry_Record record = {Scheduler_Get_Ticks(), Line_Sensor_Position, PID,
+                               Duty_Cycle_Left, Duty_Cycle_Right, Line_Sensor_Data, current_state};
+    Telemetry_Push(&record);
+#endif
 }
 
 /**
- * @brief This function is the handler for the SysTick periodic interrupt with a rate of 1 kHz.
+ * @brief Starts reading the reflectance sensor array. Released by the scheduler every 10 ms.
  *
- * The SysTick_Handler generates a periodic interrupt that calls a specific controller function based on the selected
- * active configuration. Only one of the options can be defined at a time: CONTROLLER_1 or CONTROLLER_2.
+ * Line_Sensor_Handler receives the reading after the charge and decay times.
  *
  * @return None
  */
-void SysTick_Handler(void)
+void Line_Sensor_Task()
 {
-    Line_Follower_Controller_2();
+    Reflectance_Sensor_Sample_Start(REFLECTANCE_CHARGE_TIME, REFLECTANCE_DECAY_TIME, &Line_Sensor_Handler);
 }
 
-void Detect_Edge(uint16_t time)
-{
-    // Your code for Task 1 goes here
-    Edge_Counter = Edge_Counter + 1;
-}
 /**
- * @brief User-defined function executed by Timer A1 using a periodic interrupt at a rate of 1 kHz.
+ * @brief Applies the latest control frame to the motors. Released by the scheduler every 1 ms.
  *
+ * The collision recovery drives the motors until it is done.
  *
  * @return None
  */
-uint8_t Done = 0;
-void Timer_A1_Periodic_Task(void)
+void Motor_Control_Task()
 {
-    // Your function for Task 1 goes here (Line_Follower_FSM_2)
+    if (Sequencer_Tick(&Collision_Sequencer)) return;
+
     Line_Follower_FSM_1();
 }
+
+#ifdef ISR_PROFILE_ACTIVE
 /**
- * @brief Used to set up piezo buzzer
+ * @brief Prints the interrupt handler statistics every 5 seconds and starts a new measurement window.
  *
+ * @note The UART transmission blocks for several milliseconds, which delays the other tasks.
  *
  * @return None
  */
-void Buzzer_Init()
+void ISR_Profile_Task()
 {
-    P10->SEL0 &= ~0x01;
-    P10->SEL1 &= ~0x01;
-    P10->DIR |= 0x01;
+    ISR_Profile_Dump();
+    ISR_Profile_Reset();
 }
-/**
- * @brief returns value of the buzzer.
- *
- *
- * @return int buzzer_value
- */
-int Buzzer_Output(uint8_t buzzer_value)
+#endif
+
+// Task table of the scheduler: task, period (ms), phase (ms), priority
+Scheduler_Task Tasks[] =
 {
-    P10->OUT = buzzer_value;
-    return ((buzzer_value != 0) ? 1 : 0);
-}
+    {.task = &Line_Sensor_Task,     .period = 10,   .phase = 1,   .priority = 0},
+    {.task = &Motor_Control_Task,   .period = 1,    .phase = 0,   .priority = 1},
+#ifdef ISR_PROFILE_ACTIVE
+    {.task = &ISR_Profile_Task,     .period = 5000, .phase = 500, .priority = 2},
+#endif
+#ifdef TELEMETRY_ACTIVE
+    {.task = &Telemetry_Task,       .period = 10,   .phase = 5,   .priority = 2},
+#endif
+#ifdef LOG_ACTIVE
+    {.task = &Log_Task,             .period = 10,   .phase = 7,   .priority = 2},
+#endif
+};
+
 /**
- * @brief Allows for a certain note to be played.
+ * @brief Called from PORT4_IRQHandler when a bumper sensor is pressed.
  *
+ * The collision recovery runs from Motor_Control_Task, so this handler only requests it.
+ * A bump during the recovery restarts it from the first step.
+ *
+ * @param bumper_sensor_state 6-bit value representing the state of the bumper sensors.
  *
  * @return None
  */
-void Play_Note(int note_delay_value)
+void Bumper_Sensors_Handler(uint8_t bumper_sensor_state)
 {
-    int Buzzer_Status = Buzzer_Output(0x00);
-    Clock_Delay1us(note_delay_value);
-    Buzzer_Status = Buzzer_Output(0x01);
-    Clock_Delay1us(note_delay_value);
+    LOG("Bump: sensors 0x%02X", bumper_sensor_state);
+    Sequencer_Start(&Collision_Sequencer);
 }
 
-/* A note pattern of C,F,B is generated by the piezo buzzer
- * 
-*/
-void Note_Pattern_1(void) {
-    int a[62] = {D4_NOTE_FREQ,  G4_NOTE_FREQ,   G4_NOTE_FREQ,   A4_NOTE_FREQ,
-                G4_NOTE_FREQ,   F4S_NOTE_FREQ,  E4_NOTE_FREQ,   E4_NOTE_FREQ,
-                E4_NOTE_FREQ,   A4_NOTE_FREQ,   A4_NOTE_FREQ,   B4_NOTE_FREQ,
-                A4_NOTE_FREQ,   G4_NOTE_FREQ,   F4S_NOTE_FREQ,  D4_NOTE_FREQ,
-                D4_NOTE_FREQ,   B4_NOTE_FREQ,   B4_NOTE_FREQ,   C5_NOTE_FREQ,
-                B4_NOTE_FREQ,   A4_NOTE_FREQ,   G4_NOTE_FREQ,   E4_NOTE_FREQ,
-                D4_NOTE_FREQ,   D4_NOTE_FREQ,   E4_NOTE_FREQ,   A4_NOTE_FREQ,
-                F4S_NOTE_FREQ,  G4_NOTE_FREQ};
-    int b[62] = {BUZZER_DURATION,   BUZZER_DURATION,    BUZZER_DURATION/2,  BUZZER_DURATION/2,
-                BUZZER_DURATION/2,  BUZZER_DURATION/2,  BUZZER_DURATION,    BUZZER_DURATION,
-                BUZZER_DURATION,    BUZZER_DURATION,    BUZZER_DURATION/2,  BUZZER_DURATION/2,
-                BUZZER_DURATION/2,  BUZZER_DURATION/2,  BUZZER_DURATION,    BUZZER_DURATION,
-                BUZZER_DURATION,    BUZZER_DURATION,    BUZZER_DURATION/2,  BUZZER_DURATION/2,
-                BUZZER_DURATION/2,  BUZZER_DURATION/2,  BUZZER_DURATION,    BUZZER_DURATION,
-                BUZZER_DURATION/2,  BUZZER_DURATION/2,  BUZZER_DURATION,    BUZZER_DURATION,
-                BUZZER_DURATION,    BUZZER_DURATION};
-    for (int i = 0; i < sizeof(a)/sizeof(a[0]); i++) {
-        for (int j = 0; j < b[i]; j++)
-        {
-            Play_Note(a[i]);
-        }
-        Clock_Delay1us(BUZZER_DURATION);
-    }
+void Detect_Edge(uint16_t time)
+{
+    // Your code for Task 1 goes here
+    Edge_Counter = Edge_Counter + 1;
 }
 
 int main(void)
@@ -419,6 +481,25 @@ int main(void)
     // Initialize the 48 MHz Clock
     Clock_Init48MHz();
 
+    // Start the interrupt handler measurements (only if ISR_PROFILE_ACTIVE is defined)
+#ifdef ISR_PROFILE_ACTIVE
+    EUSCI_A0_UART_Init();
+#endif
+    ISR_Profile_Init();
+
+    // Start the telemetry stream on EUSCI_A0 (only if TELEMETRY_ACTIVE is defined)
+#ifdef TELEMETRY_ACTIVE
+    EUSCI_A0_UART_Init();
+    Telemetry_Init(TELEMETRY_DIVIDER);
+#endif
+
+    // Start the deferred log on EUSCI_A0 (only if LOG_ACTIVE is defined)
+#ifdef LOG_ACTIVE
+    EUSCI_A0_UART_Init_Buffered();
+#endif
+    Log_Init();
+
+    // Initialize the piezo buzzer
     Buzzer_Init();
 
     // Initialize the built-in red LED
@@ -428,15 +509,16 @@ int main(void)
     // Initialize the buttons
     //Buttons_Init();
 
+    // Initialize the collision recovery sequence
+    Sequencer_Init(&Collision_Sequencer, Collision_Recovery_Steps,
+                   sizeof(Collision_Recovery_Steps) / sizeof(Collision_Recovery_Steps[0]), &Collision_Recovery_Done);
+
     // Initialize bumper sensors
     Bumper_Sensors_Init(&Bumper_Sensors_Handler);
 
     // Initialize EUSCI_A0_UART
     //EUSCI_A0_UART_Init_Printf();
 
-    // Initialize Timer A1 periodic interrupt with a rate of 1 kHz
-    Timer_A1_Interrupt_Init(&Timer_A1_Periodic_Task, TIMER_A1_INT_CCR0_VALUE);
-
     // Initialize the tachometers
     //Tachometer_Init();
 
@@ -450,14 +532,23 @@ int main(void)
     Duty_Cycle_Left  = PWM_NOMINAL;
     Duty_Cycle_Right = PWM_NOMINAL;
 
-    // Initialize SysTick periodic interrupt with a rate of 1 kHz
-    SysTick_Interrupt_Init(SYSTICK_INT_NUM_CLK_CYCLES, SYSTICK_INT_PRIORITY);
+    // Initialize the control frame used by the Line Follower FSM
+    Control_Frame initial_frame = {Duty_Cycle_Left, Duty_Cycle_Right, current_state};
+    Snapshot_Init(&Control_Channel, &initial_frame, sizeof(initial_frame));
+
+    // Initialize the line following PID controller
+    PID_Init(&Line_PID, PID_KP, PID_KI, PID_KD, -PWM_SWING, PWM_SWING);
+    PID_Set_Derivative_Filter(&Line_PID, PID_DERIVATIVE_LPF);
+
+    // Initialize the scheduler and its 1 kHz timebase (Timer A1)
+    Scheduler_Init(Tasks, sizeof(Tasks) / sizeof(Tasks[0]));
 
     // Enable the interrupts used by Timer A1 and other modules
     EnableInterrupts();
 
     while(1)
     {
-
+        // Run the released tasks, then sleep until the next interrupt
+        Scheduler_Dispatch();
     }
 }
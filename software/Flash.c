@@ -0,0 +1,77 @@
+/**
+ * @file Flash.c
+ * @brief Source code for the Flash driver.
+ *
+ * This file contains the function definitions for the Flash driver.
+ *
+ * The sector is erased with a sector erase and programmed one 32-bit word at a time in
+ * immediate mode: each write to the flash address starts the programming of that word.
+ * The write protection of the sector is only removed for the duration of Flash_Info_Write.
+ *
+ * For more information regarding the flash controller, refer to the Flash Controller section (9)
+ * of the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../inc/Flash.h"
+
+const volatile void *Flash_Info_Read(void)
+{
+    return FLASH_INFO_MEMORY;
+}
+
+bool Flash_Info_Write(const void *data, uint32_t length)
+{
+    volatile uint32_t *memory = FLASH_INFO_MEMORY;
+    const uint8_t *bytes = data;
+    bool ok = true;
+
+    if (length > FLASH_INFO_SECTOR_SIZE) return false;
+
+    // A record that the boot code would parse as a boot-override mailbox is never written
+    uint32_t first = 0xFFFFFFFF;
+    memcpy(&first, bytes, (length < 4) ? length : 4);
+    if (first == FLASH_INFO_MAILBOX_START) return false;
+
+    // Remove the write protection of bank 0 info sector 0
+    FLCTL->BANK0_INFO_WEPROT &= ~FLCTL_BANK0_INFO_WEPROT_PROT0;
+
+    // Sector erase of the information memory
+    FLCTL->CLRIFG = FLCTL_CLRIFG_ERASE | FLCTL_CLRIFG_PRG_ERR;
+    FLCTL->ERASE_CTLSTAT = (FLCTL->ERASE_CTLSTAT & ~(FLCTL_ERASE_CTLSTAT_MODE | FLCTL_ERASE_CTLSTAT_TYPE_MASK))
+                         | FLCTL_ERASE_CTLSTAT_TYPE_1;
+    FLCTL->ERASE_SECTADDR = FLASH_INFO_SECTOR_ADDRESS;
+    FLCTL->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_START;
+
+    // Wait for the erase to complete
+    while ((FLCTL->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_STATUS_MASK) != FLCTL_ERASE_CTLSTAT_STATUS_3);
+
+    if (FLCTL->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_ADDR_ERR) ok = false;
+    FLCTL->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_CLR_STAT;
+
+    // Immediate programming of full words
+    FLCTL->PRG_CTLSTAT = (FLCTL->PRG_CTLSTAT & ~FLCTL_PRG_CTLSTAT_MODE) | FLCTL_PRG_CTLSTAT_ENABLE;
+
+    for (uint32_t i = 0; ok && 4 * i < length; i++)
+    {
+        uint32_t word = 0xFFFFFFFF;
+        uint32_t count = (length - 4 * i < 4) ? length - 4 * i : 4;
+        memcpy(&word, &bytes[4 * i], count);
+
+        memory[i] = word;
+
+        // Wait for the word to be programmed
+        while (FLCTL->PRG_CTLSTAT & FLCTL_PRG_CTLSTAT_STATUS_MASK);
+
+        if ((FLCTL->IFG & FLCTL_IFG_PRG_ERR) || memory[i] != word) ok = false;
+    }
+
+    FLCTL->PRG_CTLSTAT &= ~FLCTL_PRG_CTLSTAT_ENABLE;
+
+    // Restore the write protection
+    FLCTL->BANK0_INFO_WEPROT |= FLCTL_BANK0_INFO_WEPROT_PROT0;
+
+    return ok;
+}
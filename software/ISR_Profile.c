@@ -0,0 +1,171 @@
+/**
+ * @file ISR_Profile.c
+ * @brief Source code for the ISR_Profile module.
+ *
+ * This file contains the function definitions for measuring the entry latency and execution time
+ * of interrupt handlers with the DWT cycle counter. It is empty unless ISR_PROFILE_ACTIVE is defined.
+ *
+ */
+
+#include "../inc/ISR_Profile.h"
+
+#ifdef ISR_PROFILE_ACTIVE
+
+#include "../inc/CortexM.h"
+#include "../inc/EUSCI_A0_UART.h"
+
+ISR_Profile_Stats ISR_Profile_Latency[ISR_PROFILE_VECTORS];
+ISR_Profile_Stats ISR_Profile_Duration[ISR_PROFILE_VECTORS];
+
+// Value of CYCCNT when the statistics were last cleared
+static uint32_t ISR_Profile_Start;
+
+// Names printed by ISR_Profile_Dump, in the order of ISR_Profile_Vector
+static const char *ISR_Profile_Names[ISR_PROFILE_VECTORS] =
+{
+    "SysTick", "TA1_0", "TA1_N", "TA2_0", "TA3_0", "TA3_N", "PORT4", "PORT6",
+    "EUSCIA0", "EUSCIB1", "DMA_INT0"
+};
+
+static void ISR_Profile_Update(ISR_Profile_Stats *stats, uint32_t value, uint32_t shift)
+{
+    uint32_t bucket = value >> shift;
+    if (bucket >= ISR_PROFILE_BUCKETS) bucket = ISR_PROFILE_BUCKETS - 1;
+
+    stats->histogram[bucket] = stats->histogram[bucket] + 1;
+    if (stats->count == 0 || value < stats->min) stats->min = value;
+    if (value > stats->max) stats->max = value;
+    stats->sum = stats->sum + value;
+    stats->count = stats->count + 1;
+}
+
+void ISR_Profile_Init(void)
+{
+    // Enable the trace unit and start the cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    ISR_Profile_Reset();
+}
+
+void ISR_Profile_Reset(void)
+{
+    long sr = StartCritical();
+
+    for (int i = 0; i < ISR_PROFILE_VECTORS; i++)
+    {
+        ISR_Profile_Stats *stats[2] = {&ISR_Profile_Latency[i], &ISR_Profile_Duration[i]};
+        for (int j = 0; j < 2; j++)
+        {
+            stats[j]->count = 0;
+            stats[j]->min = 0;
+            stats[j]->max = 0;
+            stats[j]->sum = 0;
+            for (int k = 0; k < ISR_PROFILE_BUCKETS; k++) stats[j]->histogram[k] = 0;
+        }
+    }
+    ISR_Profile_Start = DWT->CYCCNT;
+
+    EndCritical(sr);
+}
+
+void ISR_Profile_Record(ISR_Profile_Vector vector, uint32_t latency, uint32_t start)
+{
+    uint32_t duration = DWT->CYCCNT - start;
+
+    // A handler with a higher priority may preempt this one while the statistics are updated
+    long sr = StartCritical();
+
+    ISR_Profile_Update(&ISR_Profile_Duration[vector], duration, ISR_PROFILE_DURATION_SHIFT);
+    if (latency != ISR_PROFILE_NO_LATENCY)
+    {
+        ISR_Profile_Update(&ISR_Profile_Latency[vector], latency, ISR_PROFILE_LATENCY_SHIFT);
+    }
+
+    EndCritical(sr);
+}
+
+uint32_t ISR_Profile_Timer_Latency(Timer_A_Type *timer, uint16_t event)
+{
+    uint32_t count = timer->R;
+    uint32_t period;
+
+    // Only SMCLK is supported as the timer clock source (TASSEL = 10b)
+    if ((timer->CTL & 0x0300) != 0x0200) return ISR_PROFILE_NO_LATENCY;
+
+    switch ((timer->CTL >> 4) & 0x0003)
+    {
+        case 1:     // Up mode
+            period = (uint32_t)timer->CCR[0] + 1;
+            break;
+        case 2:     // Continuous mode
+            period = 65536;
+            break;
+        default:    // Stopped or Up/Down mode
+            return ISR_PROFILE_NO_LATENCY;
+    }
+
+    uint32_t counts = (count + period - event) % period;
+    uint32_t divider = (1 << ((timer->CTL >> 6) & 0x0003)) * ((timer->EX0 & 0x0007) + 1);
+
+    return counts * divider * ISR_PROFILE_SMCLK_CYCLES;
+}
+
+static void ISR_Profile_Print_Stats(char *label, ISR_Profile_Stats *stats)
+{
+    EUSCI_A0_UART_OutString(label);
+    EUSCI_A0_UART_OutString(" min ");
+    EUSCI_A0_UART_OutUDec(stats->min);
+    EUSCI_A0_UART_OutString(" mean ");
+    EUSCI_A0_UART_OutUDec((uint32_t)(stats->sum / stats->count));
+    EUSCI_A0_UART_OutString(" max ");
+    EUSCI_A0_UART_OutUDec(stats->max);
+    EUSCI_A0_UART_OutString(" |");
+    for (int i = 0; i < ISR_PROFILE_BUCKETS; i++)
+    {
+        EUSCI_A0_UART_OutChar(' ');
+        EUSCI_A0_UART_OutUDec(stats->histogram[i]);
+    }
+    EUSCI_A0_UART_OutString("\r\n");
+}
+
+void ISR_Profile_Dump(void)
+{
+    ISR_Profile_Stats latency;
+    ISR_Profile_Stats duration;
+
+    uint32_t elapsed = DWT->CYCCNT - ISR_Profile_Start;
+
+    EUSCI_A0_UART_OutString("ISR profile over ");
+    EUSCI_A0_UART_OutUDec(elapsed / 48000);
+    EUSCI_A0_UART_OutString(" ms (cycles; latency buckets of 8, duration buckets of 128)\r\n");
+
+    for (int i = 0; i < ISR_PROFILE_VECTORS; i++)
+    {
+        // Take a consistent copy, since the handlers keep running while printing
+        long sr = StartCritical();
+        latency = ISR_Profile_Latency[i];
+        duration = ISR_Profile_Duration[i];
+        EndCritical(sr);
+
+        if (duration.count == 0) continue;
+
+        // Share of the CPU in units of 0.01%
+        uint32_t load = (elapsed) ? (uint32_t)((duration.sum * 10000) / elapsed) : 0;
+
+        EUSCI_A0_UART_OutString((char *)ISR_Profile_Names[i]);
+        EUSCI_A0_UART_OutString(": ");
+        EUSCI_A0_UART_OutUDec(duration.count);
+        EUSCI_A0_UART_OutString(" runs, CPU ");
+        EUSCI_A0_UART_OutUDec(load / 100);
+        EUSCI_A0_UART_OutChar('.');
+        EUSCI_A0_UART_OutChar('0' + (load / 10) % 10);
+        EUSCI_A0_UART_OutChar('0' + load % 10);
+        EUSCI_A0_UART_OutString("%\r\n");
+        if (latency.count) ISR_Profile_Print_Stats("  latency ", &latency);
+        ISR_Profile_Print_Stats("  duration", &duration);
+    }
+}
+
+#endif /* ISR_PROFILE_ACTIVE */
@@ -1,6 +1,6 @@
 // LPF.c
 // Runs on MSP432
-// implements three FIR low-pass filters
+// implements FIR low-pass filters
 
 // Jonathan Valvano
 // September 12, 2017
@@ -43,172 +43,101 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include "msp.h"
 #include "../inc/LPF.h"
 
-// Newton's method
+// Digit-by-digit method, one result bit per iteration
 // s is an integer
-// sqrt(s) is an integer
+// sqrt(s) is an integer, rounded down
 uint32_t isqrt(uint32_t s){
-uint32_t t;         // t*t will become s
-int n;                   // loop counter to make sure it stops running
-  t = s/10+1;            // initial guess
-  for(n = 16; n; --n){   // guaranteed to finish
-    t = ((t*t+s)/t)/2;
+uint32_t t = 0;          // result so far
+uint32_t bit = 1u<<30;   // highest power of 4 that fits
+  while(bit > s){
+    bit >>= 2;
+  }
+  while(bit){            // at most 16 iterations
+    if(s >= t+bit){
+      s = s-(t+bit);
+      t = (t>>1)+bit;
+    } else{
+      t = t>>1;
+    }
+    bit >>= 2;
   }
   return t;
 }
 
 //**************Low pass Digital filter**************
-uint32_t Size;      // Size-point average, Size=1 to 512
-uint32_t x[1024];   // two copies of MACQ
-uint32_t *Pt;       // pointer to current
-uint32_t I1;        // index to oldest
-uint32_t LPFSum;    // sum of the last Size samples
-void LPF_Init_old(uint32_t initial, uint32_t size){ int i;
-  if(size>512) size=512; // max
-  Size = size;
-  Pt = &x[0];
-  LPFSum = Size*initial; // prime MACQ with initial data
-  for(i=0; i<2*Size; i++){
-    x[i] = initial;
-  }
-}
-// calculate one filter output, called at sampling rate
-// Input: new ADC data   Output: filter output
-// y(n) = (x(n)+x(n-1)+...+x(n-Size-1)/Size
-uint32_t LPF_Calc_old(uint32_t newdata){
-  if(Pt == &x[0]){
-    Pt = &x[Size-1];              // wrap
-  } else{
-    Pt--;                         // make room for data
+// Each filter keeps the last size samples of its channels in its own buffer,
+// so filters of different depths are independent
+// The storage is not zeroed at reset (LPF_NOINIT), it is all written here
+void LPF_Init(LPF_Filter *filter, uint32_t initial){ uint32_t i;
+  initial = (uint16_t)initial;  // samples are stored on 16 bits
+  filter->index = 0;
+  for(i=0; i<filter->channels; i++){
+    filter->sum[i] = filter->size*initial; // prime MACQ with initial data
+    filter->squares[i] = (uint64_t)filter->size*initial*initial;
   }
-  LPFSum = LPFSum+newdata -*Pt;   // subtract oldest, add newest
-  *Pt = *(Pt+Size) = newdata;     // two copies of the new data
-  return LPFSum/Size;
-}
-
-void LPF_Init(uint32_t initial, uint32_t size){ int i;
-  if(size>1024) size=1024; // max
-  Size = size;
-  I1 = Size-1;
-  LPFSum = Size*initial; // prime MACQ with initial data
-  for(i=0; i<Size; i++){
-    x[i] = initial;
+  for(i=0; i<filter->size*filter->channels; i++){
+    filter->buffer[i] = initial;
   }
 }
 // calculate one filter output, called at sampling rate
 // Input: new ADC data   Output: filter output
 // y(n) = (x(n)+x(n-1)+...+x(n-Size-1)/Size
-uint32_t LPF_Calc(uint32_t newdata){
-  if(I1 == 0){
-    I1 = Size-1;              // wrap
-  } else{
-    I1--;                     // make room for data
-  }
-  LPFSum = LPFSum+newdata-x[I1];   // subtract oldest, add newest
-  x[I1] = newdata;     // save new data
-  return LPFSum/Size;
-}
-// calculate noise as standard deviation, called every time buffer refills
-// Input: none   Output: standard deviation
-int32_t Noise(void){ int32_t sum,mean,sigma;
-  if(Size<2) return 0;
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+x[i];
-  }
-  mean = sum/Size; // DC component
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+(x[i]-mean)*(x[i]-mean); // total energy in AC part
+uint32_t LPF_Calc(LPF_Filter *filter, uint32_t newdata){
+  uint16_t *oldest = &filter->buffer[filter->index];
+  uint16_t data = newdata;                           // samples are stored on 16 bits
+  filter->sum[0] = filter->sum[0]+data-*oldest;      // subtract oldest, add newest
+  filter->squares[0] = filter->squares[0]+(uint32_t)data*data-(uint32_t)*oldest**oldest;
+  *oldest = data;                                    // save new data
+  if(++filter->index == filter->size){
+    filter->index = 0;                               // wrap
   }
-  sigma = isqrt(sum/(Size-1));
-//  snr = mean/sigma;
-  return sigma;
+  return filter->sum[0]/filter->size;
 }
-
-uint32_t x2[1024];   // two copies of MACQ
-uint32_t *Pt2;       // pointer to current
-uint32_t LPFSum2;    // sum of the last Size samples
-void LPF_Init2(uint32_t initial, uint32_t size){ int i;
-  if(size>512) size=512; // max
-  Size = size;
-  Pt2 = &x2[0];
-  LPFSum2 = Size*initial; // prime MACQ with initial data
-  for(i=0; i<2*Size; i++){
-    x2[i] = initial;
+// calculate one filter output per channel, called at sampling rate
+// Input: new ADC data of each channel   Output: filter output of each channel
+void LPF_Calc_Channels(LPF_Filter *filter, const uint32_t *newdata, uint32_t *result){ uint32_t c;
+  uint16_t *oldest = &filter->buffer[filter->index*filter->channels];
+  for(c=0; c<filter->channels; c++){
+    uint16_t data = newdata[c];
+    filter->sum[c] = filter->sum[c]+data-oldest[c];  // subtract oldest, add newest
+    filter->squares[c] = filter->squares[c]+(uint32_t)data*data-(uint32_t)oldest[c]*oldest[c];
+    oldest[c] = data;                                // save new data
+    result[c] = filter->sum[c]/filter->size;
   }
-}
-// calculate one filter output, called at sampling rate
-// Input: new ADC data   Output: filter output, DAC data
-// y(n) = (x(n)+x(n-1)+...+x(n-Size-1)/Size
-uint32_t LPF_Calc2(uint32_t newdata){
-  if(Pt2 == &x2[0]){
-    Pt2 = &x2[Size-1];              // wrap
-  } else{
-    Pt2--;                         // make room for data
+  if(++filter->index == filter->size){
+    filter->index = 0;                               // wrap
   }
-  LPFSum2 = LPFSum2+newdata -*Pt2;   // subtract oldest, add newest
-  *Pt2 = *(Pt2+Size) = newdata;     // two copies of the new data
-  return LPFSum2/Size;
 }
-// calculate noise as standard deviation, called every time buffer refills
-// Input: none   Output: standard deviation
-int32_t Noise2(void){ int32_t sum,mean,sigma2;
-  if(Size<2) return 0;
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+x2[i];
-  }
-  mean = sum/Size; // DC component
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+(x2[i]-mean)*(x2[i]-mean); // total energy in AC part
-  }
-  sigma2 = isqrt(sum/(Size-1));
-//  snr2 = mean/sigma2;
-  return sigma2;
+// filter the three distance sensors in one call, in place
+void LPF_Calc_Distance(LPF_Filter *filter, uint32_t *Ch_17, uint32_t *Ch_14, uint32_t *Ch_16){
+  uint32_t data[3];
+  data[0] = *Ch_17;
+  data[1] = *Ch_14;
+  data[2] = *Ch_16;
+  LPF_Calc_Channels(filter, data, data);
+  *Ch_17 = data[0];
+  *Ch_14 = data[1];
+  *Ch_16 = data[2];
 }
-
-uint32_t x3[1024];   // two copies of MACQ
-uint32_t *Pt3;       // pointer to current
-uint32_t LPFSum3;    // sum of the last Size samples
-void LPF_Init3(uint32_t initial, uint32_t size){ int i;
-  if(size>512) size=512; // max
-  Size = size;
-  Pt3 = &x3[0];
-  LPFSum3 = Size*initial; // prime MACQ with initial data
-  for(i=0; i<2*Size; i++){
-    x3[i] = initial;
-  }
+// calculate variance of one channel from the running sums
+// var = (size*sum(x^2)-sum(x)^2)/(size*(size-1)), exact in integers
+// Input: filter and channel   Output: variance
+uint32_t LPF_Variance(const LPF_Filter *filter, uint32_t channel){
+  uint64_t size = filter->size;
+  uint64_t sum = filter->sum[channel];
+  if(size<2) return 0;
+  return (size*filter->squares[channel]-sum*sum)/(size*(size-1));
 }
-// calculate one filter output, called at sampling rate
-// Input: new ADC data   Output: filter output, DAC data
-// y(n) = (x(n)+x(n-1)+...+x(n-Size-1)/Size
-uint32_t LPF_Calc3(uint32_t newdata){
-  if(Pt3 == &x3[0]){
-    Pt3 = &x3[Size-1];              // wrap
-  } else{
-    Pt3--;                         // make room for data
-  }
-  LPFSum3 = LPFSum3+newdata -*Pt3;   // subtract oldest, add newest
-  *Pt3 = *(Pt3+Size) = newdata;     // two copies of the new data
-  return LPFSum3/Size;
+// calculate noise of one channel as standard deviation
+// Input: filter and channel   Output: standard deviation
+int32_t LPF_Noise(const LPF_Filter *filter, uint32_t channel){
+  return isqrt(LPF_Variance(filter, channel));
 }
-// calculate noise as standard deviation, called every time buffer refills
-// Input: none   Output: standard deviation
-int32_t Noise3(void){ int32_t sum,mean,sigma3;
-  if(Size<2) return 0;
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+x3[i];
-  }
-  mean = sum/Size; // DC component
-  sum = 0;
-  for(int i=0;i<Size;i++){
-    sum = sum+(x3[i]-mean)*(x3[i]-mean); // total energy in AC part
-  }
-  sigma3 = isqrt(sum/(Size-1));
-//  snr3 = mean/sigma3;
-  return sigma3;
+// check if mean/sigma < snr, compared as mean^2 < snr^2*variance
+// Input: filter, channel and minimum snr   Output: true if noisy
+bool LPF_Is_Noisy(const LPF_Filter *filter, uint32_t channel, uint32_t snr){
+  uint64_t mean = filter->sum[channel]/filter->size; // DC component
+  return mean*mean < (uint64_t)snr*snr*LPF_Variance(filter, channel);
 }
 
 int32_t u1,u2,u3;   // last three points
@@ -0,0 +1,126 @@
+/**
+ * @file Log.c
+ * @brief Source code for the Log module.
+ *
+ * This file contains the function definitions for the Log module.
+ *
+ * Each record occupies 3 + n words of the ring buffer: the argument count, the format string
+ * address, the cycle count and the n arguments. Writers may preempt each other, so a record is
+ * reserved and written inside a critical section. Log_Task is the only reader.
+ *
+ */
+
+#include "../inc/Log.h"
+
+#ifdef LOG_ACTIVE
+
+#include "../inc/CortexM.h"
+#include "../inc/EUSCI_A0_UART.h"
+#include "../inc/COBS.h"
+
+// Size of the encoded record: format string address, cycle count and arguments
+#define LOG_RECORD_SIZE     (4 * (2 + LOG_MAX_ARGUMENTS))
+
+// Ring buffer. The indices run freely and are masked on access.
+static uint32_t Log_Buffer[LOG_BUFFER_WORDS];
+static volatile uint32_t Log_Head;
+static volatile uint32_t Log_Tail;
+
+static volatile uint32_t Log_Dropped;
+static uint32_t Log_Reported;
+
+void Log_Init(void)
+{
+    // Enable the DWT cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Log_Head = 0;
+    Log_Tail = 0;
+    Log_Dropped = 0;
+    Log_Reported = 0;
+}
+
+void Log_Write(uint32_t id, uint32_t count, const uint32_t *arguments)
+{
+    uint32_t time = DWT->CYCCNT;
+    long sr = StartCritical();
+    uint32_t head = Log_Head;
+
+    if ((head - Log_Tail) > (LOG_BUFFER_WORDS - 3 - count))
+    {
+        Log_Dropped = Log_Dropped + 1;
+        EndCritical(sr);
+        return;
+    }
+
+    Log_Buffer[head++ & (LOG_BUFFER_WORDS - 1)] = count;
+    Log_Buffer[head++ & (LOG_BUFFER_WORDS - 1)] = id;
+    Log_Buffer[head++ & (LOG_BUFFER_WORDS - 1)] = time;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Log_Buffer[head++ & (LOG_BUFFER_WORDS - 1)] = arguments[i];
+    }
+
+    Log_Head = head;
+    EndCritical(sr);
+}
+
+// Encodes the words of a record and queues the frame. Returns 0 if the transmit ring is too full.
+static uint8_t Log_Send(const uint32_t *words, uint32_t count)
+{
+    uint8_t data[LOG_RECORD_SIZE];
+    uint8_t frame[COBS_FRAME_SIZE(LOG_RECORD_SIZE)];
+
+    if (EUSCI_A0_UART_TX_Free() < sizeof(frame)) return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        data[4 * i] = words[i] & 0xFF;
+        data[4 * i + 1] = (words[i] >> 8) & 0xFF;
+        data[4 * i + 2] = (words[i] >> 16) & 0xFF;
+        data[4 * i + 3] = words[i] >> 24;
+    }
+
+    EUSCI_A0_UART_Write_Buffer(frame, COBS_Encode(data, 4 * count, frame));
+    return 1;
+}
+
+void Log_Task(void)
+{
+    uint32_t words[2 + LOG_MAX_ARGUMENTS];
+
+    // Report the records that were dropped since the last report
+    uint32_t dropped = Log_Dropped;
+    if (dropped != Log_Reported)
+    {
+        words[0] = 0;
+        words[1] = DWT->CYCCNT;
+        words[2] = dropped - Log_Reported;
+        if (Log_Send(words, 3) == 0) return;
+        Log_Reported = dropped;
+    }
+
+    uint32_t tail = Log_Tail;
+    while (tail != Log_Head)
+    {
+        uint32_t count = Log_Buffer[tail & (LOG_BUFFER_WORDS - 1)];
+        for (uint32_t i = 0; i < 2 + count; i++)
+        {
+            words[i] = Log_Buffer[(tail + 1 + i) & (LOG_BUFFER_WORDS - 1)];
+        }
+
+        if (Log_Send(words, 2 + count) == 0) return;
+
+        // Release the record once it has been queued
+        tail = tail + 3 + count;
+        Log_Tail = tail;
+    }
+}
+
+uint32_t Log_Get_Dropped(void)
+{
+    return Log_Dropped;
+}
+
+#endif /* LOG_ACTIVE */
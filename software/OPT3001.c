@@ -71,29 +71,26 @@ typedef union{
 // Declare a config struct used when reading the configuration register
 OPT3001_Config Read_Sensor_Configuration;
 
-/**
- * @brief Writes a single command byte to the OPT3001 light sensor via I2C.
- *
- * @param command The command byte to send to the sensor.
- *
- * @return None
- */
-static void OPT3001_Write_Data(OPT3001_Commands command)
-{
-    EUSCI_B1_I2C_Send_Multiple_Bytes(OPT3001_ADDRESS, &command, 1);
-}
+// Buffer and completion function of the light reading done in the background
+static uint8_t Light_Buffer[2];
+static void (*Light_Done)(OPT3001_Result result);
 
 /**
- * @brief Reads data from the OPT3001 light sensor via I2C.
+ * @brief Reads a 16-bit register from the OPT3001 light sensor via I2C.
+ *
+ * The register address is written and the data is read back after a repeated START.
+ * The function waits until the queued transaction is done.
  *
+ * @param command The command to read the desired register.
  * @param data Pointer to a uint16_t variable where the sensor data will be stored.
  *
  * @return None
  */
-static void OPT3001_Read_Data(uint16_t* data)
+static void OPT3001_Read_Data(OPT3001_Commands command, uint16_t* data)
 {
     uint8_t buffer[2];
-    EUSCI_B1_I2C_Receive_Multiple_Bytes(OPT3001_ADDRESS, buffer, 2);
+    EUSCI_B1_I2C_Transaction transaction = {OPT3001_ADDRESS, {command}, 1, buffer, 2, 0};
+    EUSCI_B1_I2C_Transfer(&transaction);
     *data = buffer[1] + ((uint16_t)buffer[0] << 8);
 }
 
@@ -107,8 +104,7 @@ static void OPT3001_Read_Data(uint16_t* data)
 OPT3001_Result static OPT3001_Read_Register(OPT3001_Commands command)
 {
     OPT3001_Result result;
-    OPT3001_Write_Data(command);
-    OPT3001_Read_Data(&result.RawData);
+    OPT3001_Read_Data(command, &result.RawData);
     return result;
 }
 
@@ -122,14 +118,18 @@ OPT3001_Result static OPT3001_Read_Register(OPT3001_Commands command)
  */
 static void OPT3001_Write_Register(uint8_t register_address, uint16_t register_data)
 {
-    uint8_t buffer[] =
+    EUSCI_B1_I2C_Transaction transaction =
     {
-        register_address,
-        (register_data >> 8) & 0xFF,
-        register_data & 0xFF,
+        OPT3001_ADDRESS,
+        {
+            register_address,
+            (register_data >> 8) & 0xFF,
+            register_data & 0xFF,
+        },
+        3, 0, 0, 0
     };
 
-    EUSCI_B1_I2C_Send_Multiple_Bytes(OPT3001_ADDRESS, buffer, sizeof(buffer));
+    EUSCI_B1_I2C_Transfer(&transaction);
     Clock_Delay1us(10);
 }
 
@@ -153,8 +153,7 @@ void static OPT3001_Write_Configuration(OPT3001_Config config)
 OPT3001_Config static OPT3001_Read_Configuration()
 {
     OPT3001_Config config;
-    OPT3001_Write_Data(CONFIG);
-    OPT3001_Read_Data(&config.RawData);
+    OPT3001_Read_Data(CONFIG, &config.RawData);
     return config;
 }
 
@@ -219,3 +218,33 @@ OPT3001_Result OPT3001_Read_Light()
     // This register contains the most recent light to digital conversion
     return OPT3001_Read_Register(RESULT);
 }
+
+// Called from the EUSCI_B1 interrupt once the Result register has been read
+static void OPT3001_Light_Read(EUSCI_B1_I2C_Status status)
+{
+    OPT3001_Result result;
+    void (*done)(OPT3001_Result result) = Light_Done;
+
+    Light_Done = 0;
+    if (status == EUSCI_B1_I2C_OK && done)
+    {
+        result.RawData = Light_Buffer[1] + ((uint16_t)Light_Buffer[0] << 8);
+        done(result);
+    }
+}
+
+uint8_t OPT3001_Request_Light(void (*done)(OPT3001_Result result))
+{
+    static const EUSCI_B1_I2C_Transaction transaction = {OPT3001_ADDRESS, {RESULT}, 1, Light_Buffer, 2, &OPT3001_Light_Read};
+
+    // Only one reading may be in progress, since they share the buffer
+    if (Light_Done || done == 0) return 0;
+
+    Light_Done = done;
+    if (!EUSCI_B1_I2C_Queue(&transaction))
+    {
+        Light_Done = 0;
+        return 0;
+    }
+    return 1;
+}
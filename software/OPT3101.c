@@ -1,4 +1,8 @@
+#include <string.h>
 #include "../inc/OPT3101.h"
+#include "../inc/ISR_Profile.h"
+#include "../inc/CortexM.h"
+#include "../inc/Flash.h"
 
 // edited by Valvano and Valvano 12/22/2019
 // hardware
@@ -16,40 +20,191 @@
 #define MM_PER_PHASE_COUNT 0.22872349395
 #define BinFixMM_PER_PHASE_COUNT 14990 // divided by 65536
 #define BinFix 16
-// We will do 128 sub-frames per frame.
-#define SUB_FRAME_COUNT 128
+// Sub-frames per frame and time constant of the crosstalk filter of each profile.
+// The time constant is set according to equation 6, section 4.2.1, of sbau310.pdf,
+// and depends on the number of sub-frames: the original setting was 3 for 128
+// sub-frames, and it changes by one each time the number of sub-frames doubles.
+// NUM_AVG_SUB_FRAMES is set to the same number so that every sub-frame is averaged.
+typedef struct
+{
+    uint16_t sub_frames;
+    uint8_t xtalk_filt_time_const;
+} OPT3101_Profile_Settings;
+
+static const OPT3101_Profile_Settings Profile_Settings[OPT3101_NUM_PROFILES] =
+{
+    {32,  1},   // OPT3101_PROFILE_FAST:     8 ms frames
+    {128, 3},   // OPT3101_PROFILE_BALANCED: 32 ms frames
+    {256, 4}    // OPT3101_PROFILE_PRECISE:  64 ms frames
+};
+
+static OPT3101_Profile Current_Profile = OPT3101_PROFILE_BALANCED;
 
-// Time constant of the crosstalk filter.  This is set according to equation 6,
-// section 4.2.1, of sbau310.pdf, and depends on SUB_FRAME_COUNT above.
-#define XTALK_FILT_TIME_CONST 3
+// Assuming SUB_VD_CLK_CNT has not been changed, each sub-frame takes 0.25 ms.
+#define SUB_FRAME_TIME_US 250
 
-// Assuming SUB_VD_CLK_CNT has not been changed, each sub-frame takes 0.25 ms,
-// and each frame will take 32 ms.  The datasheet documentation of
-// ILLUM_XTALK_CALIB and INT_XTALK_CALIB says we should wait at least
-// 5 << XTALK_FILT_TIME_CONST frames to get good crosstalk readings.
-// (5 << 3) * 128 * (0.25 ms) = 1280
-#define CROSSTALK_SETTLING_TIME_MS 1280
+// Internal crosstalk calibration kept in the information memory. The values are
+// the filtered crosstalk read from IPHASE_XTALK (0x3b) and QPHASE_XTALK (0x3c),
+// tagged with the frame settings (0x9f) and the temperature (TMAIN) of the
+// calibration. checksum is the complement of the sum of the other words.
+#define CROSSTALK_SIGNATURE 0x58544B31  // "XTK1"
+
+typedef struct
+{
+    uint32_t signature;
+    uint32_t reg9f;
+    int32_t xtalk_i;
+    int32_t xtalk_q;
+    uint32_t temperature;
+    uint32_t checksum;
+} OPT3101_Crosstalk_Record;
+
+// Override registers of the internal crosstalk (INT_XTALK_REG_I/Q, 16-bit signed)
+// and their scale (INT_XTALK_REG_SCALE, register value << scale = crosstalk).
+#define INT_XTALK_REG_I 0x2f
+#define INT_XTALK_REG_Q 0x30
+#define INT_XTALK_REG_SCALE_SHIFT 15
+#define INT_XTALK_REG_SCALE_MASK (7 << INT_XTALK_REG_SCALE_SHIFT)
+
+static OPT3101_Crosstalk_Record Crosstalk;
 
 static uint32_t reg08, reg09;
 
+// Converts the 3 bytes of a register, least significant byte first
+static uint32_t OPT3101_RegisterValue(const uint8_t *bytes)
+{
+    return bytes[0] + ((uint32_t)bytes[1] << 8) + ((uint32_t)bytes[2] << 16);
+}
+
+// Reads consecutive registers in one transaction: the OPT3101 increments the register address
+// after every 3 bytes. Waits for the queued I2C transaction.
+void OPT3101_ReadRegisters(uint8_t address, uint32_t *data, uint32_t count)
+{
+    uint8_t buffer[3 * OPT3101_MAX_BURST_REGISTERS];
+    if (count > OPT3101_MAX_BURST_REGISTERS) count = OPT3101_MAX_BURST_REGISTERS;
+
+    EUSCI_B1_I2C_Transaction transaction = {I2C_ADDRESS, {address}, 1, buffer, 3 * count, 0};
+    EUSCI_B1_I2C_Transfer(&transaction);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        data[i] = OPT3101_RegisterValue(&buffer[3 * i]);
+    }
+}
+
 uint32_t OPT3101_ReadRegister(uint8_t address)
 {
-    uint8_t buffer[3];
-    EUSCI_B1_I2C_Send_Multiple_Bytes(I2C_ADDRESS, &address, 1);
-    EUSCI_B1_I2C_Receive_Multiple_Bytes(I2C_ADDRESS, buffer, 3);
-    return buffer[0] + ((uint32_t)buffer[1] << 8) + ((uint32_t)buffer[2] << 16);
+    uint32_t data;
+    OPT3101_ReadRegisters(address, &data, 1);
+    return data;
+}
+
+// Configuration registers kept in the shadow, in increasing order
+static const uint8_t Shadow_Address[] = {0x0b, 0x14, 0x26, 0x27, 0x2a, 0x2e, 0x50, 0x6e, 0x76, 0x78, 0x80, 0x89, 0x9f};
+#define SHADOW_COUNT ((int)(sizeof(Shadow_Address) / sizeof(Shadow_Address[0])))
+
+// Last value written to (or read from) each shadowed register, and the registers
+// that were changed with OPT3101_SetRegister but not written yet (bit i for entry i)
+static uint32_t Shadow_Value[SHADOW_COUNT];
+static uint32_t Shadow_Dirty;
+
+// Returns the entry of a shadowed register, or -1
+static int OPT3101_ShadowIndex(uint8_t address)
+{
+    for (int i = 0; i < SHADOW_COUNT; i++)
+    {
+        if (Shadow_Address[i] == address) return i;
+    }
+    return -1;
 }
 
+// Queues a write of consecutive registers. The data is copied into the I2C queue,
+// so the write does not wait for the bus.
+static void OPT3101_QueueWrite(uint8_t address, const uint32_t *data, uint32_t count)
+{
+    EUSCI_B1_I2C_Transaction transaction = {I2C_ADDRESS, {address}, 1 + 3 * count, 0, 0, 0};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        transaction.write_data[1 + 3 * i] = data[i] & 0xFF;
+        transaction.write_data[2 + 3 * i] = data[i] >> 8 & 0xFF;
+        transaction.write_data[3 + 3 * i] = data[i] >> 16 & 0xFF;
+    }
+
+    while (!EUSCI_B1_I2C_Queue(&transaction))
+    {
+        EUSCI_B1_I2C_Wait();
+    }
+}
+
+// Writes a register at once and keeps its shadow up to date
 void OPT3101_WriteRegister(uint8_t address, uint32_t data)
 {
-    uint8_t buffer[] = {
-    address,
-    data & 0xFF,
-    data >> 8 & 0xFF,
-    data >> 16 & 0xFF
-    };
+    int index = OPT3101_ShadowIndex(address);
+    if (index >= 0)
+    {
+        Shadow_Value[index] = data;
+        Shadow_Dirty &= ~(1u << index);
+    }
+
+    OPT3101_QueueWrite(address, &data, 1);
+}
+
+// Returns a configuration register from the shadow, without any I2C transfer
+static uint32_t OPT3101_GetRegister(uint8_t address)
+{
+    return Shadow_Value[OPT3101_ShadowIndex(address)];
+}
+
+// Changes a configuration register in the shadow; OPT3101_Flush writes it
+static void OPT3101_SetRegister(uint8_t address, uint32_t data)
+{
+    int index = OPT3101_ShadowIndex(address);
+    if (Shadow_Value[index] != data)
+    {
+        Shadow_Value[index] = data;
+        Shadow_Dirty |= 1u << index;
+    }
+}
+
+// Writes the changed registers. Two changed registers with consecutive addresses
+// are written in one burst, since the OPT3101 increments the address after every 3 bytes.
+static void OPT3101_Flush(void)
+{
+    for (int i = 0; i < SHADOW_COUNT; i++)
+    {
+        if (!(Shadow_Dirty & (1u << i))) continue;
+
+        uint32_t count = 1;
+        if ((i + 1 < SHADOW_COUNT) && (Shadow_Dirty & (1u << (i + 1)))
+            && (Shadow_Address[i + 1] == Shadow_Address[i] + 1))
+        {
+            count = 2;
+        }
+
+        OPT3101_QueueWrite(Shadow_Address[i], &Shadow_Value[i], count);
+        i += count - 1;
+    }
+    Shadow_Dirty = 0;
+}
 
-    EUSCI_B1_I2C_Send_Multiple_Bytes(I2C_ADDRESS, buffer, sizeof(buffer));
+// Reads every shadowed register once, after the OPT3101 has loaded its settings.
+// Registers with consecutive addresses are read in one burst.
+static void OPT3101_LoadShadow(void)
+{
+    int i = 0;
+    while (i < SHADOW_COUNT)
+    {
+        int count = 1;
+        while ((i + count < SHADOW_COUNT) && (count < OPT3101_MAX_BURST_REGISTERS)
+            && (Shadow_Address[i + count] == Shadow_Address[i] + count))
+        {
+            count++;
+        }
+
+        OPT3101_ReadRegisters(Shadow_Address[i], &Shadow_Value[i], count);
+        i += count;
+    }
+    Shadow_Dirty = 0;
 }
 
 void OPT3101_Init(void)
@@ -75,6 +230,22 @@ void OPT3101_Init(void)
     {
         Clock_Delay1ms(1);
     }
+
+    // Configuration registers are read once here, and later changes only write them.
+    OPT3101_LoadShadow();
+}
+
+// Changes NUM_SUB_FRAMES, NUM_AVG_SUB_FRAMES and XTALK_FILT_TIME_CONST in the shadow
+static void OPT3101_SetProfileRegisters(OPT3101_Profile profile)
+{
+    const OPT3101_Profile_Settings *settings = &Profile_Settings[profile];
+
+    OPT3101_SetRegister(0x9f,
+    (uint32_t)(settings->sub_frames - 1) << 12 | (settings->sub_frames - 1));
+
+    uint32_t reg2e = OPT3101_GetRegister(0x2e);
+    reg2e = (reg2e & ~0xF00000) | (uint32_t)settings->xtalk_filt_time_const << 20;
+    OPT3101_SetRegister(0x2e, reg2e);
 }
 
 //uint32_t Reg2a;
@@ -83,25 +254,23 @@ void OPT3101_Setup(void)
 {
     // Set the overload flag observation window (TG_OVL_WINDOW_START).
     // This choice comes from the OPT3101 Configurator Tool version 0.8.0.
-    OPT3101_WriteRegister(0x89, 7000);
+    OPT3101_SetRegister(0x89, 7000);
 
     // Enable the temperature sensor.
     // This choice comes from the OPT3101 Configurator Tool version 0.8.0.
-    uint32_t reg6e = OPT3101_ReadRegister(0x6e);
+    uint32_t reg6e = OPT3101_GetRegister(0x6e);
     reg6e |= 0x80000;  // EN_TEMP_CONV = 1
-    OPT3101_WriteRegister(0x6e, reg6e);
+    OPT3101_SetRegister(0x6e, reg6e);
 
     // Turn on clip mode for frequency-correction to phase.
     // This choice comes from the OPT3101 Configurator Tool version 0.8.0.
-    uint32_t reg50 = OPT3101_ReadRegister(0x50);
+    uint32_t reg50 = OPT3101_GetRegister(0x50);
     reg50 |= 1;
-    OPT3101_WriteRegister(0x50, reg50);
+    OPT3101_SetRegister(0x50, reg50);
 
-    // Set NUM_SUB_FRAMES to SUB_FRAME_COUNT - 1.
-    // Set NUM_AVG_SUB_FRAMES to the same value so we are averaging together
-    // every sub-frame.
-    OPT3101_WriteRegister(0x9f,
-    (uint32_t)(SUB_FRAME_COUNT - 1) << 12 | (SUB_FRAME_COUNT - 1));
+    // Set NUM_SUB_FRAMES, NUM_AVG_SUB_FRAMES and XTALK_FILT_TIME_CONST
+    // according to the selected profile.
+    OPT3101_SetProfileRegisters(Current_Profile);
 
 // test different modulation frequency
   // By default, SUB_VD_CLK_CNT is 9,999 for 10,000 TD clocks in a sub-
@@ -112,58 +281,67 @@ void OPT3101_Setup(void)
     OPT3101_WriteRegister(0x80, reg80);*/
 // end of test different modulation frequency
 
-  // Set XTALK_FILT_TIME_CONST to the corresponding value.
-    uint32_t reg2e = OPT3101_ReadRegister(0x2e);
-    reg2e = (reg2e & ~0xF00000) | (uint32_t)XTALK_FILT_TIME_CONST << 20;
-    OPT3101_WriteRegister(0x2e, reg2e);
-
     // Set up the GPIO1 pin (which is connected to P6.2/AUXR) to be
     // a data-ready signal.
-    uint32_t reg78 = OPT3101_ReadRegister(0x78);
-    uint32_t reg0b = OPT3101_ReadRegister(0x0b);
+    uint32_t reg78 = OPT3101_GetRegister(0x78);
+    uint32_t reg0b = OPT3101_GetRegister(0x0b);
     reg78 |= 0x1000;                   // GPIO1_OBUF_EN = 1
     reg78 = (reg78 & ~0x1C0) | 0x080;  // GPO1_MUX_SEL = 2 (DIG_GPO_0)
     reg0b = (reg0b & ~0xF) | 9;        // DIG_GPO_SEL0 = 9 (DATA_RDY)
-    OPT3101_WriteRegister(0x78, reg78);
-    OPT3101_WriteRegister(0x0b, reg0b);
+    OPT3101_SetRegister(0x78, reg78);
+    OPT3101_SetRegister(0x0b, reg0b);
 
 
-    uint32_t reg2a = OPT3101_ReadRegister(0x2a);
+    uint32_t reg2a = OPT3101_GetRegister(0x2a);
     reg2a |= 0x8000;  // EN_ADAPTIVE_HDR = 1 : Adaptive HDR
     reg2a |= 1;       // EN_TX_SWITCH = 1    : Automatic channel-switching.
-    OPT3101_WriteRegister(0x2a, reg2a);
+    OPT3101_SetRegister(0x2a, reg2a);
     //    Reg2a = OPT3101_ReadRegister(0x2a); // debugging
 
 
   // Settings from the OPT3101 Configurator Tool 0.8.0 for monoshot mode.
   // No deep sleep, using the minimal startup delay allowed by the tool.
-    uint32_t reg27 = OPT3101_ReadRegister(0x27);
+    uint32_t reg27 = OPT3101_GetRegister(0x27);
     reg27 |= 3;                             // MONOSHOT_MODE = 3
     reg27 = (reg27 & 0xFFFF03) | (1 << 2);  // MONOSHOT_NUMFRAME = 1
-    OPT3101_WriteRegister(0x27, reg27);
+    OPT3101_SetRegister(0x27, reg27);
 //    Reg27 = OPT3101_ReadRegister(0x27); // debugging
 
-    uint32_t reg76 = OPT3101_ReadRegister(0x76);
+    uint32_t reg76 = OPT3101_GetRegister(0x76);
     reg76 |= 0x001;  // DIS_GLB_PD_REFSYS = 1
     reg76 |= 0x020;  // DIS_GLB_PD_AMB_DAC = 1
     reg76 |= 0x100;  // DIS_GLB_PD_OSC = 1
-    OPT3101_WriteRegister(0x76, reg76);
+    OPT3101_SetRegister(0x76, reg76);
 
-    uint32_t reg26 = OPT3101_ReadRegister(0x26);
+    uint32_t reg26 = OPT3101_GetRegister(0x26);
     reg26 = (reg26 & 0x0003FF) | (95 << 10);  // POWERUP_DELAY = 95
-    OPT3101_WriteRegister(0x26, reg26);
+    OPT3101_SetRegister(0x26, reg26);
+
+    // Write all the changed registers
+    OPT3101_Flush();
 }
 
-void OPT3101_CalibrateInternalCrosstalk(void)
+static uint32_t OPT3101_CrosstalkChecksum(const OPT3101_Crosstalk_Record *record)
+{
+    const uint32_t *words = (const uint32_t *)record;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < sizeof(*record) / 4 - 1; i++)
+    {
+        sum += words[i];
+    }
+    return ~sum;
+}
+
+bool OPT3101_CalibrateInternalCrosstalk(void)
 {
     // Clear TG_EN because the OPT3101 datasheet says EN_SEQUENCER should only be
     // changed while TG_EN is 0.
-    uint32_t reg80 = OPT3101_ReadRegister(0x80);
+    uint32_t reg80 = OPT3101_GetRegister(0x80);
     reg80 &= ~1;  // TG_EN = 0
     OPT3101_WriteRegister(0x80, reg80);
 
-    uint32_t orig_reg2a = OPT3101_ReadRegister(0x2a);
-    uint32_t orig_reg2e = OPT3101_ReadRegister(0x2e);
+    uint32_t orig_reg2a = OPT3101_GetRegister(0x2a);
+    uint32_t orig_reg2e = OPT3101_GetRegister(0x2e);
 
     uint32_t reg2e = orig_reg2e;
     reg2e &= ~(1 << 6);      // USE_XTALK_REG_INT = 0
@@ -175,7 +353,7 @@ void OPT3101_CalibrateInternalCrosstalk(void)
     reg2a &= ~(1 << 15);     // EN_ADAPTIVE_HDR = 0
     OPT3101_WriteRegister(0x2a, reg2a);
 
-    uint32_t reg14 = OPT3101_ReadRegister(0x14);
+    uint32_t reg14 = OPT3101_GetRegister(0x14);
     reg14 &= ~(1 << 16);     // EN_SEQUENCER = 0
     reg14 &= ~(1 << 17);     // EN_PROCESSOR_VALUES = 0
     OPT3101_WriteRegister(0x14, reg14);
@@ -186,19 +364,125 @@ void OPT3101_CalibrateInternalCrosstalk(void)
     reg2e |= 1 << 4;  // INT_XTALK_CALIB = 1 : Start the calibration.
     OPT3101_WriteRegister(0x2e, reg2e);
 
-    Clock_Delay1ms(CROSSTALK_SETTLING_TIME_MS);
+    // The datasheet documentation of ILLUM_XTALK_CALIB and INT_XTALK_CALIB says we
+    // should wait at least 5 << XTALK_FILT_TIME_CONST frames to get good crosstalk
+    // readings: (5 << 3) * 128 * (0.25 ms) = 1280 ms with the balanced profile.
+    const OPT3101_Profile_Settings *settings = &Profile_Settings[Current_Profile];
+    Clock_Delay1ms(((5u << settings->xtalk_filt_time_const) * settings->sub_frames * SUB_FRAME_TIME_US) / 1000);
 
-    // The internal crosstalk values could be read from registers 0x3b and 0x3c
-    // at this point.
+    // Read the internal crosstalk values and the temperature they were taken at.
+    uint32_t xtalk[2];
+    OPT3101_ReadRegisters(0x3b, xtalk, 2);
+    uint32_t reg0a = OPT3101_ReadRegister(0x0a);
 
     reg80 &= ~1;  // TG_EN = 0
     OPT3101_WriteRegister(0x80, reg80);
 
+    // The new calibration replaces crosstalk values restored from flash.
+    orig_reg2e &= ~(1 << 6);  // USE_XTALK_REG_INT = 0
     OPT3101_WriteRegister(0x2a, orig_reg2a);
     OPT3101_WriteRegister(0x2e, orig_reg2e);
 
     reg80 |= 1;   // TG_EN = 1
     OPT3101_WriteRegister(0x80, reg80);
+
+    // Keep the calibration for the next boot. The record goes to the flash boot-override
+    // mailbox sector, which the boot code ignores because the signature is not the mailbox start word.
+    Crosstalk.signature = CROSSTALK_SIGNATURE;
+    Crosstalk.reg9f = OPT3101_GetRegister(0x9f);
+    Crosstalk.xtalk_i = (int32_t)(xtalk[0] << 8) >> 8;  // sign-extend 24 bits
+    Crosstalk.xtalk_q = (int32_t)(xtalk[1] << 8) >> 8;
+    Crosstalk.temperature = (reg0a >> 12) & 0xFFF;      // TMAIN
+    Crosstalk.checksum = OPT3101_CrosstalkChecksum(&Crosstalk);
+    return Flash_Info_Write(&Crosstalk, sizeof(Crosstalk));
+}
+
+bool OPT3101_RestoreInternalCrosstalk(void)
+{
+    OPT3101_Crosstalk_Record stored;
+    memcpy(&stored, (const void *)Flash_Info_Read(), sizeof(stored));
+
+    if (stored.signature != CROSSTALK_SIGNATURE
+        || stored.checksum != OPT3101_CrosstalkChecksum(&stored)
+        || stored.reg9f != OPT3101_GetRegister(0x9f))
+    {
+        return false;
+    }
+
+    // Take one frame to read the current temperature.
+    uint32_t reg80 = OPT3101_GetRegister(0x80);
+    reg80 |= 1;   // TG_EN = 1
+    OPT3101_WriteRegister(0x80, reg80);
+    OPT3101_StartMeasurement();
+    Clock_Delay1ms(OPT3101_GetFrameTimeUs() / 1000 + 2);
+    uint32_t temperature = (OPT3101_ReadRegister(0x0a) >> 12) & 0xFFF;
+
+    uint32_t drift = (temperature > stored.temperature) ?
+        temperature - stored.temperature : stored.temperature - temperature;
+    if (drift > OPT3101_CROSSTALK_MAX_DRIFT)
+    {
+        return false;
+    }
+
+    // Find the smallest scale that fits both values in 16 bits.
+    uint32_t scale = 0;
+    while (scale < 7 && ((stored.xtalk_i >> scale) > 32767 || (stored.xtalk_i >> scale) < -32768
+                      || (stored.xtalk_q >> scale) > 32767 || (stored.xtalk_q >> scale) < -32768))
+    {
+        scale++;
+    }
+
+    reg80 &= ~1;  // TG_EN = 0
+    OPT3101_WriteRegister(0x80, reg80);
+
+    OPT3101_WriteRegister(INT_XTALK_REG_I, (uint32_t)(stored.xtalk_i >> scale) & 0xFFFF);
+    OPT3101_WriteRegister(INT_XTALK_REG_Q, (uint32_t)(stored.xtalk_q >> scale) & 0xFFFF);
+
+    uint32_t reg2e = OPT3101_GetRegister(0x2e);
+    reg2e = (reg2e & ~INT_XTALK_REG_SCALE_MASK) | scale << INT_XTALK_REG_SCALE_SHIFT;
+    reg2e &= ~(1 << 5);      // USE_XTALK_FILT_INT = 0
+    reg2e |= 1 << 6;         // USE_XTALK_REG_INT = 1 : Use the restored values.
+    OPT3101_WriteRegister(0x2e, reg2e);
+
+    reg80 |= 1;   // TG_EN = 1
+    OPT3101_WriteRegister(0x80, reg80);
+
+    Crosstalk = stored;
+    return true;
+}
+
+bool OPT3101_InitInternalCrosstalk(void)
+{
+    if (OPT3101_RestoreInternalCrosstalk())
+    {
+        return true;
+    }
+    return OPT3101_CalibrateInternalCrosstalk();
+}
+
+void OPT3101_SetProfile(OPT3101_Profile profile)
+{
+    if (profile >= OPT3101_NUM_PROFILES) return;
+    Current_Profile = profile;
+
+    // The frame settings are changed while the timing generator is stopped.
+    uint32_t reg80 = OPT3101_GetRegister(0x80);
+    OPT3101_WriteRegister(0x80, reg80 & ~1);  // TG_EN = 0
+
+    OPT3101_SetProfileRegisters(profile);
+    OPT3101_Flush();
+
+    OPT3101_WriteRegister(0x80, reg80);       // TG_EN restored
+}
+
+OPT3101_Profile OPT3101_GetProfile(void)
+{
+    return Current_Profile;
+}
+
+uint32_t OPT3101_GetFrameTimeUs(void)
+{
+    return (uint32_t)Profile_Settings[Current_Profile].sub_frames * SUB_FRAME_TIME_US;
 }
 
 void OPT3101_StartMeasurement(void)
@@ -213,20 +497,25 @@ void OPT3101_StartMeasurementChannel(uint32_t ch)
 {
     if(ch <= 2)
     {
-    uint32_t reg2a = OPT3101_ReadRegister(0x2a);
+    uint32_t reg2a = OPT3101_GetRegister(0x2a);
     reg2a |= 0x8000;  // EN_ADAPTIVE_HDR = 1 : Adaptive HDR
     reg2a &= ~0x07;   // EN_TX_SWITCH = 0    : Manual channel-switching.
     reg2a |= ch<<1;   // SEL_TX_CH bits 2:1 is 0,1,2
-    OPT3101_WriteRegister(0x2a, reg2a);  // Set MONOSHOT_BIT to 1 to trigger a new measurement.
+    OPT3101_SetRegister(0x2a, reg2a);
+    OPT3101_Flush();  // Written only if the channel changed
     }
+    // Set MONOSHOT_BIT to 1 to trigger a new measurement.
     // Assumption: The other bits in register 0 should be 0.
     OPT3101_WriteRegister(0x00, 0x800000);
 }
 
 void OPT3101_ReadMeasurement(void)
 {
-    reg08 = OPT3101_ReadRegister(0x08);
-    reg09 = OPT3101_ReadRegister(0x09);
+    // Registers 0x08 and 0x09 are read in one burst
+    uint32_t data[2];
+    OPT3101_ReadRegisters(0x08, data, 2);
+    reg08 = data[0];
+    reg09 = data[1];
 }
 
 bool OPT3101_MeasurementError(void)
@@ -279,37 +568,51 @@ bool OPT3101_CheckDistanceSensor(void)
 }
 uint32_t ChannelCount[3]; // debugging monitor
 
-uint32_t OPT3101_GetMeasurement(uint32_t distances[3], uint32_t amplitudes[3])
+// Classifies the measurement read into reg08 and reg09
+static OPT3101_Sample_Error OPT3101_MeasurementStatus(uint32_t distance, uint32_t amplitude)
 {
-    uint32_t channel,distance,amplitude;
-    OPT3101_ReadMeasurement();
-
-    distance  = OPT3101_GetDistanceMillimeters();
-    amplitude = OPT3101_GetAmplitude();
-    channel   = OPT3101_GetTxChannel();
-
     if (OPT3101_MeasurementError())
     {
         // Something went wrong getting the measurement.
-        distance = 65535;
+        return OPT3101_SAMPLE_INVALID;
     }
 
-    else if (amplitude < 150)
+    if (amplitude < 150)
     {
         // Low amplitude: ignore the distance.
-        distance = 65534;
+        return OPT3101_SAMPLE_LOW_AMPLITUDE;
     }
 
-    else if (distance > 10000)
+    if (distance > 10000)
     {
         // The distance measurement probably underflowed and wrapped around
         // to a really big number (because of imperfect phase offset
-        // calibration), so report 65533.
-        distance = 65533;
+        // calibration).
+        return OPT3101_SAMPLE_OUT_OF_RANGE;
+    }
+
+    return OPT3101_SAMPLE_OK;
+}
+
+// Stores the measurement read into reg08 and reg09 and returns its channel
+static uint32_t OPT3101_StoreMeasurement(uint32_t distances[3], uint32_t amplitudes[3])
+{
+    // Distances reported for each OPT3101_Sample_Error
+    static const uint32_t error_distance[4] = {0, 65535, 65534, 65533};
+
+    uint32_t channel,distance,amplitude;
+    OPT3101_Sample_Error error;
+
+    distance  = OPT3101_GetDistanceMillimeters();
+    amplitude = OPT3101_GetAmplitude();
+    channel   = OPT3101_GetTxChannel();
+    error     = OPT3101_MeasurementStatus(distance, amplitude);
+
+    if (error != OPT3101_SAMPLE_OK)
+    {
+        distance = error_distance[error];
     }
 
-    // Clear the pin-change interrupt flag.
-    P6->IFG &= ~(1 << 2);
     if (channel <= 2)
     {
         ChannelCount[channel]++;
@@ -319,15 +622,72 @@ uint32_t OPT3101_GetMeasurement(uint32_t distances[3], uint32_t amplitudes[3])
     return channel;
 }
 
+uint32_t OPT3101_GetMeasurement(uint32_t distances[3], uint32_t amplitudes[3])
+{
+    uint32_t channel;
+    OPT3101_ReadMeasurement();
+    channel = OPT3101_StoreMeasurement(distances, amplitudes);
+
+    // Clear the pin-change interrupt flag.
+    P6->IFG &= ~(1 << 2);
+    return channel;
+}
+
 uint32_t *PTxChan;
 uint32_t *Pdistances;
 uint32_t *Pamplitudes;
 
-void OPT3101_ArmInterrupts(uint32_t *pTxChan, uint32_t distances[3], uint32_t amplitudes[3])
+// Raw bytes of registers 0x08 and 0x09, read in the background after DATA_RDY,
+// and the DWT cycle count at DATA_RDY
+static uint8_t Measurement_Buffer[6];
+static volatile uint8_t Measurement_Reading;
+static uint32_t Measurement_Time;
+
+// Ring buffers of the continuous mode, one per channel. The EUSCI_B1 interrupt is the only
+// writer; the counts run freely and are masked on access.
+static OPT3101_Sample Sample_Ring[3][OPT3101_RING_SIZE];
+static volatile uint32_t Sample_Count[3];
+static volatile uint8_t Continuous_Mode;
+static uint32_t Frames_Skipped;
+
+// Adds the measurement read into reg08 and reg09 to the ring buffer of its channel
+static void OPT3101_PushSample(void)
 {
-    PTxChan = pTxChan;
-    Pdistances = distances;
-    Pamplitudes = amplitudes;
+    uint32_t channel = OPT3101_GetTxChannel();
+    if (channel > 2) return;
+
+    uint32_t count = Sample_Count[channel];
+    OPT3101_Sample *sample = &Sample_Ring[channel][count & (OPT3101_RING_SIZE - 1)];
+    sample->time      = Measurement_Time;
+    sample->distance  = OPT3101_GetDistanceMillimeters();
+    sample->amplitude = OPT3101_GetAmplitude();
+    sample->error     = OPT3101_MeasurementStatus(sample->distance, sample->amplitude);
+    Sample_Count[channel] = count + 1;
+}
+
+// Called from the EUSCI_B1 interrupt once both registers have been read
+static void OPT3101_MeasurementRead(EUSCI_B1_I2C_Status status)
+{
+    if (status == EUSCI_B1_I2C_OK)
+    {
+        reg08 = OPT3101_RegisterValue(&Measurement_Buffer[0]);
+        reg09 = OPT3101_RegisterValue(&Measurement_Buffer[3]);
+        if (Continuous_Mode)
+        {
+            OPT3101_PushSample();
+        }
+        else
+        {
+            *PTxChan = OPT3101_StoreMeasurement(Pdistances,Pamplitudes);
+        }
+    }
+    Measurement_Reading = 0;
+}
+
+// Arms the DATA_RDY interrupt on P6.2
+static void OPT3101_ArmDataReady(void)
+{
+    Measurement_Reading = 0;
     // Make P6.2/AUXR be an input for the DATA_RDY signal.
     P6->DIR &= ~0x04;
     // Set up P6.2/AUXR to detect low-to-high transitions.
@@ -339,13 +699,204 @@ void OPT3101_ArmInterrupts(uint32_t *pTxChan, uint32_t distances[3], uint32_t am
     NVIC->ISER[1] = 0x00000100;  // enable interrupt 40 in NVIC
 }
 
+void OPT3101_ArmInterrupts(uint32_t *pTxChan, uint32_t distances[3], uint32_t amplitudes[3])
+{
+    PTxChan = pTxChan;
+    Pdistances = distances;
+    Pamplitudes = amplitudes;
+    Continuous_Mode = 0;
+    OPT3101_ArmDataReady();
+}
+
+void OPT3101_StartContinuous(void)
+{
+    // Enable the DWT cycle counter used for the timestamps
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (int i = 0; i < 3; i++)
+    {
+        Sample_Count[i] = 0;
+    }
+    Frames_Skipped = 0;
+    Continuous_Mode = 1;
+    OPT3101_ArmDataReady();
+
+    uint32_t reg2a = OPT3101_GetRegister(0x2a);
+    reg2a |= 0x8000;  // EN_ADAPTIVE_HDR = 1 : Adaptive HDR
+    reg2a = (reg2a & ~0x07) | 1;  // EN_TX_SWITCH = 1 : Automatic channel-switching.
+    OPT3101_SetRegister(0x2a, reg2a);
+
+    uint32_t reg27 = OPT3101_GetRegister(0x27);
+    reg27 &= ~3;      // MONOSHOT_MODE = 0 : Continuous frames
+    OPT3101_SetRegister(0x27, reg27);
+
+    uint32_t reg80 = OPT3101_GetRegister(0x80);
+    reg80 |= 1;       // TG_EN = 1
+    OPT3101_SetRegister(0x80, reg80);
+
+    OPT3101_Flush();
+}
+
+void OPT3101_StopContinuous(void)
+{
+    P6->IE &= ~0x04;  // disarm interrupt on P6.2
+
+    uint32_t reg27 = OPT3101_GetRegister(0x27);
+    reg27 |= 3;       // MONOSHOT_MODE = 3
+    OPT3101_SetRegister(0x27, reg27);
+    OPT3101_Flush();
+
+    // Let a read in progress finish before the monoshot functions are used
+    EUSCI_B1_I2C_Wait();
+    Continuous_Mode = 0;
+}
+
+bool OPT3101_GetLatestSample(uint32_t channel, OPT3101_Sample *sample)
+{
+    return OPT3101_GetSamples(channel, sample, 1) == 1;
+}
+
+uint32_t OPT3101_GetSamples(uint32_t channel, OPT3101_Sample *samples, uint32_t count)
+{
+    if (channel > 2) return 0;
+    if (count > OPT3101_RING_SIZE) count = OPT3101_RING_SIZE;
+
+    // The copy is done in a critical section so that the EUSCI_B1 interrupt cannot
+    // overwrite the oldest sample while it is being copied
+    long sr = StartCritical();
+
+    uint32_t total = Sample_Count[channel];
+    if (count > total) count = total;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        samples[i] = Sample_Ring[channel][(total - count + i) & (OPT3101_RING_SIZE - 1)];
+    }
+
+    EndCritical(sr);
+
+    return count;
+}
+
+uint32_t OPT3101_GetSampleCount(uint32_t channel)
+{
+    return (channel <= 2) ? Sample_Count[channel] : 0;
+}
+
+uint32_t OPT3101_GetFramesSkipped(void)
+{
+    return Frames_Skipped;
+}
+
 uint32_t ISRTime; // bus cycle time (1us)
 uint32_t ISRLast;    // last time (20.83ns)
 uint32_t ISRPeriod;
 
-// *PTxChan set to 0,1,2 when measurement done
+// Queues the burst read of the measurement registers; *PTxChan is set to 0,1,2 once it is done
 void PORT6_IRQHandler(void)
 {
-    *PTxChan = OPT3101_GetMeasurement(Pdistances,Pamplitudes);
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+    static const EUSCI_B1_I2C_Transaction read = {I2C_ADDRESS, {0x08}, 1, Measurement_Buffer, 6, &OPT3101_MeasurementRead};
+
+    // A measurement that arrives while the previous one is still being read is skipped
+    if (!Measurement_Reading)
+    {
+        Measurement_Time = DWT->CYCCNT;
+        Measurement_Reading = EUSCI_B1_I2C_Queue(&read);
+        if (!Measurement_Reading) Frames_Skipped = Frames_Skipped + 1;
+    }
+    else
+    {
+        Frames_Skipped = Frames_Skipped + 1;
+    }
     P6->IFG = 0x00;            // clear all flags
+    ISR_PROFILE_EXIT(ISR_PROFILE_PORT6);
+}
+
+// Integer square root, rounded down
+static uint32_t OPT3101_SquareRoot(uint64_t s)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > s) bit >>= 2;
+    while (bit != 0)
+    {
+        if (s >= root + bit)
+        {
+            s -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+void OPT3101_BenchmarkProfile(OPT3101_Profile profile, uint32_t channel, uint32_t count, OPT3101_Benchmark *result)
+{
+    OPT3101_Profile previous = Current_Profile;
+    OPT3101_Sample sample = {0}, first = {0};
+    uint64_t sum = 0, sum_squares = 0;
+    uint32_t taken = 0, valid = 0, first_seen = 0;
+
+    if (channel > 2 || count < 2) return;
+
+    OPT3101_SetProfile(profile);
+    OPT3101_StartContinuous();
+
+    // Skip the sample of the frame during which the profile was changed
+    uint32_t seen = 1;
+    while (taken < count)
+    {
+        DisableInterrupts();
+        if (OPT3101_GetSampleCount(channel) <= seen) WaitForInterrupt();
+        EnableInterrupts();
+
+        if (OPT3101_GetSampleCount(channel) <= seen) continue;
+
+        // Read the count with the sample, so that the period accounts for the samples skipped
+        long sr = StartCritical();
+        seen = OPT3101_GetSampleCount(channel);
+        OPT3101_GetLatestSample(channel, &sample);
+        EndCritical(sr);
+
+        if (taken == 0)
+        {
+            first = sample;
+            first_seen = seen;
+        }
+        taken++;
+
+        if (sample.error == OPT3101_SAMPLE_OK)
+        {
+            sum += sample.distance;
+            sum_squares += (uint32_t)sample.distance * sample.distance;
+            valid++;
+        }
+    }
+
+    OPT3101_StopContinuous();
+    OPT3101_SetProfile(previous);
+
+    uint32_t cycles_per_us = Clock_GetFreq() / 1000000;
+    result->frame_time = (uint32_t)Profile_Settings[profile].sub_frames * SUB_FRAME_TIME_US;
+    result->sample_period = (sample.time - first.time) / (seen - first_seen) / cycles_per_us;
+    result->valid = valid;
+    result->mean = 0;
+    result->noise = 0;
+    if (valid > 0)
+    {
+        result->mean = (uint32_t)((sum + valid / 2) / valid);
+    }
+    if (valid > 1)
+    {
+        // Sample variance in mm^2, scaled by 100 to return the deviation in 0.1 mm
+        uint64_t deviations = sum_squares * valid - sum * sum;
+        result->noise = OPT3101_SquareRoot(deviations * 100 / ((uint64_t)valid * (valid - 1)));
+    }
 }
@@ -0,0 +1,96 @@
+/**
+ * @file PID.c
+ * @brief Source code for the PID controller module.
+ *
+ * This file contains the function definitions for a fixed-point PID controller.
+ * Products are computed with 64-bit intermediates and every stored value is
+ * saturated, so the controller never wraps around.
+ *
+ */
+
+#include "../inc/PID.h"
+
+static int64_t PID_Clamp(int64_t value, int64_t min, int64_t max)
+{
+    if (value < min) return min;
+    if (value > max) return max;
+    return value;
+}
+
+void PID_Init(PID_Controller *pid, int32_t kp, int32_t ki, int32_t kd, int32_t output_min, int32_t output_max)
+{
+    pid->Kp = kp;
+    pid->Ki = ki;
+    pid->Kd = kd;
+    pid->derivative_alpha = PID_Q16_ONE;
+    pid->output_min = output_min;
+    pid->output_max = output_max;
+    pid->integral_min = output_min;
+    pid->integral_max = output_max;
+    PID_Reset(pid);
+}
+
+void PID_Set_Integral_Limits(PID_Controller *pid, int32_t integral_min, int32_t integral_max)
+{
+    pid->integral_min = integral_min;
+    pid->integral_max = integral_max;
+    pid->integral = PID_Clamp(pid->integral, (int64_t)integral_min * PID_Q16_ONE, (int64_t)integral_max * PID_Q16_ONE);
+}
+
+void PID_Set_Derivative_Filter(PID_Controller *pid, int32_t alpha)
+{
+    pid->derivative_alpha = (int32_t)PID_Clamp(alpha, 1, PID_Q16_ONE);
+}
+
+void PID_Reset(PID_Controller *pid)
+{
+    pid->integral = 0;
+    pid->derivative = 0;
+    pid->previous_measurement = 0;
+    pid->first_update = true;
+}
+
+int32_t PID_Update(PID_Controller *pid, int32_t setpoint, int32_t measurement)
+{
+    int64_t output_min = (int64_t)pid->output_min * PID_Q16_ONE;
+    int64_t output_max = (int64_t)pid->output_max * PID_Q16_ONE;
+    int64_t error = (int64_t)setpoint - measurement;
+
+    // Avoid a derivative spike on the first update
+    if (pid->first_update)
+    {
+        pid->previous_measurement = measurement;
+        pid->first_update = false;
+    }
+
+    // Proportional term
+    int64_t proportional = pid->Kp * error;
+
+    // Derivative on the measurement, smoothed by a first-order low-pass filter
+    int64_t derivative = -(int64_t)pid->Kd * ((int64_t)measurement - pid->previous_measurement);
+    derivative = pid->derivative + (((derivative - pid->derivative) * pid->derivative_alpha) >> 16);
+    pid->derivative = PID_Clamp(derivative, output_min - output_max, output_max - output_min);
+    pid->previous_measurement = measurement;
+
+    // Integral term, clamped to its own range
+    int64_t integral = PID_Clamp(pid->integral + pid->Ki * error,
+                                 (int64_t)pid->integral_min * PID_Q16_ONE,
+                                 (int64_t)pid->integral_max * PID_Q16_ONE);
+
+    int64_t output = proportional + integral + pid->derivative;
+
+    // Anti-windup: stop integrating while the output saturates in the direction of the error
+    if ((output > output_max && integral > pid->integral) || (output < output_min && integral < pid->integral))
+    {
+        output = output - integral + pid->integral;
+    }
+    else
+    {
+        pid->integral = integral;
+    }
+
+    output = PID_Clamp(output, output_min, output_max);
+
+    // Round to the nearest integer
+    return (int32_t)((output + (PID_Q16_ONE / 2)) >> 16);
+}
@@ -23,6 +23,7 @@
  */
 
 #include "../inc/PMOD_BTN_Interrupt.h"
+#include "../inc/ISR_Profile.h"
 
 // PMOD BTN should not be used if OPT3101 is being used
 // to avoid any interrupt conflict
@@ -81,10 +82,14 @@ uint8_t PMOD_BTN_Read(void)
 #ifndef OPT3101_ACTIVE
 void PORT6_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_NO_LATENCY);
+
     // Clear the interrupt flags for P6.0 - P6.3
     P6->IFG &= ~0x0F;
 
     // Execute the user-defined task
     (*PMOD_BTN_Task)(PMOD_BTN_Read());
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_PORT6);
 }
 #endif
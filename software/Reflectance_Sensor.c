@@ -36,6 +36,16 @@
 
 #include "../inc/Reflectance_Sensor.h"
 
+// Sensor weights in 0.1mm, shared by the Weight array and Reflectance_Sensor_Table
+#define WEIGHT_0    334
+#define WEIGHT_1    238
+#define WEIGHT_2    142
+#define WEIGHT_3    48
+#define WEIGHT_4    (-48)
+#define WEIGHT_5    (-142)
+#define WEIGHT_6    (-238)
+#define WEIGHT_7    (-334)
+
 /**
  * @brief Weight values used for sensor integration in Reflectance_Sensor_Position().
  *
@@ -53,7 +63,7 @@
  * Weight[6]: Weight for the second-leftmost sensor (P7.6)
  * Weight[7]: Weight for the leftmost sensor (P7.7)
  */
-const int32_t Weight[8] = {334, 238, 142, 48, -48, -142, -238, -334};
+const int32_t Weight[8] = {WEIGHT_0, WEIGHT_1, WEIGHT_2, WEIGHT_3, WEIGHT_4, WEIGHT_5, WEIGHT_6, WEIGHT_7};
 
 /**
  * @brief Bit masks used for sensor integration in Reflectance_Sensor_Position().
@@ -72,6 +82,63 @@ const int32_t Weight[8] = {334, 238, 142, 48, -48, -142, -238, -334};
  */
 const int32_t Mask[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
 
+// Sum of the weights of the active sensors in an 8-bit reading
+#define LINE_SUM(d)     ((((d) & 0x01) ? WEIGHT_0 : 0) + (((d) & 0x02) ? WEIGHT_1 : 0) + \
+                         (((d) & 0x04) ? WEIGHT_2 : 0) + (((d) & 0x08) ? WEIGHT_3 : 0) + \
+                         (((d) & 0x10) ? WEIGHT_4 : 0) + (((d) & 0x20) ? WEIGHT_5 : 0) + \
+                         (((d) & 0x40) ? WEIGHT_6 : 0) + (((d) & 0x80) ? WEIGHT_7 : 0))
+
+// Number of active sensors in an 8-bit reading
+#define LINE_COUNT(d)   ((((d) >> 0) & 1) + (((d) >> 1) & 1) + (((d) >> 2) & 1) + (((d) >> 3) & 1) + \
+                         (((d) >> 4) & 1) + (((d) >> 5) & 1) + (((d) >> 6) & 1) + (((d) >> 7) & 1))
+
+// Average position of the active sensors, or Weight[0] + 1 if no sensor is active
+#define LINE_POSITION(d)    (((d) == 0) ? (WEIGHT_0 + 1) : (LINE_SUM(d) / LINE_COUNT(d)))
+
+// Intersection class of an 8-bit reading
+#define LINE_CLASS(d)   (((d) == 0) ? REFLECTANCE_LINE_NONE : \
+                         (((d) & 0xFF) == 0xFF) ? REFLECTANCE_LINE_CROSS : \
+                         (((d) & 0x0F) == 0x0F) ? REFLECTANCE_LINE_RIGHT_BRANCH : \
+                         (((d) & 0xF0) == 0xF0) ? REFLECTANCE_LINE_LEFT_BRANCH : \
+                         REFLECTANCE_LINE_TRACK)
+
+#define LINE_ENTRY(d)   {LINE_POSITION(d), LINE_COUNT(d), LINE_CLASS(d)}
+
+#define LINE_ROW(r, shift)  LINE_ENTRY(((r) + 0x0) >> (shift)), LINE_ENTRY(((r) + 0x1) >> (shift)), \
+                            LINE_ENTRY(((r) + 0x2) >> (shift)), LINE_ENTRY(((r) + 0x3) >> (shift)), \
+                            LINE_ENTRY(((r) + 0x4) >> (shift)), LINE_ENTRY(((r) + 0x5) >> (shift)), \
+                            LINE_ENTRY(((r) + 0x6) >> (shift)), LINE_ENTRY(((r) + 0x7) >> (shift)), \
+                            LINE_ENTRY(((r) + 0x8) >> (shift)), LINE_ENTRY(((r) + 0x9) >> (shift)), \
+                            LINE_ENTRY(((r) + 0xA) >> (shift)), LINE_ENTRY(((r) + 0xB) >> (shift)), \
+                            LINE_ENTRY(((r) + 0xC) >> (shift)), LINE_ENTRY(((r) + 0xD) >> (shift)), \
+                            LINE_ENTRY(((r) + 0xE) >> (shift)), LINE_ENTRY(((r) + 0xF) >> (shift))
+
+#define LINE_TABLE(shift)   {LINE_ROW(0x00, shift), LINE_ROW(0x10, shift), LINE_ROW(0x20, shift), LINE_ROW(0x30, shift), \
+                             LINE_ROW(0x40, shift), LINE_ROW(0x50, shift), LINE_ROW(0x60, shift), LINE_ROW(0x70, shift), \
+                             LINE_ROW(0x80, shift), LINE_ROW(0x90, shift), LINE_ROW(0xA0, shift), LINE_ROW(0xB0, shift), \
+                             LINE_ROW(0xC0, shift), LINE_ROW(0xD0, shift), LINE_ROW(0xE0, shift), LINE_ROW(0xF0, shift)}
+
+/**
+ * @brief Line position, sensor count and intersection class for every 8-bit sensor reading.
+ *
+ * The table is expanded by the preprocessor from the Weight values above, so it is
+ * computed at compile time and placed in flash. The second half of the table holds the
+ * same information for the reading shifted right by one bit (the leftmost sensor ignored).
+ */
+const Reflectance_Sensor_Line Reflectance_Sensor_Table[2][256] = {LINE_TABLE(0), LINE_TABLE(1)};
+
+// States of the non-blocking read started by Reflectance_Sensor_Sample_Start()
+typedef enum
+{
+    SAMPLE_IDLE     = 0,
+    SAMPLE_CHARGE   = 1,
+    SAMPLE_DECAY    = 2
+} Reflectance_Sensor_Sample_State;
+
+static volatile Reflectance_Sensor_Sample_State Sample_State = SAMPLE_IDLE;
+static uint16_t Sample_Decay_Time;
+static void (*Sample_Task)(uint8_t data);
+
 void Reflectance_Sensor_Init()
 {
     // Configure P5.3 as output GPIO
@@ -141,32 +208,104 @@ uint8_t Reflectance_Sensor_Center(uint32_t time)
 int check_string = 0;
 int32_t Reflectance_Sensor_Position(uint8_t data)
 {
-    int sum = 0;
-    int count = 0;
+    return Reflectance_Sensor_Table[0][data].position;
+}
+
+uint8_t Reflectance_Sensor_Read_Grayscale(uint16_t *decay_time, uint16_t step, uint16_t max_time)
+{
+    uint16_t elapsed = 0;
 
-    // Check if any reflectance sensors are active (i.e. data is non-zero)
-    if (data)
+    // Sensors whose output has not decayed yet
+    uint8_t active = 0xFF;
+
+    // A step of 0 would never advance elapsed, so it is read as 1 us
+    if (step == 0)
     {
-        // Iterate through each reflectance sensor
-        for(int i = 0; i < 8; i++)
+        step = 1;
+    }
+
+    // Turn on even-numbered IR LEDs
+    P5->OUT |= 0x08;
+
+    // Turn on odd-numbered IR LEDs
+    P9->OUT |= 0x04;
+
+    // Configure P7.0 - P7.7 as output GPIO
+    P7->DIR |= 0xFF;
+
+    // Set P7.0 - P7.7 to high
+    P7->OUT |= 0xFF;
+
+    // Wait for 10 us
+    Clock_Delay1us(10);
+
+    // After waiting 10 us, configure P7.0 - P7.7 as input GPIO
+    P7->DIR = 0x00;
+
+    // Take a snapshot every step until all sensors have decayed or max_time has elapsed.
+    // The last step is shortened so that elapsed never exceeds max_time.
+    while (active && (elapsed < max_time))
+    {
+        uint16_t delay = (max_time - elapsed < step) ? (max_time - elapsed) : step;
+        Clock_Delay1us(delay);
+        elapsed = elapsed + delay;
+
+        // Record the decay time of the sensors that went low since the last snapshot
+        uint8_t snapshot = P7->IN;
+        uint8_t decayed = active & ~snapshot;
+        for (int i = 0; decayed; i++)
         {
-            // Check if the sensor is active based on the bit position in the data
-            if (data & Mask[i])
+            if (decayed & Mask[i])
             {
-                // Sum the weighted position value of the active sensor
-                sum = sum + Weight[i];
-                count++;
+                decay_time[i] = elapsed;
+                decayed &= ~Mask[i];
             }
         }
+        active &= snapshot;
+    }
+
+    // Sensors that are still high report the maximum time
+    for (int i = 0; i < 8; i++)
+    {
+        if (active & Mask[i])
+        {
+            decay_time[i] = max_time;
+        }
+    }
+
+    // Turn off even-numbered IR LEDs
+    P5->OUT &= ~0x08;
+
+    // Turn off odd-numbered IR LEDs
+    P9->OUT &= ~0x04;
 
-        // Calculate the average position based on the active sensors
-        return sum/count;
+    // Return the sensors that have not decayed
+    return active;
+}
+
+int32_t Reflectance_Sensor_Grayscale_Position(const uint16_t *decay_time, uint16_t white_time)
+{
+    int32_t sum = 0;
+    int32_t total = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        // Only the time beyond the white decay time indicates the line
+        if (decay_time[i] > white_time)
+        {
+            int32_t darkness = decay_time[i] - white_time;
+            sum = sum + Weight[i] * darkness;
+            total = total + darkness;
+        }
     }
-    else
+
+    if (total == 0)
     {
-        // If no sensors are active, return a default position value
+        // If no sensor is darker than white, return the same default as Reflectance_Sensor_Position()
         return Weight[0] + 1;
     }
+
+    return sum/total;
 }
 
 void Reflectance_Sensor_Start()
@@ -187,7 +326,7 @@ void Reflectance_Sensor_Start()
     Clock_Delay1us(10);
 
     // Configure P7.0 - P7.7 as input GPIO
-    P7->DIR &= ~0xFF;
+    P7->DIR = 0x00;
 }
 
 uint8_t Reflectance_Sensor_End()
@@ -205,3 +344,66 @@ uint8_t Reflectance_Sensor_End()
     // Return the value of the line sensor array
     return reflectance_value;
 }
+
+static void Reflectance_Sensor_Sample_Step()
+{
+    if (Sample_State == SAMPLE_CHARGE)
+    {
+        // Configure P7.0 - P7.7 as input GPIO and let the sensor outputs decay
+        P7->DIR = 0x00;
+
+        Sample_State = SAMPLE_DECAY;
+        Timer_A1_Compare_Start(&Reflectance_Sensor_Sample_Step, Sample_Decay_Time * TIMER_A1_TICKS_PER_US);
+    }
+    else if (Sample_State == SAMPLE_DECAY)
+    {
+        // Retrieve the value of the line sensor array
+        // Note: "1" indicates black while "0" indicates white
+        uint8_t reflectance_value = P7->IN;
+
+        // Turn off even-numbered IR LEDs
+        P5->OUT &= ~0x08;
+
+        // Turn off odd-numbered IR LEDs
+        P9->OUT &= ~0x04;
+
+        Sample_State = SAMPLE_IDLE;
+
+        // Deliver the value of the line sensor array
+        (*Sample_Task)(reflectance_value);
+    }
+}
+
+uint8_t Reflectance_Sensor_Sample_Start(uint16_t charge_time, uint16_t decay_time, void(*task)(uint8_t data))
+{
+    if (Sample_State != SAMPLE_IDLE)
+    {
+        return 0;
+    }
+
+    Sample_Task = task;
+    Sample_Decay_Time = decay_time;
+    Sample_State = SAMPLE_CHARGE;
+
+    // Turn on even-numbered IR LEDs
+    P5->OUT |= 0x08;
+
+    // Turn on odd-numbered IR LEDs
+    P9->OUT |= 0x04;
+
+    // Configure P7.0 - P7.7 as output GPIO
+    P7->DIR |= 0xFF;
+
+    // Set P7.0 - P7.7 to high
+    P7->OUT = 0xFF;
+
+    // Release the sensor outputs after the charge time
+    Timer_A1_Compare_Start(&Reflectance_Sensor_Sample_Step, charge_time * TIMER_A1_TICKS_PER_US);
+
+    return 1;
+}
+
+uint8_t Reflectance_Sensor_Sample_Busy()
+{
+    return (Sample_State != SAMPLE_IDLE);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file Scheduler.c
+ * @brief Source code for the Scheduler module.
+ *
+ * This file contains the function definitions for a time-triggered cooperative task scheduler
+ * driven by the Timer A1 periodic interrupt.
+ *
+ */
+
+#include "../inc/Scheduler.h"
+#include "../inc/CortexM.h"
+#include "../inc/Timer_A1_Interrupt.h"
+
+// Task table
+static Scheduler_Task *Scheduler_Tasks;
+static uint8_t Scheduler_Count;
+
+// Number of ticks since Scheduler_Init
+static volatile uint32_t Scheduler_Ticks;
+
+// Tick at which the statistics were last cleared
+static uint32_t Scheduler_Stats_Start;
+
+static void Scheduler_Tick(void)
+{
+    Scheduler_Ticks = Scheduler_Ticks + 1;
+    uint32_t now = Scheduler_Ticks * SCHEDULER_TICK_COUNTS;
+
+    for (int i = 0; i < Scheduler_Count; i++)
+    {
+        Scheduler_Task *task = &Scheduler_Tasks[i];
+
+        task->countdown = task->countdown - 1;
+        if (task->countdown) continue;
+        task->countdown = task->period;
+
+        // The previous release has not started yet, so it missed its deadline
+        if (task->pending) task->misses = task->misses + 1;
+
+        task->release = now;
+        task->pending = 1;
+    }
+}
+
+void Scheduler_Init(Scheduler_Task *tasks, uint8_t count)
+{
+    Scheduler_Tasks = tasks;
+    Scheduler_Count = count;
+    Scheduler_Ticks = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        // The first tick is tick 1, so a task with phase 0 is first released one period later
+        tasks[i].countdown = (tasks[i].phase) ? tasks[i].phase : tasks[i].period;
+        tasks[i].pending = 0;
+    }
+    Scheduler_Clear_Stats();
+
+    // Initialize Timer A1 periodic interrupt with a rate of 1 kHz
+    Timer_A1_Interrupt_Init(&Scheduler_Tick, SCHEDULER_TICK_COUNTS);
+}
+
+uint32_t Scheduler_Get_Ticks(void)
+{
+    return Scheduler_Ticks;
+}
+
+uint32_t Scheduler_Get_Time(void)
+{
+    uint32_t ticks;
+    uint32_t count;
+    uint32_t wrapped;
+
+    // Read the count again if a tick occurred in between
+    do
+    {
+        ticks = Scheduler_Ticks;
+        count = TIMER_A1->R;
+        wrapped = 0;
+
+        // The tick has occurred but Scheduler_Tick has not run yet
+        if (TIMER_A1->CCTL[0] & 0x0001)
+        {
+            count = TIMER_A1->R;
+            wrapped = 1;
+        }
+    } while (ticks != Scheduler_Ticks);
+
+    // Scheduler_Tick runs when the count reaches CCR0, one count before it returns to zero,
+    // so the count of CCR0 is the start of the tick
+    return (ticks + wrapped) * SCHEDULER_TICK_COUNTS + ((count + 1) % SCHEDULER_TICK_COUNTS);
+}
+
+void Scheduler_Dispatch(void)
+{
+    while (1)
+    {
+        // Find the released task with the highest priority
+        Scheduler_Task *next = 0;
+        for (int i = 0; i < Scheduler_Count; i++)
+        {
+            Scheduler_Task *task = &Scheduler_Tasks[i];
+            if (task->pending && (next == 0 || task->priority < next->priority)) next = task;
+        }
+        if (next == 0) break;
+
+        next->pending = 0;
+        uint32_t start = Scheduler_Get_Time();
+        (*next->task)();
+        uint32_t end = Scheduler_Get_Time();
+
+        uint32_t execution_time = end - start;
+        if (execution_time > next->wcet) next->wcet = execution_time;
+        next->busy = next->busy + execution_time;
+        next->runs = next->runs + 1;
+
+        // The deadline is the next release of the task. Scheduler_Tick also counts misses,
+        // so the increment must not be interrupted by a tick.
+        if ((end - next->release) > ((uint32_t)next->period * SCHEDULER_TICK_COUNTS))
+        {
+            long sr = StartCritical();
+            next->misses = next->misses + 1;
+            EndCritical(sr);
+        }
+    }
+
+    // Sleep until the next interrupt. Interrupts are disabled while checking for released tasks,
+    // so a tick that occurs just before WFI still wakes the CPU.
+    DisableInterrupts();
+    uint8_t released = 0;
+    for (int i = 0; i < Scheduler_Count; i++)
+    {
+        released = released | Scheduler_Tasks[i].pending;
+    }
+    if (released == 0) WaitForInterrupt();
+    EnableInterrupts();
+}
+
+uint32_t Scheduler_Get_Load(uint8_t index)
+{
+    if (index >= Scheduler_Count) return 0;
+
+    uint64_t elapsed = (uint64_t)(Scheduler_Ticks - Scheduler_Stats_Start) * SCHEDULER_TICK_COUNTS;
+    if (elapsed == 0) return 0;
+
+    return (uint32_t)((Scheduler_Tasks[index].busy * 10000) / elapsed);
+}
+
+void Scheduler_Clear_Stats(void)
+{
+    long sr = StartCritical();
+
+    for (int i = 0; i < Scheduler_Count; i++)
+    {
+        Scheduler_Tasks[i].runs = 0;
+        Scheduler_Tasks[i].misses = 0;
+        Scheduler_Tasks[i].wcet = 0;
+        Scheduler_Tasks[i].busy = 0;
+    }
+    Scheduler_Stats_Start = Scheduler_Ticks;
+
+    EndCritical(sr);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file Sequencer.c
+ * @brief Source code for the Sequencer module.
+ *
+ * This file contains the function definitions for a timed action sequencer
+ * driven by a periodic interrupt.
+ *
+ */
+
+#include "../inc/Sequencer.h"
+
+void Sequencer_Init(Sequencer *sequencer, const Sequencer_Step *steps, uint8_t count, void(*done)(void))
+{
+    sequencer->steps = steps;
+    sequencer->count = count;
+    sequencer->index = 0;
+    sequencer->remaining = 0;
+    sequencer->active = 0;
+    sequencer->start_request = 0;
+    sequencer->done = done;
+}
+
+void Sequencer_Start(Sequencer *sequencer)
+{
+    sequencer->start_request = 1;
+}
+
+uint8_t Sequencer_Tick(Sequencer *sequencer)
+{
+    // Apply a pending start request from the first step
+    if (sequencer->start_request)
+    {
+        sequencer->start_request = 0;
+        sequencer->index = 0;
+        sequencer->remaining = 0;
+        sequencer->active = 1;
+    }
+
+    if (sequencer->active == 0)
+    {
+        return 0;
+    }
+
+    // Begin the next step when the current one has elapsed
+    while (sequencer->remaining == 0)
+    {
+        if (sequencer->index >= sequencer->count)
+        {
+            sequencer->active = 0;
+            if (sequencer->done) (*sequencer->done)();
+            return 0;
+        }
+
+        const Sequencer_Step *step = &sequencer->steps[sequencer->index];
+        sequencer->index = sequencer->index + 1;
+        sequencer->remaining = step->duration;
+        if (step->action) (*step->action)();
+    }
+
+    sequencer->remaining = sequencer->remaining - 1;
+    return 1;
+}
+
+uint8_t Sequencer_Active(Sequencer *sequencer)
+{
+    return (sequencer->active || sequencer->start_request);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file Snapshot.c
+ * @brief Source code for the Snapshot module.
+ *
+ * This file contains the function definitions for a single-writer / multi-reader channel
+ * used to exchange small frames between interrupt handlers and the main loop.
+ *
+ * A sequence counter is odd while its copy of the frame is being written. Every access to
+ * the counters and frames is volatile, so the compiler keeps them in program order, and the
+ * Cortex-M4 does not reorder memory accesses as seen from an interrupt on the same core.
+ *
+ */
+
+#include "../inc/Snapshot.h"
+
+void Snapshot_Init(Snapshot_Channel *channel, const void *initial, uint32_t size)
+{
+    const uint8_t *source = (const uint8_t *)initial;
+
+    if (size > SNAPSHOT_MAX_SIZE) size = SNAPSHOT_MAX_SIZE;
+    channel->size = size;
+
+    for (int i = 0; i < 2; i++)
+    {
+        channel->sequence[i] = 0;
+        channel->number[i] = 0;
+        for (uint32_t j = 0; j < size; j++)
+        {
+            channel->frame[i][j] = source[j];
+        }
+    }
+    channel->published = 0;
+}
+
+void Snapshot_Write(Snapshot_Channel *channel, const void *frame)
+{
+    const uint8_t *source = (const uint8_t *)frame;
+    uint32_t published = channel->published;
+    uint32_t slot = published ^ 1;
+
+    // Mark the unpublished copy as being written
+    channel->sequence[slot] = channel->sequence[slot] + 1;
+
+    for (uint32_t i = 0; i < channel->size; i++)
+    {
+        channel->frame[slot][i] = source[i];
+    }
+    channel->number[slot] = channel->number[published] + 1;
+
+    // Mark the copy as complete, then publish it
+    channel->sequence[slot] = channel->sequence[slot] + 1;
+    channel->published = slot;
+}
+
+uint32_t Snapshot_Read(Snapshot_Channel *channel, void *frame)
+{
+    uint8_t *destination = (uint8_t *)frame;
+
+    while (1)
+    {
+        uint32_t slot = channel->published;
+        uint32_t sequence = channel->sequence[slot];
+
+        // The writer preempted this reader and is rewriting this copy: read the new one
+        if (sequence & 1) continue;
+
+        for (uint32_t i = 0; i < channel->size; i++)
+        {
+            destination[i] = channel->frame[slot][i];
+        }
+        uint32_t number = channel->number[slot];
+
+        // Keep the copy only if the writer did not touch it in the meantime
+        if (channel->sequence[slot] == sequence)
+        {
+            return number;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file Telemetry.c
+ * @brief Source code for the Telemetry module.
+ *
+ * This file contains the function definitions for the Telemetry module.
+ *
+ * The queue has a single producer (Telemetry_Push) and a single consumer (Telemetry_Task),
+ * so it needs no critical section: each side only writes its own index.
+ *
+ */
+
+#include "../inc/Telemetry.h"
+#include "../inc/UART_DMA.h"
+#include "../inc/COBS.h"
+
+// Queued record with the sequence number assigned when it was pushed
+typedef struct
+{
+    Telemetry_Record record;
+    uint16_t sequence;
+} Telemetry_Entry;
+
+// Record queue. The indices run freely and are masked on access.
+static Telemetry_Entry Telemetry_Queue[TELEMETRY_QUEUE_SIZE];
+static volatile uint32_t Telemetry_Head;
+static volatile uint32_t Telemetry_Tail;
+
+static uint16_t Telemetry_Divider;
+static uint16_t Telemetry_Count;
+static uint16_t Telemetry_Next_Sequence;
+static uint32_t Telemetry_Dropped;
+
+// UART DMA double buffer
+static uint8_t Telemetry_Buffer[2 * TELEMETRY_BUFFER_SIZE];
+
+// CRC-16/CCITT-FALSE lookup table, one entry per 4-bit value
+static const uint16_t Telemetry_CRC_Table[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static uint16_t Telemetry_CRC(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc = (crc << 4) ^ Telemetry_CRC_Table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ Telemetry_CRC_Table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+// Encodes one record as a complete frame. Returns the number of bytes written.
+static uint16_t Telemetry_Encode(const Telemetry_Record *record, uint16_t sequence, uint8_t *frame)
+{
+    uint8_t data[TELEMETRY_PAYLOAD_SIZE + 2];
+
+    data[0] = TELEMETRY_VERSION;
+    data[1] = sequence & 0xFF;
+    data[2] = sequence >> 8;
+    data[3] = record->time & 0xFF;
+    data[4] = (record->time >> 8) & 0xFF;
+    data[5] = (record->time >> 16) & 0xFF;
+    data[6] = record->time >> 24;
+    data[7] = record->sensor_data;
+    data[8] = record->state;
+    data[9] = (uint16_t)record->position & 0xFF;
+    data[10] = (uint16_t)record->position >> 8;
+    data[11] = (uint16_t)record->pid & 0xFF;
+    data[12] = (uint16_t)record->pid >> 8;
+    data[13] = record->duty_cycle_left & 0xFF;
+    data[14] = record->duty_cycle_left >> 8;
+    data[15] = record->duty_cycle_right & 0xFF;
+    data[16] = record->duty_cycle_right >> 8;
+
+    uint16_t crc = Telemetry_CRC(data, TELEMETRY_PAYLOAD_SIZE);
+    data[17] = crc & 0xFF;
+    data[18] = crc >> 8;
+
+    return COBS_Encode(data, sizeof(data), frame);
+}
+
+void Telemetry_Init(uint16_t divider)
+{
+    Telemetry_Head = 0;
+    Telemetry_Tail = 0;
+    Telemetry_Count = 0;
+    Telemetry_Next_Sequence = 0;
+    Telemetry_Dropped = 0;
+    Telemetry_Divider = divider;
+
+    UART_DMA_Init(UART_DMA_A0, Telemetry_Buffer, TELEMETRY_BUFFER_SIZE, 0);
+}
+
+void Telemetry_Set_Divider(uint16_t divider)
+{
+    Telemetry_Divider = divider;
+}
+
+uint8_t Telemetry_Push(const Telemetry_Record *record)
+{
+    if (Telemetry_Divider == 0) return 0;
+
+    if (++Telemetry_Count < Telemetry_Divider) return 0;
+    Telemetry_Count = 0;
+
+    uint16_t sequence = Telemetry_Next_Sequence++;
+    uint32_t head = Telemetry_Head;
+
+    if (head - Telemetry_Tail >= TELEMETRY_QUEUE_SIZE)
+    {
+        Telemetry_Dropped++;
+        return 0;
+    }
+
+    Telemetry_Entry *entry = &Telemetry_Queue[head & (TELEMETRY_QUEUE_SIZE - 1)];
+    entry->record = *record;
+    entry->sequence = sequence;
+
+    // Publish the record after it has been written
+    Telemetry_Head = head + 1;
+    return 1;
+}
+
+void Telemetry_Task(void)
+{
+    uint32_t tail = Telemetry_Tail;
+    if (tail == Telemetry_Head) return;
+
+    uint8_t *buffer = UART_DMA_Get_Buffer(UART_DMA_A0);
+    if (buffer == 0) return;
+
+    uint16_t length = 0;
+    while (tail != Telemetry_Head && length + TELEMETRY_FRAME_SIZE <= TELEMETRY_BUFFER_SIZE)
+    {
+        Telemetry_Entry *entry = &Telemetry_Queue[tail & (TELEMETRY_QUEUE_SIZE - 1)];
+        length += Telemetry_Encode(&entry->record, entry->sequence, &buffer[length]);
+        tail++;
+
+        // Release the slot once it has been encoded
+        Telemetry_Tail = tail;
+    }
+
+    UART_DMA_Send(UART_DMA_A0, length);
+}
+
+uint32_t Telemetry_Get_Dropped(void)
+{
+    return Telemetry_Dropped;
+}
@@ -14,6 +14,31 @@
  */
 
 #include "../inc/Timer_A1_Interrupt.h"
+#include "../inc/ISR_Profile.h"
+
+// Shortest compare step in timer ticks, long enough for CCR1 to be written before the timer reaches it
+#define TIMER_A1_COMPARE_MIN_STEP   12
+
+// One-shot task executed by TA1_N_IRQHandler
+static void (*Timer_A1_Compare_Task)(void);
+
+// Ticks left to wait after the currently armed compare event
+static uint32_t Timer_A1_Compare_Remaining;
+
+static void Timer_A1_Compare_Schedule(void)
+{
+    uint32_t period = TIMER_A1->CCR[0] + 1;
+    uint32_t step = Timer_A1_Compare_Remaining;
+
+    // Limit each step to half of the period so that the compare value is always ahead of the count
+    if (step > (period / 2)) step = period / 2;
+    if (step < TIMER_A1_COMPARE_MIN_STEP) step = TIMER_A1_COMPARE_MIN_STEP;
+
+    Timer_A1_Compare_Remaining = (Timer_A1_Compare_Remaining > step) ? (Timer_A1_Compare_Remaining - step) : 0;
+
+    // Set the compare value relative to the current count, wrapping at the end of the period
+    TIMER_A1->CCR[1] = (TIMER_A1->R + step) % period;
+}
 
 void Timer_A1_Interrupt_Init(void(*task)(void), uint16_t period)
 {
@@ -59,9 +84,65 @@ void TimerA1_Stop(void)
 
 void TA1_0_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER_LATENCY(TIMER_A1, TIMER_A1->CCR[0]));
+
     // Acknowledge Capture/Compare interrupt and clear it
     TIMER_A1->CCTL[0] &= ~0x0001;
 
     // Execute the user-defined task
     (*Timer_A1_Task)();
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_TA1_0);
+}
+
+void Timer_A1_Compare_Start(void(*task)(void), uint32_t delay)
+{
+    // Disable the compare interrupt while the task and compare value are updated
+    TIMER_A1->CCTL[1] &= ~0x0010;
+
+    Timer_A1_Compare_Task = task;
+    Timer_A1_Compare_Remaining = delay;
+    Timer_A1_Compare_Schedule();
+
+    // Compare mode (Bit 8 = 0)
+    // Capture / Compare Interrupt Enable (Bit 4 = 1)
+    // Clear Capture / Compare Interrupt Flag (Bit 0 = 0)
+    TIMER_A1->CCTL[1] = 0x0010;
+
+    // Set interrupt priority level to 2
+    NVIC->IP[11] = 0x40;
+
+    // Enable Interrupt 11 in NVIC
+    NVIC->ISER[0] = 0x00000800;
+}
+
+void Timer_A1_Compare_Stop(void)
+{
+    // Disable the compare interrupt and clear any pending flag
+    TIMER_A1->CCTL[1] &= ~0x0011;
+    Timer_A1_Compare_Remaining = 0;
+}
+
+void TA1_N_IRQHandler(void)
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER_LATENCY(TIMER_A1, TIMER_A1->CCR[1]));
+
+    // Acknowledge Capture/Compare interrupt and clear it
+    TIMER_A1->CCTL[1] &= ~0x0001;
+
+    // Wait for the next step if the delay was longer than one step
+    if (Timer_A1_Compare_Remaining)
+    {
+        Timer_A1_Compare_Schedule();
+        ISR_PROFILE_EXIT(ISR_PROFILE_TA1_N);
+        return;
+    }
+
+    // Disable the compare interrupt so that the task runs only once
+    TIMER_A1->CCTL[1] &= ~0x0010;
+
+    // Execute the one-shot task
+    (*Timer_A1_Compare_Task)();
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_TA1_N);
 }
@@ -17,6 +17,7 @@
  */
 
 #include "../inc/Timer_A3_Capture.h"
+#include "../inc/ISR_Profile.h"
 
 // Placeholder function
 void User_Function(uint16_t t) {};
@@ -80,18 +81,26 @@ void Timer_A3_Capture_Init(void(*task0)(uint16_t time), void(*task1)(uint16_t ti
 
 void TA3_0_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER_LATENCY(TIMER_A3, TIMER_A3->CCR[0]));
+
     // Acknowledge Capture/Compare interrupt and clear it
     TIMER_A3->CCTL[0] &= ~0x0001;
 
     // Execute the user-defined task
     (*Capture_Task_0)(TIMER_A3->CCR[0]);
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_TA3_0);
 }
 
 void TA3_N_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER_LATENCY(TIMER_A3, TIMER_A3->CCR[1]));
+
     // Acknowledge Capture/Compare interrupt and clear it
     TIMER_A3->CCTL[1] &= ~0x0001;
 
     // Execute the user-defined task
     (*Capture_Task_1)(TIMER_A3->CCR[1]);
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_TA3_N);
 }
@@ -0,0 +1,158 @@
+/**
+ * @file UART_DMA.c
+ * @brief Source code for the UART_DMA driver.
+ *
+ * This file contains the function definitions for the UART_DMA driver.
+ *
+ * The eUSCI sets its transmit flag each time TXBUF is free again, which requests the next byte.
+ *
+ */
+
+#include "../inc/UART_DMA.h"
+#include "../inc/CortexM.h"
+
+// State of each half of the double buffer
+#define UART_DMA_FREE       0
+#define UART_DMA_QUEUED     1
+#define UART_DMA_DRAINING   2
+
+typedef struct
+{
+    uint8_t *buffer;
+    uint16_t half_size;
+    uint16_t length[2];
+    volatile uint8_t state[2];
+    uint8_t fill;
+    uint8_t drain;
+    uint8_t channel;
+    volatile uint16_t *tx_buffer;
+    volatile uint16_t *tx_ifg;
+    void (*done)(UART_DMA_Port port);
+} UART_DMA_State;
+
+static UART_DMA_State UART_DMA_Ports[UART_DMA_NUM_PORTS];
+
+// Must be called with the DMA channel idle
+static void UART_DMA_Start(UART_DMA_State *state, uint8_t half)
+{
+    state->state[half] = UART_DMA_DRAINING;
+    state->drain = half;
+
+    DMA_Set_Transfer(state->channel, 0, &state->buffer[half * state->half_size], state->tx_buffer,
+                     DMA_SIZE_8 | DMA_SRC_INC_8 | DMA_DST_INC_NONE | DMA_ARBITRATE_1 | DMA_MODE_BASIC,
+                     state->length[half]);
+    DMA_Enable_Channel(state->channel);
+
+    // The channel is triggered by the rising edge of the transmit flag. If the flag is already set
+    // (TXBUF is empty), the first byte is requested by software. Otherwise TXBUF still holds the last
+    // byte of the previous transfer, and the flag rises when that byte moves to the shift register.
+    if (*state->tx_ifg & 0x02)
+    {
+        DMA_Software_Trigger(state->channel);
+    }
+}
+
+// Called from DMA_INT0 when the draining half has been handed to the eUSCI
+static void UART_DMA_Complete(UART_DMA_Port port)
+{
+    UART_DMA_State *state = &UART_DMA_Ports[port];
+    uint8_t next = state->drain ^ 1;
+
+    state->state[state->drain] = UART_DMA_FREE;
+
+    // Keep the line busy before notifying the application
+    if (state->state[next] == UART_DMA_QUEUED)
+    {
+        UART_DMA_Start(state, next);
+    }
+
+    if (state->done)
+    {
+        (*state->done)(port);
+    }
+}
+
+static void UART_DMA_A0_Complete(void)
+{
+    UART_DMA_Complete(UART_DMA_A0);
+}
+
+static void UART_DMA_A2_Complete(void)
+{
+    UART_DMA_Complete(UART_DMA_A2);
+}
+
+void UART_DMA_Init(UART_DMA_Port port, uint8_t *buffer, uint16_t half_size, void (*done)(UART_DMA_Port port))
+{
+    UART_DMA_State *state = &UART_DMA_Ports[port];
+
+    state->buffer = buffer;
+    state->half_size = half_size;
+    state->state[0] = UART_DMA_FREE;
+    state->state[1] = UART_DMA_FREE;
+    state->fill = 0;
+    state->drain = 0;
+    state->done = done;
+
+    DMA_Init();
+
+    if (port == UART_DMA_A0)
+    {
+        state->channel = 0;
+        state->tx_buffer = &EUSCI_A0->TXBUF;
+        state->tx_ifg = &EUSCI_A0->IFG;
+        DMA_Configure_Channel(0, DMA_SOURCE_EUSCI_A, &UART_DMA_A0_Complete);
+    }
+    else
+    {
+        state->channel = 4;
+        state->tx_buffer = &EUSCI_A2->TXBUF;
+        state->tx_ifg = &EUSCI_A2->IFG;
+        DMA_Configure_Channel(4, DMA_SOURCE_EUSCI_A, &UART_DMA_A2_Complete);
+    }
+}
+
+uint8_t *UART_DMA_Get_Buffer(UART_DMA_Port port)
+{
+    UART_DMA_State *state = &UART_DMA_Ports[port];
+
+    if (state->state[state->fill] != UART_DMA_FREE)
+    {
+        return 0;
+    }
+    return &state->buffer[state->fill * state->half_size];
+}
+
+uint8_t UART_DMA_Send(UART_DMA_Port port, uint16_t length)
+{
+    UART_DMA_State *state = &UART_DMA_Ports[port];
+    uint8_t half = state->fill;
+
+    if (length == 0 || length > state->half_size || state->state[half] != UART_DMA_FREE)
+    {
+        return 0;
+    }
+
+    state->length[half] = length;
+    state->fill = half ^ 1;
+
+    // The completion interrupt may start the queued half, so the state is checked atomically
+    long sr = StartCritical();
+    if (state->state[half ^ 1] == UART_DMA_DRAINING)
+    {
+        state->state[half] = UART_DMA_QUEUED;
+    }
+    else
+    {
+        UART_DMA_Start(state, half);
+    }
+    EndCritical(sr);
+
+    return 1;
+}
+
+uint8_t UART_DMA_Busy(UART_DMA_Port port)
+{
+    UART_DMA_State *state = &UART_DMA_Ports[port];
+    return (state->state[0] != UART_DMA_FREE) || (state->state[1] != UART_DMA_FREE);
+}
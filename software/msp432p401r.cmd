@@ -97,9 +97,18 @@ SECTIONS
     .vtable :   > 0x20000000
     .data   :   > SRAM_DATA
     .bss    :   > SRAM_DATA
+    /* Variables declared with __attribute__((noinit)) (e.g. the LPF       */
+    /* filter storage, see LPF.h) are not zeroed by the startup code.      */
+    .TI.noinit  : > SRAM_DATA
     .sysmem :   > SRAM_DATA
     .stack  :   > SRAM_DATA (HIGH)
 
+    /* Format strings of the LOG macro (see Log.h). The section is kept in    */
+    /* the output file for the host renderer but is not loaded to the device. */
+    /* It is placed outside the memory map so that its addresses cannot be    */
+    /* mistaken for data.                                                     */
+    .log_strings  : > 0x80000000, type = COPY
+
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
     .TI.ramfunc : {} load=MAIN, run=SRAM_CODE, table(BINIT)